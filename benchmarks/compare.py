@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Compares two benchmark result files and flags regressions.
+
+Reads the JSON written by ofxCrvsBench --out=<file>, or by Google Benchmark
+with --benchmark_out. Median aggregates are used when present, otherwise the
+mean of the individual runs.
+
+    python3 benchmarks/compare.py before.json after.json
+    python3 benchmarks/compare.py before.json after.json --threshold=0.05
+
+Exits with status 1 when any benchmark got slower than the threshold, so it
+can gate a CI job.
+"""
+
+import argparse
+import json
+import re
+import sys
+
+
+def load(path, metric):
+    with open(path) as f:
+        data = json.load(f)
+    medians = {}
+    runs = {}
+    for bench in data.get("benchmarks", []):
+        if "error_occurred" in bench and bench["error_occurred"]:
+            continue
+        name = bench.get("run_name", bench["name"])
+        scale = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}[
+            bench.get("time_unit", "ns")]
+        value = bench[metric] * scale
+        if bench.get("run_type") == "aggregate":
+            if bench.get("aggregate_name") == "median":
+                medians[name] = value
+        else:
+            runs.setdefault(name, []).append(value)
+    results = {name: sum(v) / len(v) for name, v in runs.items()}
+    results.update(medians)
+    return results
+
+
+def format_ns(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if ns >= scale:
+            return "%.3g %s" % (ns / scale, unit)
+    return "%.3g ns" % ns
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown that counts as a regression "
+                             "(default 0.10)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"),
+                        default="real_time")
+    parser.add_argument("--filter", default="",
+                        help="only compare benchmarks matching this regex")
+    parser.add_argument("--all", action="store_true",
+                        help="list unchanged benchmarks too")
+    args = parser.parse_args()
+
+    before = load(args.baseline, args.metric)
+    after = load(args.candidate, args.metric)
+    pattern = re.compile(args.filter)
+    names = [n for n in before if n in after and pattern.search(n)]
+
+    regressions = []
+    improvements = []
+    rows = []
+    for name in names:
+        change = after[name] / before[name] - 1.0 if before[name] > 0 else 0.0
+        if change > args.threshold:
+            regressions.append(name)
+            flag = "REGRESSION"
+        elif change < -args.threshold:
+            improvements.append(name)
+            flag = "faster"
+        else:
+            flag = ""
+        if flag or args.all:
+            rows.append((name, before[name], after[name], change, flag))
+
+    width = max([len(r[0]) for r in rows] + [9])
+    print("%-*s %12s %12s %9s" % (width, "benchmark", "baseline", "candidate",
+                                  "change"))
+    for name, old, new, change, flag in sorted(rows, key=lambda r: -r[3]):
+        print("%-*s %12s %12s %+8.1f%% %s" % (width, name, format_ns(old),
+                                             format_ns(new), change * 100,
+                                             flag))
+
+    missing = sorted(n for n in before if n not in after and pattern.search(n))
+    added = sorted(n for n in after if n not in before and pattern.search(n))
+    if missing:
+        print("\nonly in baseline: " + ", ".join(missing))
+    if added:
+        print("\nonly in candidate: " + ", ".join(added))
+    print("\n%d compared, %d regressed, %d faster (threshold %.0f%%)" %
+          (len(names), len(regressions), len(improvements),
+           args.threshold * 100))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
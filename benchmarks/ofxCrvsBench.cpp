@@ -0,0 +1,734 @@
+/**
+ * Microbenchmarks for ofxCrvs: every Ops factory, Crv sampling paths and
+ * modulator depth, the composite curves, audio-rate rendering, Ptrn, web
+ * edges, the block kernels (noise, filters, simplification, spatial
+ * queries, graphs), metrics recording, table files and chunked export.
+ *
+ * Links the core library alone, no openFrameworks needed:
+ *
+ *   cmake -S . -B build -DCMAKE_BUILD_TYPE=Release \
+ *       -DOFXCRVS_BUILD_BENCHMARKS=ON
+ *   cmake --build build --target ofxCrvsBench
+ *
+ * (Release builds with -O3; GCC only vectorizes the block noise and filter
+ * kernels from -O3.)
+ *
+ *   build/ofxCrvsBench --out=before.json   # on the baseline build
+ *   build/ofxCrvsBench --out=after.json    # on the candidate build
+ *   python3 benchmarks/compare.py before.json after.json
+ *
+ * Op benchmarks sweep kSamples positions per iteration and report the time
+ * for the whole sweep; items_per_second is per evaluated sample.
+ */
+
+#include "ofxCrvsBench.h"
+
+#include <filesystem>
+
+#include "ofxCrvsLib.h"
+
+using namespace ofxCrvs;
+
+namespace {
+
+constexpr int kSamples = 256;
+constexpr int kPoints = 1024;
+
+// Registers an op sweep over [0, 1]
+void sweep(const std::string &name, FloatOp op) {
+  registerBench("Ops/" + name, [op](BenchState &state) mutable {
+    float acc = 0.f;
+    while (state.keepRunning()) {
+      for (int i = 0; i < kSamples; ++i)
+        acc += op(i * (1.f / (kSamples - 1)));
+      doNotOptimize(acc);
+    }
+    state.setItemsProcessed(kSamples);
+  });
+}
+
+std::vector<float> table(int size) {
+  std::vector<float> values(size);
+  for (int i = 0; i < size; ++i)
+    values[i] = std::sin(i * 0.37f) * 0.5f + 0.5f;
+  return values;
+}
+
+std::vector<glm::vec3> noisyPath(int count) {
+  std::vector<glm::vec3> points(count);
+  for (int i = 0; i < count; ++i) {
+    const float t = static_cast<float>(i) / (count - 1);
+    points[i] = glm::vec3(t * 1000.f,
+                          300.f * std::sin(t * 12.f) +
+                              40.f * Noise::signedNoise(t * 50.f),
+                          100.f * Noise::signedNoise(t * 7.f, 3.f));
+  }
+  return points;
+}
+
+void registerOps() {
+  const Ops ops;
+  const FloatOp sine = ops.sine();
+  const FloatOp saw = ops.saw();
+  const FloatOp tri = ops.tri();
+  const FloatOp half = ops.c(0.5f);
+
+  sweep("zero", ops.zero());
+  sweep("fourth", ops.fourth());
+  sweep("third", ops.third());
+  sweep("half", ops.half());
+  sweep("one", ops.one());
+  sweep("two", ops.two());
+  sweep("three", ops.three());
+  sweep("four", ops.four());
+  sweep("quarterPi", ops.quarterPi());
+  sweep("thirdPi", ops.thirdPi());
+  sweep("halfPi", ops.halfPi());
+  sweep("pi", ops.pi());
+  sweep("twoPi", ops.twoPi());
+  sweep("appWidth", ops.appWidth());
+  sweep("appHeight", ops.appHeight());
+  sweep("c", ops.c(0.25f));
+  sweep("bipolarize", ops.bipolarize(saw));
+  sweep("rectify", ops.rectify(sine));
+  sweep("timePhasor", ops.timePhasor());
+  sweep("tempoPhasor", ops.tempoPhasor());
+  {
+    Ops clocked;
+    clocked.setClock(std::make_shared<WallClock>());
+    sweep("timePhasor/clock", clocked.timePhasor());
+    sweep("tempoPhasor/clock", clocked.tempoPhasor());
+  }
+
+  // Oscillators
+  sweep("phasor", ops.phasor());
+  sweep("saw", saw);
+  sweep("tri", tri);
+  sweep("tri/float", ops.tri(0.3f));
+  sweep("tri/op", ops.tri(saw));
+  sweep("sine", sine);
+  sweep("sine/float", ops.sine(0.2f));
+  sweep("sine/op", ops.sine(saw));
+  sweep("sineFb/float", ops.sineFb(0.2f));
+  sweep("sineFb/op", ops.sineFb(saw));
+  sweep("asin", ops.asin());
+  sweep("cos", ops.cos());
+  sweep("cos/float", ops.cos(0.2f));
+  sweep("cos/op", ops.cos(saw));
+  sweep("acos", ops.acos());
+  sweep("tan", ops.tan());
+  sweep("tan/float", ops.tan(0.2f));
+  sweep("tan/op", ops.tan(saw));
+
+  // Tables
+  const std::vector<FloatOp> opTable = {sine, saw, tri, half};
+  sweep("lookup/float", ops.lookup(table(64)));
+  sweep("lookup/op", ops.lookup(opTable));
+  sweep("wt/float", ops.wt(table(64)));
+  sweep("wt/op", ops.wt(opTable));
+  sweep("wt/float/xOp", ops.wt(table(64), sine));
+  sweep("wt/op/xOp", ops.wt(opTable, sine));
+  sweep("wt2d/float",
+        ops.wt2d(std::vector<std::vector<float>>(16, table(16)), saw, sine));
+  sweep("wt2d/op",
+        ops.wt2d(std::vector<std::vector<FloatOp>>(4, opTable), saw, sine));
+  sweep("wt3d/float",
+        ops.wt3d(std::vector<std::vector<std::vector<float>>>(
+                     8, std::vector<std::vector<float>>(8, table(8))),
+                 saw, sine, tri));
+  sweep("wt3d/op",
+        ops.wt3d(std::vector<std::vector<std::vector<FloatOp>>>(
+                     4, std::vector<std::vector<FloatOp>>(4, opTable)),
+                 saw, sine, tri));
+
+  // Easing
+  sweep("easeIn", ops.easeIn());
+  sweep("easeIn/float", ops.easeIn(3.f));
+  sweep("easeIn/op", ops.easeIn(ops.c(3.f)));
+  sweep("easeOut", ops.easeOut());
+  sweep("easeOut/float", ops.easeOut(3.f));
+  sweep("easeOut/op", ops.easeOut(ops.c(3.f)));
+  sweep("easeInOut", ops.easeInOut());
+  sweep("easeInOut/float", ops.easeInOut(3.f));
+  sweep("easeInOut/op", ops.easeInOut(ops.c(3.f)));
+  sweep("easeOutIn", ops.easeOutIn());
+  sweep("easeOutIn/float", ops.easeOutIn(3.f));
+  sweep("easeOutIn/op", ops.easeOutIn(ops.c(3.f)));
+
+  // Envelopes
+  std::vector<std::vector<float>> points;
+  for (int i = 0; i < 16; ++i)
+    points.push_back({i / 15.f, (i % 3) / 2.f, 0.5f});
+  sweep("env", ops.env(0.1f, 1.f, 0.2f, 0.4f, 0.6f, 0.3f));
+  sweep("breakpoints", ops.breakpoints(points));
+  sweep("breakpoints/prebuilt", ops.breakpoints(Breakpoints(points)));
+  sweep("timeseries", ops.timeseries(table(kSamples)));
+  const auto stream = std::make_shared<Strm>(kSamples);
+  const std::vector<float> streamed = table(kSamples);
+  stream->push(streamed.data(), streamed.size());
+  sweep("timeseries/strm", ops.timeseries(stream));
+
+  // Random and noise
+  sweep("gaussian", ops.gaussian());
+  sweep("gaussian/hi", ops.gaussian(half));
+  sweep("random", ops.random());
+  sweep("random/hi", ops.random(0.5f));
+  sweep("random/lo/hi/mode", ops.random(ops.zero(), ops.one(), half));
+  sweep("perlin", ops.perlin(saw));
+  sweep("perlin/3d", ops.perlin(saw, sine, tri));
+  sweep("perlin/3d/op/oct4", ops.perlin(saw, sine, tri, half, ops.four()));
+  sweep("perlin/3d/oct4", ops.perlin(saw, sine, tri, 0.5f, 4));
+  sweep("perlin/3d/field",
+        ops.perlin(saw, sine, tri, std::make_shared<NoiseField>(0.5f, 4)));
+  sweep("cachedPerlin/3d/oct4", ops.cachedPerlin(saw, sine, tri, 0.5f, 4));
+  sweep("fuzz", ops.fuzz(0.1f));
+
+  // Arithmetic and shaping
+  sweep("abs", ops.abs(sine));
+  sweep("diff", ops.diff(sine, saw));
+  sweep("mult", ops.mult(sine, 0.5f));
+  sweep("bias/float", ops.bias(sine, 0.5f));
+  sweep("bias/op", ops.bias(sine, saw));
+  sweep("phase/float", ops.phase(sine, 0.25f));
+  sweep("phase/op", ops.phase(sine, saw));
+  sweep("rate/float", ops.rate(sine, 2.f));
+  sweep("rate/op", ops.rate(sine, saw));
+  sweep("ring", ops.ring(sine, saw));
+  sweep("fold", ops.fold(ops.mult(sine, 2.f)));
+  sweep("fold/float", ops.fold(ops.mult(sine, 2.f), 0.8f));
+  sweep("fold/op", ops.fold(ops.mult(sine, 2.f), half));
+  sweep("wrap/float", ops.wrap(ops.mult(sine, 2.f), 0.f, 1.f));
+  sweep("wrap/op", ops.wrap(ops.mult(sine, 2.f), ops.zero(), ops.one()));
+
+  // Filters and feedback
+  sweep("lpf/16", ops.lpf(sine, 16));
+  sweep("filter/biquad",
+        ops.filter(std::make_shared<Biquad>(BiquadType::LOWPASS, 0.1f)));
+  sweep("lpFb", ops.lpFb(0.5f, 0.2f));
+  sweep("ampFb", ops.ampFb(0.5f, 0.2f, sine));
+  sweep("morph", ops.morph(sine, saw, tri));
+
+  // Vector ops
+  sweep("morph/vector", ops.morph(opTable, saw));
+  sweep("chain", ops.chain({saw, sine, tri}));
+  sweep("choose", ops.choose(opTable));
+  sweep("mix", ops.mix(opTable));
+  sweep("mix/float", ops.mix(opTable, {0.1f, 0.2f, 0.3f, 0.4f}));
+  sweep("mix/op", ops.mix(opTable, opTable));
+  sweep("sum", ops.sum(opTable));
+  sweep("product", ops.product(opTable));
+  sweep("min", ops.min(opTable));
+  sweep("max", ops.max(opTable));
+  sweep("mean", ops.mean(opTable));
+  sweep("median", ops.median(opTable));
+  sweep("variance", ops.variance(opTable));
+  sweep("stdDev", ops.stdDev(opTable));
+
+  // Smoothing and logic
+  sweep("smooth", ops.smooth());
+  sweep("smoother", ops.smoother());
+  sweep("ema/float", ops.ema(0.2f));
+  sweep("ema/op", ops.ema(half));
+  sweep("pulse", ops.pulse());
+  sweep("pulse/float", ops.pulse(0.3f));
+  sweep("square", ops.square());
+  sweep("crossed", ops.crossed(sine, saw));
+  sweep("trendFlip", ops.trendFlip(sine));
+  sweep("greater", ops.greater(sine, saw));
+  sweep("greater/float", ops.greater(sine, 0.5f));
+  sweep("less", ops.less(sine, saw));
+  sweep("less/float", ops.less(sine, 0.5f));
+  sweep("equal", ops.equal(sine, saw));
+  sweep("equal/float", ops.equal(sine, 0.5f));
+  sweep("notEqual", ops.notEqual(sine, saw));
+  sweep("notEqual/float", ops.notEqual(sine, 0.5f));
+  sweep("and_", ops.and_(sine, saw));
+  sweep("and_/op", ops.and_(sine, saw, half));
+  sweep("or_", ops.or_(sine, saw));
+  sweep("or_/op", ops.or_(sine, saw, half));
+  sweep("not_", ops.not_(sine));
+  sweep("xor_", ops.xor_(sine, saw));
+  sweep("xor_/op", ops.xor_(sine, saw, half));
+  sweep("nand", ops.nand(sine, saw));
+  sweep("nand/op", ops.nand(sine, saw, half));
+  sweep("nor", ops.nor(sine, saw));
+  sweep("nor/op", ops.nor(sine, saw, half));
+  sweep("xnor", ops.xnor(sine, saw));
+  sweep("xnor/op", ops.xnor(sine, saw, half));
+  sweep("in/float/float", ops.in(sine, 0.25f, 0.75f));
+  sweep("in/op/op", ops.in(sine, ops.fourth(), half));
+  sweep("in/float/op", ops.in(sine, 0.25f, half));
+  sweep("in/op/float", ops.in(sine, ops.fourth(), 0.75f));
+  sweep("out/float/float", ops.out(sine, 0.25f, 0.75f));
+  sweep("out/op/op", ops.out(sine, ops.fourth(), half));
+  sweep("out/float/op", ops.out(sine, 0.25f, half));
+  sweep("out/op/float", ops.out(sine, ops.fourth(), 0.75f));
+
+  // Array helpers
+  registerBench("Ops/floatArray", [ops, sine](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(ops.floatArray(sine, kPoints));
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Ops/glv3Array", [ops, sine](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(ops.glv3Array(sine, 0.f, 1000.f, kPoints));
+    state.setItemsProcessed(kPoints);
+  });
+  // The same moving average both ways: lpf(op, window) read at positions
+  // k / window, and a Boxcar(window) over samples at those positions, give
+  // the same window + 1 values.
+  for (const int window : {16, 256, 1024}) {
+    const std::string suffix = "/" + std::to_string(window);
+    registerBench("Ops/lpf/array" + suffix,
+                  [lpf = ops.lpf(sine, window), window](BenchState &state) {
+                    std::vector<float> out(window + 1);
+                    while (state.keepRunning()) {
+                      for (int k = 0; k <= window; ++k)
+                        out[k] = lpf(static_cast<float>(k) / window);
+                      doNotOptimize(out.data());
+                    }
+                    state.setItemsProcessed(window + 1);
+                  });
+    registerBench("Ops/filterArray/boxcar" + suffix,
+                  [ops, sine, window](BenchState &state) {
+                    Boxcar boxcar(window);
+                    while (state.keepRunning()) {
+                      boxcar.reset();
+                      doNotOptimize(
+                          ops.filterArray(sine, window + 1, boxcar));
+                    }
+                    state.setItemsProcessed(window + 1);
+                  });
+  }
+}
+
+// Every modulator of each level points at the next, so a fanout of 4
+// evaluates 4^depth leaves per sample.
+std::shared_ptr<Crv> modulatorTree(int depth, int fanout) {
+  const Ops ops;
+  auto crv = Crv::create(ops.sine());
+  for (int d = 0; d < depth; ++d) {
+    auto parent = Crv::create(ops.sine());
+    parent->ampCrv = crv;
+    if (fanout > 1)
+      parent->rateCrv = crv;
+    if (fanout > 2)
+      parent->phaseCrv = crv;
+    if (fanout > 3)
+      parent->biasCrv = crv;
+    crv = parent;
+  }
+  return crv;
+}
+
+void registerCrvs() {
+  const Ops ops;
+  for (const int depth : {0, 1, 2, 4, 8, 16}) {
+    registerBench("Crv/modChain/depth:" + std::to_string(depth),
+                  [depth](BenchState &state) {
+                    const auto crv = modulatorTree(depth, 1);
+                    while (state.keepRunning())
+                      doNotOptimize(crv->glv3Array(kPoints, true, true));
+                    state.setItemsProcessed(kPoints);
+                  });
+  }
+  for (const int depth : {0, 1, 2, 3, 4}) {
+    registerBench("Crv/modTree/depth:" + std::to_string(depth),
+                  [depth](BenchState &state) {
+                    const auto crv = modulatorTree(depth, 4);
+                    while (state.keepRunning())
+                      doNotOptimize(crv->glv3Array(kPoints, true, true));
+                    state.setItemsProcessed(kPoints);
+                  });
+  }
+
+  const auto crv = modulatorTree(1, 4);
+  crv->rotation = 30.f;
+  crv->scale = glm::vec3(0.8f);
+  registerBench("Crv/floatArray", [crv](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(crv->floatArray(kPoints));
+    state.setItemsProcessed(kPoints);
+  });
+  for (const bool boxed : {false, true}) {
+    for (const bool transformed : {false, true}) {
+      const std::string name = std::string("Crv/glv3Array") +
+                               (boxed ? "/boxed" : "") +
+                               (transformed ? "/transformed" : "");
+      registerBench(name, [crv, boxed, transformed](BenchState &state) {
+        while (state.keepRunning())
+          doNotOptimize(crv->glv3Array(kPoints, boxed, transformed));
+        state.setItemsProcessed(kPoints);
+      });
+    }
+  }
+  registerBench("Crv/f3dArray", [crv](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(crv->f3dArray(kPoints, true, true));
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Crv/adaptiveArray", [crv](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(crv->adaptiveArray(0.5f, true, true));
+  });
+  registerBench("Crv/resample", [crv](BenchState &state) {
+    while (state.keepRunning()) {
+      state.pauseTiming();
+      crv->invalidateArcLength();
+      state.resumeTiming();
+      doNotOptimize(crv->resample(kPoints, true, true));
+    }
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Crv/resample/cached", [crv](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(crv->resample(kPoints, true, true));
+    state.setItemsProcessed(kPoints);
+  });
+
+  // Composite curves
+  const auto x = Crv::create(ops.sine());
+  const auto y = Crv::create(ops.cos());
+  const auto z = Crv::create(ops.tri());
+  const auto w = Crv::create(ops.saw());
+  registerBench("Hypr/glv4Array", [=](BenchState &state) {
+    const auto hypr = Hypr::create(x, y, z, w);
+    while (state.keepRunning())
+      doNotOptimize(hypr->glv4Array(kPoints, true, true));
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Lsjs/glv3Array", [=](BenchState &state) {
+    const auto lsjs = std::make_shared<Lsjs>(x, y);
+    while (state.keepRunning())
+      doNotOptimize(lsjs->glv3Array(kPoints, true, true));
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Msh/glv3Array", [=](BenchState &state) {
+    const auto msh = std::make_shared<Msh>(x, y, z);
+    while (state.keepRunning())
+      doNotOptimize(msh->glv3Array(kPoints, true, true));
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Msh/componentAt", [=](BenchState &state) {
+    const auto msh = std::make_shared<Msh>(x, y, z);
+    while (state.keepRunning()) {
+      float sum = 0.f;
+      for (int i = 0; i < kSamples; ++i)
+        sum += msh->componentAt(Component::Z, i * (1.f / (kSamples - 1)));
+      doNotOptimize(sum);
+    }
+    state.setItemsProcessed(kSamples);
+  });
+
+  // Patterns
+  for (const int block : {64, 512}) {
+    registerBench("AudioRenderer/interleaved/block:" + std::to_string(block),
+                  [crv, block](BenchState &state) {
+                    AudioRenderer renderer(48000.f, 4);
+                    for (int c = 0; c < 4; ++c)
+                      renderer.addChannel(crv, 0.5f + c);
+                    std::vector<float> buffer(block * 4);
+                    while (state.keepRunning()) {
+                      renderer.renderInterleaved(buffer.data(), block);
+                      doNotOptimize(buffer.data());
+                    }
+                    state.setItemsProcessed(block * 4);
+                  });
+  }
+  // Voice count scaling: "sweep" voices evaluate every sample, "held" voices
+  // sit at their sustain position, "perVoice" keeps per-voice op state
+  const auto env = Crv::create(Ops().env(0.1f, 1.f, 0.2f, 0.4f, 0.6f, 0.3f));
+  for (const int voices : {1, 16, 64, 256}) {
+    const std::string suffix = "/voices:" + std::to_string(voices);
+    for (const std::string mode : {"sweep", "held", "perVoice"}) {
+      registerBench(
+          "VoicePool/" + mode + suffix, [env, voices, mode](BenchState &state) {
+            VoicePool pool(env, voices, 48000.f,
+                           mode == "perVoice" ? VoicePool::State::PER_VOICE
+                                              : VoicePool::State::SHARED);
+            if (mode == "held")
+              pool.setTiming(0.01f, 0.3f, 0.5f);
+            else
+              pool.setTiming(60.f);
+            std::vector<float> buffer(512);
+            while (state.keepRunning()) {
+              while (pool.getNumActive() < voices)
+                pool.trigger();
+              pool.process(buffer.data(), buffer.size());
+              doNotOptimize(buffer.data());
+            }
+            state.setItemsProcessed(512 * voices);
+          });
+    }
+  }
+  registerBench("Ptrn/updateCache", [crv](BenchState &state) {
+    Ptrn ptrn;
+    ptrn.setCrv(crv);
+    while (state.keepRunning())
+      ptrn.updateCache();
+  });
+  registerBench("Ptrn/next", [crv](BenchState &state) {
+    Ptrn ptrn;
+    ptrn.setCrv(crv);
+    ptrn.updateCache();
+    while (state.keepRunning())
+      doNotOptimize(ptrn.next());
+  });
+  registerBench("Ptrn/next/metrics", [crv](BenchState &state) {
+    Metrics metrics;
+    Ptrn ptrn;
+    ptrn.setCrv(crv);
+    ptrn.setMetrics("bench", metrics);
+    ptrn.setStepInterval(std::chrono::milliseconds(1));
+    ptrn.updateCache();
+    while (state.keepRunning())
+      doNotOptimize(ptrn.next());
+  });
+
+  // Edges
+  for (const int numPoints : {32, 128, 512}) {
+    registerBench("Crv/getWebEdgs/points:" + std::to_string(numPoints),
+                  [crv, numPoints](BenchState &state) {
+                    while (state.keepRunning())
+                      doNotOptimize(crv->getWebEdgs(numPoints, true, true, 8));
+                  });
+    registerBench("Crv/webLinesInto/points:" + std::to_string(numPoints),
+                  [crv, numPoints](BenchState &state) {
+                    VertexStream stream = VertexStream::inMemory();
+                    const std::size_t capacity =
+                        Crv::webLinesCapacity(numPoints);
+                    while (state.keepRunning()) {
+                      doNotOptimize(stream.fill(capacity, [&](glm::vec3 *out) {
+                        return crv->webLinesInto(out, capacity, numPoints,
+                                                 true, true);
+                      }));
+                    }
+                  });
+  }
+  registerBench("Crv/sampleInto", [crv](BenchState &state) {
+    VertexStream stream = VertexStream::inMemory();
+    while (state.keepRunning()) {
+      doNotOptimize(stream.fill(kPoints, [&](glm::vec3 *out) {
+        crv->sampleInto(out, kPoints, true, true);
+        return kPoints;
+      }));
+    }
+    state.setItemsProcessed(kPoints);
+  });
+  registerBench("Edg/getCrvPoints", [crv](BenchState &state) {
+    const Edg edg(glm::vec3(0.f), glm::vec3(500.f, 300.f, 0.f), 64);
+    while (state.keepRunning())
+      doNotOptimize(edg.getCrvPoints(*crv, 64));
+    state.setItemsProcessed(64);
+  });
+}
+
+void registerKernels() {
+  // Noise
+  constexpr int kBlock = 4096;
+  std::vector<float> xs(kBlock), ys(kBlock), zs(kBlock);
+  for (int i = 0; i < kBlock; ++i) {
+    xs[i] = i * 0.013f;
+    ys[i] = std::sin(i * 0.01f) * 3.f;
+    zs[i] = i * 0.002f;
+  }
+  registerBench("Noise/fbm/3d/oct4/scalar", [=](BenchState &state) {
+    float acc = 0.f;
+    while (state.keepRunning()) {
+      for (int i = 0; i < kBlock; ++i)
+        acc += Noise::fbm(xs[i], ys[i], zs[i], 0.5f, 4);
+      doNotOptimize(acc);
+    }
+    state.setItemsProcessed(kBlock);
+  });
+  registerBench("Noise/fbm/3d/oct4/block", [=](BenchState &state) {
+    const Fbm fbm(0.5f, 4);
+    std::vector<float> out(kBlock);
+    while (state.keepRunning()) {
+      fbm(xs.data(), ys.data(), zs.data(), out.data(), kBlock);
+      doNotOptimize(out.data());
+    }
+    state.setItemsProcessed(kBlock);
+  });
+  registerBench("Ops/pNoise/3d/oct4", [=](BenchState &state) {
+    const Ops ops;
+    float acc = 0.f;
+    while (state.keepRunning()) {
+      for (int i = 0; i < kBlock; ++i)
+        acc += ops.pNoise(xs[i], ys[i], zs[i], 0.5f, 4);
+      doNotOptimize(acc);
+    }
+    state.setItemsProcessed(kBlock);
+  });
+  // Lookups into tiles that are already filled, the case the cache is for
+  const auto field = std::make_shared<NoiseField>(0.5f, 4);
+  registerBench("NoiseField/3d/oct4", [=](BenchState &state) {
+    float acc = 0.f;
+    while (state.keepRunning()) {
+      for (int i = 0; i < kBlock; ++i)
+        acc += (*field)(xs[i] * 0.05f, ys[i] * 0.1f, zs[i] * 0.1f);
+      doNotOptimize(acc);
+    }
+    state.setItemsProcessed(kBlock);
+  });
+
+  // Filters
+  const std::vector<float> signal = table(kBlock);
+  const auto filterBench = [signal](std::function<std::unique_ptr<Filter>()>
+                                        make) {
+    return [signal, make](BenchState &state) {
+      const auto filter = make();
+      std::vector<float> out(signal.size());
+      while (state.keepRunning()) {
+        filter->process(signal.data(), out.data(), signal.size());
+        doNotOptimize(out.data());
+      }
+      state.setItemsProcessed(signal.size());
+    };
+  };
+  registerBench("Filter/boxcar/16", filterBench([] {
+                  return std::make_unique<Boxcar>(16);
+                }));
+  registerBench("Filter/biquad", filterBench([] {
+                  return std::make_unique<Biquad>(BiquadType::LOWPASS, 0.1f);
+                }));
+  registerBench("Filter/sinc/31", filterBench([] {
+                  return std::make_unique<Sinc>(0.1f, 31);
+                }));
+
+  // Simplification and spatial queries
+  const std::vector<glm::vec3> path = noisyPath(kBlock);
+  registerBench("Simplify/rdp", [path](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(Simplify::rdp(path, 2.f));
+    state.setItemsProcessed(path.size());
+  });
+  registerBench("Simplify/visvalingam", [path](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(Simplify::visvalingam(path, 20.f));
+    state.setItemsProcessed(path.size());
+  });
+  registerBench("HashGrid/build", [path](BenchState &state) {
+    HashGrid grid;
+    while (state.keepRunning()) {
+      grid.build(path, 25.f);
+      doNotOptimize(grid.size());
+    }
+    state.setItemsProcessed(path.size());
+  });
+  registerBench("HashGrid/radius", [path](BenchState &state) {
+    const HashGrid grid(path, 25.f);
+    std::size_t found = 0;
+    while (state.keepRunning()) {
+      for (std::size_t i = 0; i < path.size(); i += 16)
+        found += grid.radius(path[i], 25.f).size();
+      doNotOptimize(found);
+    }
+    state.setItemsProcessed(path.size() / 16);
+  });
+  registerBench("KdTree/build", [path](BenchState &state) {
+    KdTree tree;
+    while (state.keepRunning()) {
+      tree.build(path, 1);
+      doNotOptimize(tree.size());
+    }
+    state.setItemsProcessed(path.size());
+  });
+  registerBench("KdTree/nearest/8", [path](BenchState &state) {
+    const KdTree tree(path);
+    std::size_t found = 0;
+    while (state.keepRunning()) {
+      for (std::size_t i = 0; i < path.size(); i += 16)
+        found += tree.nearest(path[i], 8).size();
+      doNotOptimize(found);
+    }
+    state.setItemsProcessed(path.size() / 16);
+  });
+
+  // Graph programs
+  registerBench("Graph/compile", [](BenchState &state) {
+    Graph graph;
+    const NodeId p = graph.pos();
+    const NodeId s = graph.sin(graph.mult(p, graph.c(glm::two_pi<float>())));
+    const NodeId root = graph.mean({s, graph.mult(s, s), p});
+    while (state.keepRunning())
+      doNotOptimize(graph.compile(root));
+  });
+  registerBench("Graph/eval", [](BenchState &state) {
+    Graph graph;
+    const NodeId p = graph.pos();
+    const NodeId s = graph.sin(graph.mult(p, graph.c(glm::two_pi<float>())));
+    const FloatOp op = graph.compile(graph.mean({s, graph.mult(s, s), p}));
+    float acc = 0.f;
+    while (state.keepRunning()) {
+      for (int i = 0; i < kSamples; ++i)
+        acc += op(i * (1.f / (kSamples - 1)));
+      doNotOptimize(acc);
+    }
+    state.setItemsProcessed(kSamples);
+  });
+
+  // Metrics recording
+  registerBench("Metrics/counter", [](BenchState &state) {
+    Counter counter;
+    while (state.keepRunning())
+      counter.add();
+    doNotOptimize(counter.get());
+  });
+  registerBench("Metrics/histogram", [](BenchState &state) {
+    Histogram histogram;
+    std::uint64_t value = 1;
+    while (state.keepRunning())
+      histogram.record(value = value * 6364136223846793005ull + 1);
+    doNotOptimize(histogram.snapshot());
+  });
+
+  // Table files
+  const std::string tablePath =
+      (std::filesystem::temp_directory_path() / "ofxCrvsBench.crvt").string();
+  {
+    TableWriter writer(tablePath);
+    writer.addOp("sine", Ops().sine(), 1 << 20);
+  }
+  registerBench("Table/open", [tablePath](BenchState &state) {
+    while (state.keepRunning())
+      doNotOptimize(TableFile::open(tablePath));
+  });
+  registerBench("Table/op", [tablePath](BenchState &state) {
+    const FloatOp op = TableFile::open(tablePath)->op("sine");
+    float acc = 0.f;
+    while (state.keepRunning()) {
+      for (int i = 0; i < kSamples; ++i)
+        acc += op(i * (1.f / (kSamples - 1)));
+      doNotOptimize(acc);
+    }
+    state.setItemsProcessed(kSamples);
+  });
+
+  // Chunked export, sampling and simplifying into a sink that drops chunks
+  registerBench("Export/simplify", [](BenchState &state) {
+    struct Discard : ExportSink {
+      void write(const ExportChunk &chunk) override {
+        doNotOptimize(chunk.points.data());
+      }
+    } sink;
+    const auto crv = Crv::create(Ops().sine());
+    constexpr std::uint64_t numPoints = 1 << 16;
+    while (state.keepRunning()) {
+      ExportPipeline(crv, numPoints, true, true, 4096)
+          .add(std::make_unique<SimplifyStage>(0.1f))
+          .run(sink);
+    }
+    state.setItemsProcessed(numPoints);
+  });
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  registerOps();
+  registerCrvs();
+  registerKernels();
+  return runBenchmarks(argc, argv);
+}
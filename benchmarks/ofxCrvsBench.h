@@ -0,0 +1,301 @@
+#pragma once
+
+#ifndef OFXCRVSBENCH_H
+#define OFXCRVSBENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ofxCrvs {
+
+/**
+ * Timing state handed to a benchmark body. Work before the first
+ * keepRunning() call is setup and not timed:
+ *
+ *   registerBench("Ops/sine", [](BenchState &state) {
+ *     const FloatOp op = Ops().sine();
+ *     while (state.keepRunning())
+ *       doNotOptimize(op(0.25f));
+ *   });
+ */
+class BenchState {
+public:
+  explicit BenchState(std::int64_t iterations) : remaining(iterations) {}
+
+  bool keepRunning() {
+    if (!started) {
+      started = true;
+      resumeTiming();
+    }
+    if (remaining-- > 0)
+      return true;
+    pauseTiming();
+    return false;
+  };
+
+  // Excludes per-iteration setup from the measurement
+  void pauseTiming() {
+    if (!running)
+      return;
+    realNs += std::chrono::duration<double, std::nano>(Clock::now() - realStart)
+                  .count();
+    cpuNs += (std::clock() - cpuStart) * (1e9 / CLOCKS_PER_SEC);
+    running = false;
+  };
+  void resumeTiming() {
+    realStart = Clock::now();
+    cpuStart = std::clock();
+    running = true;
+  };
+
+  // Items handled per iteration, reported as items_per_second
+  void setItemsProcessed(std::int64_t items) { itemsPerIteration = items; };
+
+  double getRealNs() const { return realNs; };
+  double getCpuNs() const { return cpuNs; };
+  std::int64_t getItemsProcessed() const { return itemsPerIteration; };
+
+private:
+  using Clock = std::chrono::steady_clock;
+  std::int64_t remaining;
+  std::int64_t itemsPerIteration = 0;
+  bool started = false;
+  bool running = false;
+  Clock::time_point realStart;
+  std::clock_t cpuStart = 0;
+  double realNs = 0.0;
+  double cpuNs = 0.0;
+};
+
+/** Keeps the compiler from discarding a value computed for timing only. */
+template <class T> inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+using BenchFn = std::function<void(BenchState &)>;
+
+struct Bench {
+  std::string name;
+  BenchFn fn;
+};
+
+inline std::vector<Bench> &benchRegistry() {
+  static std::vector<Bench> registry;
+  return registry;
+}
+
+inline void registerBench(std::string name, BenchFn fn) {
+  benchRegistry().push_back({std::move(name), std::move(fn)});
+}
+
+struct BenchResult {
+  std::string name;
+  std::int64_t iterations = 0;
+  int repetitions = 0;
+  // Medians over the repetitions, per iteration
+  double realNs = 0.0;
+  double cpuNs = 0.0;
+  double minRealNs = 0.0;
+  double itemsPerSecond = 0.0;
+};
+
+struct BenchOptions {
+  std::string filter = ".*";
+  double minTime = 0.1;
+  int repetitions = 3;
+  bool json = false;
+  std::string out;
+  bool list = false;
+};
+
+/**
+ * Times one benchmark. The iteration count grows until one run takes
+ * minTime; that count is then repeated and the median kept, so a stray slow
+ * run doesn't register as a regression.
+ */
+inline BenchResult runBench(const Bench &bench, const BenchOptions &options) {
+  // Discarded, so lazy caches and first-touch allocations don't skew the
+  // calibration
+  {
+    BenchState warmup(1);
+    bench.fn(warmup);
+  }
+  std::int64_t iterations = 1;
+  for (;;) {
+    BenchState state(iterations);
+    bench.fn(state);
+    const double seconds = state.getRealNs() * 1e-9;
+    if (seconds >= options.minTime || iterations >= 1000000000)
+      break;
+    const double scale =
+        seconds > 0.0 ? options.minTime / seconds * 1.4 : 100.0;
+    iterations = static_cast<std::int64_t>(
+        iterations * std::clamp(scale, 1.4, 100.0) + 1);
+  }
+
+  std::vector<double> real;
+  std::vector<double> cpu;
+  std::int64_t items = 0;
+  const int repetitions = std::max(options.repetitions, 1);
+  for (int r = 0; r < repetitions; ++r) {
+    BenchState state(iterations);
+    bench.fn(state);
+    real.push_back(state.getRealNs() / iterations);
+    cpu.push_back(state.getCpuNs() / iterations);
+    items = state.getItemsProcessed();
+  }
+  const auto median = [](std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    const std::size_t mid = values.size() / 2;
+    return values.size() % 2 ? values[mid]
+                             : 0.5 * (values[mid - 1] + values[mid]);
+  };
+
+  BenchResult result;
+  result.name = bench.name;
+  result.iterations = iterations;
+  result.repetitions = repetitions;
+  result.realNs = median(real);
+  result.cpuNs = median(cpu);
+  result.minRealNs = *std::min_element(real.begin(), real.end());
+  if (items > 0 && result.realNs > 0.0)
+    result.itemsPerSecond = items * 1e9 / result.realNs;
+  return result;
+}
+
+inline std::string jsonEscape(const std::string &s) {
+  std::string escaped;
+  for (const char ch : s) {
+    if (ch == '"' || ch == '\\')
+      escaped += '\\';
+    escaped += ch;
+  }
+  return escaped;
+}
+
+/**
+ * Writes Google Benchmark's JSON layout, one median aggregate per
+ * benchmark, so results can be compared with either tool's script.
+ */
+inline void writeJson(std::ostream &os, const std::vector<BenchResult> &results,
+                      const std::string &executable) {
+  const std::time_t now = std::time(nullptr);
+  char date[32];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+  os << "{\n  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+  os << "    \"executable\": \"" << jsonEscape(executable) << "\",\n";
+#ifdef NDEBUG
+  os << "    \"library_build_type\": \"release\"\n";
+#else
+  os << "    \"library_build_type\": \"debug\"\n";
+#endif
+  os << "  },\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const BenchResult &r = results[i];
+    os << (i ? ",\n" : "\n") << "    {";
+    os << "\"name\": \"" << jsonEscape(r.name) << "_median\", ";
+    os << "\"run_name\": \"" << jsonEscape(r.name) << "\", ";
+    os << "\"run_type\": \"aggregate\", \"aggregate_name\": \"median\", ";
+    os << "\"repetitions\": " << r.repetitions << ", ";
+    os << "\"iterations\": " << r.iterations << ", ";
+    os << "\"real_time\": " << r.realNs << ", ";
+    os << "\"cpu_time\": " << r.cpuNs << ", ";
+    os << "\"min_real_time\": " << r.minRealNs << ", ";
+    if (r.itemsPerSecond > 0.0)
+      os << "\"items_per_second\": " << r.itemsPerSecond << ", ";
+    os << "\"time_unit\": \"ns\"}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+inline void writeConsole(std::ostream &os, const BenchResult &r) {
+  char line[256];
+  std::snprintf(line, sizeof(line), "%-48s %14.1f ns %14.1f ns %12lld",
+                r.name.c_str(), r.realNs, r.cpuNs,
+                static_cast<long long>(r.iterations));
+  os << line;
+  if (r.itemsPerSecond > 0.0) {
+    std::snprintf(line, sizeof(line), " %10.3gM items/s",
+                  r.itemsPerSecond * 1e-6);
+    os << line;
+  }
+  os << std::endl;
+}
+
+/**
+ * Flags: --filter=<regex>, --min-time=<seconds>, --repetitions=<n>,
+ * --format=console|json, --out=<file> (implies json), --list.
+ */
+inline int runBenchmarks(int argc, char **argv) {
+  BenchOptions options;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const auto value = [&arg](const std::string &flag) {
+      return arg.compare(0, flag.size(), flag) == 0 ? arg.substr(flag.size())
+                                                   : std::string();
+    };
+    if (!value("--filter=").empty())
+      options.filter = value("--filter=");
+    else if (!value("--min-time=").empty())
+      options.minTime = std::stod(value("--min-time="));
+    else if (!value("--repetitions=").empty())
+      options.repetitions = std::stoi(value("--repetitions="));
+    else if (!value("--format=").empty())
+      options.json = value("--format=") == "json";
+    else if (!value("--out=").empty()) {
+      options.out = value("--out=");
+      options.json = true;
+    } else if (arg == "--list")
+      options.list = true;
+    else {
+      std::cerr << "unknown flag " << arg << std::endl;
+      return 2;
+    }
+  }
+
+  const std::regex filter(options.filter);
+  std::vector<BenchResult> results;
+  for (const Bench &bench : benchRegistry()) {
+    if (!std::regex_search(bench.name, filter))
+      continue;
+    if (options.list) {
+      std::cout << bench.name << std::endl;
+      continue;
+    }
+    results.push_back(runBench(bench, options));
+    writeConsole(options.json && options.out.empty() ? std::cerr : std::cout,
+                 results.back());
+  }
+  if (!options.json || options.list)
+    return 0;
+  if (options.out.empty()) {
+    writeJson(std::cout, results, argv[0]);
+    return 0;
+  }
+  std::ofstream file(options.out);
+  if (!file) {
+    std::cerr << "cannot write " << options.out << std::endl;
+    return 1;
+  }
+  writeJson(file, results, argv[0]);
+  return 0;
+}
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSBENCH_H
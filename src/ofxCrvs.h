@@ -1,13 +1,4 @@
 #pragma once
 
-#include "ofxCrvsBox.hpp"
-#include "ofxCrvsBufferedContainer.h"
-#include "ofxCrvsCloudOps.h"
-#include "ofxCrvsConstants.h"
-#include "ofxCrvsCrv.h"
-#include "ofxCrvsEdg.hpp"
-#include "ofxCrvsHypr.h"
-#include "ofxCrvsLsjs.hpp"
-#include "ofxCrvsOps.h"
-#include "ofxCrvsPtrn.h"
-#include "ofxCrvsUtils.hpp"
\ No newline at end of file
+#include "ofxCrvsLib.h"
+#include "ofxCrvsOf.h"
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "ofxCrvsArcLength.h"
+
+namespace ofxCrvs {
+
+void ArcLength::build(const std::vector<glm::vec3> &points) {
+  cumulative.resize(points.size());
+  if (points.empty())
+    return;
+  cumulative[0] = 0.f;
+  for (std::size_t i = 1; i < points.size(); ++i) {
+    cumulative[i] = cumulative[i - 1] + glm::distance(points[i - 1], points[i]);
+  }
+}
+
+float ArcLength::length() const {
+  return cumulative.empty() ? 0.f : cumulative.back();
+}
+
+float ArcLength::lengthAt(float pos) const {
+  if (cumulative.size() < 2)
+    return 0.f;
+  const float exactPos = clampValue(pos, 0.f, 1.f) * (cumulative.size() - 1);
+  const std::size_t index =
+      std::min(static_cast<std::size_t>(exactPos), cumulative.size() - 2);
+  return lerpValue(cumulative[index], cumulative[index + 1], exactPos - index);
+}
+
+float ArcLength::posAt(float fraction) const {
+  return posAtLength(clampValue(fraction, 0.f, 1.f) * length());
+}
+
+float ArcLength::posAtLength(float distance) const {
+  if (cumulative.size() < 2 || length() <= 0.f)
+    return clampValue(distance, 0.f, 1.f);
+  const auto upper =
+      std::upper_bound(cumulative.begin(), cumulative.end(), distance);
+  if (upper == cumulative.begin())
+    return 0.f;
+  if (upper == cumulative.end())
+    return 1.f;
+  const std::size_t index = std::distance(cumulative.begin(), upper) - 1;
+  const float segment = cumulative[index + 1] - cumulative[index];
+  const float fraction =
+      segment > 0.f ? (distance - cumulative[index]) / segment : 0.f;
+  return (index + fraction) / (cumulative.size() - 1);
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef OFXCRVSARCLENGTH_H
+#define OFXCRVSARCLENGTH_H
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Cumulative chord-length table over points sampled at uniform curve
+ * positions, used to map a fraction of the path length back to a position.
+ */
+class ArcLength {
+public:
+  ArcLength() = default;
+  explicit ArcLength(const std::vector<glm::vec3> &points) { build(points); }
+  ArcLength(const std::vector<glm::vec3> &points, std::vector<float> key)
+      : key(std::move(key)) {
+    build(points);
+  }
+
+  void build(const std::vector<glm::vec3> &points);
+
+  float length() const;
+  float lengthAt(float pos) const;
+  float posAt(float fraction) const;
+  float posAtLength(float distance) const;
+
+  // Parameters the table was sampled with, compared by the owner to decide
+  // when the table is stale.
+  const std::vector<float> &getKey() const { return key; };
+
+private:
+  std::vector<float> key;
+  std::vector<float> cumulative;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSARCLENGTH_H
@@ -0,0 +1,124 @@
+#include "ofxCrvsAudioRenderer.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace ofxCrvs {
+
+AudioRenderer::AudioRenderer(const float sampleRate, const int maxChannels)
+    : sampleRate(sampleRate), maxChannels(maxChannels) {
+  if (sampleRate <= 0.f)
+    throw std::invalid_argument("AudioRenderer: sample rate must be positive");
+  if (maxChannels <= 0)
+    throw std::invalid_argument("AudioRenderer: needs at least one channel");
+  channels = std::make_unique<Channel[]>(maxChannels);
+}
+
+int AudioRenderer::addChannel(std::shared_ptr<const Crv> crv,
+                              const float frequency, const float phase,
+                              const Component component) {
+  if (!crv)
+    throw std::invalid_argument("AudioRenderer: null Crv");
+  const int index = numChannels.load(std::memory_order_relaxed);
+  if (index >= maxChannels)
+    throw std::runtime_error("AudioRenderer: all " +
+                             std::to_string(maxChannels) +
+                             " channels are in use");
+  Channel &channel = channels[index];
+  channel.crv = std::move(crv);
+  channel.component = component;
+  channel.startPhase = phase - std::floor(phase);
+  channel.frequency.store(frequency, std::memory_order_relaxed);
+  channel.phase = channel.startPhase;
+  channel.lastPhase.store(channel.startPhase, std::memory_order_relaxed);
+  // Publishes the channel to the audio thread
+  numChannels.store(index + 1, std::memory_order_release);
+  return index;
+}
+
+AudioRenderer::Channel &AudioRenderer::channelAt(const int channel) const {
+  if (channel < 0 || channel >= getNumChannels())
+    throw std::out_of_range("AudioRenderer: no channel " +
+                            std::to_string(channel));
+  return channels[channel];
+}
+
+void AudioRenderer::setFrequency(const int channel, const float frequency) {
+  channelAt(channel).frequency.store(frequency, std::memory_order_relaxed);
+}
+
+void AudioRenderer::setPhase(const int channel, const float phase) {
+  channelAt(channel).pendingPhase.store(phase - std::floor(phase),
+                                        std::memory_order_release);
+}
+
+void AudioRenderer::reset() {
+  for (int c = 0; c < getNumChannels(); ++c)
+    channels[c].pendingPhase.store(channels[c].startPhase,
+                                   std::memory_order_release);
+}
+
+float AudioRenderer::getFrequency(const int channel) const {
+  return channelAt(channel).frequency.load(std::memory_order_relaxed);
+}
+
+float AudioRenderer::getPhase(const int channel) const {
+  return channelAt(channel).lastPhase.load(std::memory_order_relaxed);
+}
+
+void AudioRenderer::renderChannel(Channel &channel, float *out,
+                                  const std::size_t numFrames,
+                                  const std::size_t stride) {
+  const float pending =
+      channel.pendingPhase.exchange(-1.f, std::memory_order_acq_rel);
+  if (pending >= 0.f)
+    channel.phase = pending;
+
+  float (Crv::*at)(float) const = &Crv::yAt;
+  switch (channel.component) {
+  case Component::X:
+    at = &Crv::xAt;
+    break;
+  case Component::Z:
+    at = &Crv::zAt;
+    break;
+  case Component::W:
+    at = &Crv::wAt;
+    break;
+  default:
+    break;
+  }
+
+  // Double precision keeps slow LFOs from drifting over long runs
+  const double increment =
+      channel.frequency.load(std::memory_order_relaxed) / sampleRate;
+  const Crv &crv = *channel.crv;
+  double phase = channel.phase;
+  for (std::size_t i = 0; i < numFrames; ++i) {
+    out[i * stride] = (crv.*at)(static_cast<float>(phase));
+    phase += increment;
+    if (phase >= 1.0 || phase < 0.0)
+      phase -= std::floor(phase);
+  }
+  channel.phase = phase;
+  channel.lastPhase.store(static_cast<float>(phase),
+                          std::memory_order_relaxed);
+}
+
+void AudioRenderer::renderInterleaved(float *out, const std::size_t numFrames,
+                                      std::size_t stride) {
+  const int count = getNumChannels();
+  if (stride == 0)
+    stride = count;
+  for (int c = 0; c < count && static_cast<std::size_t>(c) < stride; ++c)
+    renderChannel(channels[c], out + c, numFrames, stride);
+}
+
+void AudioRenderer::renderPlanar(float *const *out,
+                                 const std::size_t numFrames) {
+  const int count = getNumChannels();
+  for (int c = 0; c < count; ++c)
+    renderChannel(channels[c], out[c], numFrames, 1);
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,88 @@
+#pragma once
+
+#ifndef OFXCRVSAUDIORENDERER_H
+#define OFXCRVSAUDIORENDERER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsCrv.h"
+
+namespace ofxCrvs {
+
+/**
+ * Renders Crvs at audio rate, e.g. as LFOs or control signals, straight
+ * into an audio callback's buffers. Each channel plays one curve once per
+ * cycle at its own frequency, driven by a phase accumulator that carries
+ * over between calls, so consecutive blocks of any size join seamlessly.
+ *
+ * Channel storage is allocated once in the constructor. render*() never
+ * allocates or locks, so it is as real-time safe as the curves' own ops;
+ * the renderer adds nothing that could block. Frequencies can be changed
+ * from another thread while rendering. Channels may be added while
+ * rendering, but not from more than one thread at a time.
+ *
+ *   AudioRenderer lfos(48000.f, 2);
+ *   lfos.addChannel(Crv::create(Ops().sine()), 0.5f);
+ *   lfos.addChannel(Crv::create(Ops().tri()), 3.f);
+ *   // in the audio callback:
+ *   lfos.renderInterleaved(buffer, numFrames);
+ */
+class AudioRenderer {
+public:
+  AudioRenderer(float sampleRate, int maxChannels);
+
+  // Adds a channel playing component of crv at frequency cycles per
+  // second, starting at phase in [0, 1). Returns the channel index.
+  int addChannel(std::shared_ptr<const Crv> crv, float frequency,
+                 float phase = 0.f, Component component = Component::Y);
+
+  void setFrequency(int channel, float frequency);
+  // Jumps a channel to phase in [0, 1); applied at the next render call
+  void setPhase(int channel, float phase);
+  // Restarts every channel at the phase it was added with
+  void reset();
+
+  [[nodiscard]] float getFrequency(int channel) const;
+  [[nodiscard]] float getPhase(int channel) const;
+  [[nodiscard]] float getSampleRate() const { return sampleRate; };
+  [[nodiscard]] int getNumChannels() const {
+    return numChannels.load(std::memory_order_acquire);
+  };
+
+  // Writes numFrames frames of stride floats each; channel c goes to
+  // out[frame * stride + c]. stride defaults to the channel count and
+  // channels beyond stride are skipped.
+  void renderInterleaved(float *out, std::size_t numFrames,
+                         std::size_t stride = 0);
+  // Writes numFrames floats into out[c] for each channel c
+  void renderPlanar(float *const *out, std::size_t numFrames);
+
+private:
+  struct Channel {
+    std::shared_ptr<const Crv> crv;
+    Component component = Component::Y;
+    float startPhase = 0.f;
+    std::atomic<float> frequency{0.f};
+    // Set by setPhase(); picked up by the audio thread, which owns phase
+    std::atomic<float> pendingPhase{-1.f};
+    std::atomic<float> lastPhase{0.f};
+    double phase = 0.0;
+  };
+
+  // Renders numFrames of channel into out, every stride floats
+  void renderChannel(Channel &channel, float *out, std::size_t numFrames,
+                     std::size_t stride);
+  Channel &channelAt(int channel) const;
+
+  float sampleRate;
+  int maxChannels;
+  std::unique_ptr<Channel[]> channels;
+  std::atomic<int> numChannels{0};
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSAUDIORENDERER_H
@@ -10,13 +10,13 @@
 #ifndef ofxCrvsWindow_hpp
 #define ofxCrvsWindow_hpp
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 
 namespace ofxCrvs {
 
-class Box : public ofBoxPrimitive {
+class Box : public BoxPrimitive {
  public:
-  using ofBoxPrimitive::ofBoxPrimitive;
+  using BoxPrimitive::BoxPrimitive;
 
   void apply(glm::vec3& v) const;
 };
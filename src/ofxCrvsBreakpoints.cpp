@@ -0,0 +1,126 @@
+#include "ofxCrvsBreakpoints.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ofxCrvs {
+
+namespace {
+
+// Relative spacing error still treated as uniform
+constexpr float uniformTolerance = 1e-5f;
+
+} // namespace
+
+Breakpoints::Breakpoints(const vector<vector<float>> &points) {
+  positions.reserve(points.size());
+  values.reserve(points.size());
+  shapes.reserve(points.size());
+  curvatures.reserve(points.size());
+  for (const vector<float> &point : points) {
+    if (point.size() > 2)
+      add(point[0], point[1], Shape::CURVE, point[2]);
+    else
+      add(point[0], point[1]);
+  }
+}
+
+Breakpoints::Breakpoints(const Breakpoints &other)
+    : positions(other.positions), values(other.values), shapes(other.shapes),
+      curvatures(other.curvatures), uniform(other.uniform),
+      invSpacing(other.invSpacing) {}
+
+Breakpoints &Breakpoints::operator=(const Breakpoints &other) {
+  positions = other.positions;
+  values = other.values;
+  shapes = other.shapes;
+  curvatures = other.curvatures;
+  uniform = other.uniform;
+  invSpacing = other.invSpacing;
+  cursor.store(0, std::memory_order_relaxed);
+  return *this;
+}
+
+void Breakpoints::add(const float pos, const float value, const Shape shape,
+                      const float curvature) {
+  positions.push_back(pos);
+  values.push_back(value);
+  shapes.push_back(shape);
+  curvatures.push_back(curvature);
+  const std::size_t n = positions.size();
+  if (n < 2)
+    return;
+  const float first = positions[1] - positions[0];
+  const float step = positions[n - 1] - positions[n - 2];
+  uniform = uniform && first > 0.f &&
+            std::abs(step - first) <= uniformTolerance * first;
+  invSpacing =
+      uniform ? (n - 1) / (positions.back() - positions.front()) : 0.f;
+}
+
+int Breakpoints::segmentAt(const float pos) const {
+  const int n = static_cast<int>(positions.size());
+  if (uniform && n > 1) {
+    const float exact = (pos - positions.front()) * invSpacing;
+    int index = static_cast<int>(std::floor(exact));
+    index = std::min(std::max(index, -1), n - 1);
+    // Rounding in the spacing can put pos one segment off near a point
+    if (index >= 0 && pos < positions[index])
+      --index;
+    else if (index + 1 < n && pos >= positions[index + 1])
+      ++index;
+    return index;
+  }
+  const int hint = cursor.load(std::memory_order_relaxed);
+  if (hint < n && positions[hint] <= pos) {
+    if (hint + 1 == n || pos < positions[hint + 1])
+      return hint;
+    if (hint + 2 == n || pos < positions[hint + 2]) {
+      cursor.store(hint + 1, std::memory_order_relaxed);
+      return hint + 1;
+    }
+  }
+  const int index = static_cast<int>(std::upper_bound(positions.begin(),
+                                                      positions.end(), pos) -
+                                     positions.begin()) -
+                    1;
+  cursor.store(std::max(index, 0), std::memory_order_relaxed);
+  return index;
+}
+
+float Breakpoints::shaped(const int segment, const float fraction) const {
+  switch (shapes[segment]) {
+  case Shape::HOLD:
+    return 0.f;
+  case Shape::CURVE: {
+    const float curvature = curvatures[segment];
+    if (std::abs(curvature) < 1e-3f)
+      return fraction;
+    return (1.f - std::exp(curvature * fraction)) /
+           (1.f - std::exp(curvature));
+  }
+  case Shape::SINE:
+    return 0.5f - 0.5f * std::cos(glm::pi<float>() * fraction);
+  case Shape::LINEAR:
+  default:
+    return fraction;
+  }
+}
+
+float Breakpoints::operator()(const float pos) const {
+  if (positions.empty())
+    return 0.f;
+  const int segment = segmentAt(pos);
+  if (segment < 0)
+    return values.front();
+  if (segment + 1 >= static_cast<int>(positions.size()))
+    return 0.f;
+  const float prevPos = positions[segment];
+  const float nextPos = positions[segment + 1];
+  const float fraction = (pos - prevPos) / (nextPos - prevPos);
+  const float prevVal = values[segment];
+  const float nextVal = values[segment + 1];
+  return prevVal + (shaped(segment, fraction) * (nextVal - prevVal));
+}
+
+} // namespace ofxCrvs
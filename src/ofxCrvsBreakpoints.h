@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef OFXCRVSBREAKPOINTS_H
+#define OFXCRVSBREAKPOINTS_H
+
+#include <atomic>
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+// How a segment moves from its start point to the next one
+enum class Shape {
+  LINEAR,
+  // Holds the start value until the next point
+  HOLD,
+  // Exponential bend: curvature > 0 eases in, < 0 eases out, 0 is linear
+  CURVE,
+  // Half-cosine ease in and out
+  SINE,
+};
+
+/**
+ * Breakpoint envelope stored as flat sorted arrays. Lookup is O(1) when the
+ * points are evenly spaced and O(log n) otherwise, with a cursor that
+ * remembers the last segment so ascending sweeps stay O(1) per sample.
+ * Before the first point it returns the first value, and from the last
+ * point on it returns 0.
+ */
+class Breakpoints {
+public:
+  Breakpoints() = default;
+  // Rows of {pos, value} or {pos, value, curvature}; a curvature makes the
+  // segment starting at that point a CURVE.
+  explicit Breakpoints(const vector<vector<float>> &points);
+  Breakpoints(const Breakpoints &other);
+  Breakpoints &operator=(const Breakpoints &other);
+
+  // Points must be added in ascending pos order
+  void add(float pos, float value, Shape shape = Shape::LINEAR,
+           float curvature = 0.f);
+
+  float operator()(float pos) const;
+
+  std::size_t size() const { return positions.size(); };
+
+private:
+  // Index of the last point at or before pos, or -1 before the first
+  int segmentAt(float pos) const;
+  float shaped(int segment, float fraction) const;
+
+  vector<float> positions;
+  vector<float> values;
+  vector<Shape> shapes;
+  vector<float> curvatures;
+
+  bool uniform = true;
+  float invSpacing = 0.f;
+
+  // Only a hint, so relaxed races between threads are harmless
+  mutable std::atomic<int> cursor{0};
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSBREAKPOINTS_H
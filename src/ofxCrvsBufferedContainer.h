@@ -6,7 +6,8 @@
 #ifndef OFXCRVSBUFFEREDCONTAINER_H
 #define OFXCRVSBUFFEREDCONTAINER_H
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
+#include "ofxCrvsMetrics.h"
 
 namespace ofxCrvs {
 
@@ -26,10 +27,23 @@ public:
   }
 
   void set(T value) {
+    const bool contended = writers.fetch_add(1, std::memory_order_acquire) > 0;
     const int cacheIdx =
         currentCacheIndex.load(std::memory_order_acquire) == 0 ? 1 : 0;
     bufferedCache[cacheIdx] = value;
     currentCacheIndex.store(cacheIdx, std::memory_order_release);
+    writers.fetch_sub(1, std::memory_order_release);
+    if (swaps)
+      swaps->add();
+    if (contended && contendedSwaps)
+      contendedSwaps->add();
+  }
+
+  // Counts swaps, and set() calls that overlapped another writer and may
+  // have torn the back buffer. Either may be null; set before sharing.
+  void setMetrics(Counter *swaps, Counter *contendedSwaps) {
+    this->swaps = swaps;
+    this->contendedSwaps = contendedSwaps;
   }
 
   std::size_t size() const {
@@ -41,6 +55,9 @@ public:
 private:
   std::array<T, 2> bufferedCache;
   std::atomic<int> currentCacheIndex{0};
+  std::atomic<int> writers{0};
+  Counter *swaps = nullptr;
+  Counter *contendedSwaps = nullptr;
 };
 
 } // namespace ofxCrvs
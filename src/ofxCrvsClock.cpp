@@ -0,0 +1,49 @@
+#include "ofxCrvsClock.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ofxCrvs {
+
+SampleClock::SampleClock(const float sampleRate) : sampleRate(sampleRate) {
+  if (sampleRate <= 0.f)
+    throw std::invalid_argument("SampleClock: sample rate must be positive");
+}
+
+void SampleClock::advance(const std::uint64_t numFrames) {
+  reset(frame + numFrames);
+}
+
+void SampleClock::reset(const std::uint64_t frame) {
+  this->frame = frame;
+  // From the frame count each time, so no rounding error builds up
+  publish(static_cast<double>(frame) * 1000000.0 / sampleRate);
+}
+
+SyncedClock::SyncedClock(const double smoothing) : smoothing(smoothing) {
+  if (smoothing <= 0.0 || smoothing > 1.0)
+    throw std::invalid_argument("SyncedClock: smoothing must be in (0, 1]");
+  tick();
+}
+
+void SyncedClock::sync(const double timelineMicros) {
+  const double target =
+      timelineMicros - static_cast<double>(elapsedMicros());
+  const double current = offset.load(std::memory_order_relaxed);
+  offset.store(synced ? current + (target - current) * smoothing : target,
+               std::memory_order_relaxed);
+  if (!synced)
+    jumped.store(true, std::memory_order_release);
+  synced = true;
+}
+
+void SyncedClock::tick() {
+  const double time =
+      static_cast<double>(elapsedMicros()) + getOffset();
+  // Only the first sync may move time backwards
+  publish(jumped.exchange(false, std::memory_order_acquire)
+              ? time
+              : std::max(micros(), time));
+}
+
+} // namespace ofxCrvs
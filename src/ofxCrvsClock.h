@@ -0,0 +1,117 @@
+#pragma once
+
+#ifndef OFXCRVSCLOCK_H
+#define OFXCRVSCLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Time source for Ops::timePhasor() and Ops::tempoPhasor(). A clock keeps
+ * one cached timestamp that the phasors read with a relaxed atomic load,
+ * so evaluating them costs no OS clock read; whoever drives the clock
+ * moves the timestamp once per block or frame. Every op reading the same
+ * clock within a block sees the same time.
+ *
+ *   auto clock = std::make_shared<SampleClock>(48000.f);
+ *   Ops ops;
+ *   ops.setClock(clock);
+ *   auto lfo = Crv::create(ops.tempoPhasor(1.0, 128.0));
+ *   // in the audio callback, after rendering the block:
+ *   clock->advance(numFrames);
+ */
+class Clock {
+public:
+  virtual ~Clock() = default;
+
+  // The cached time in microseconds; safe to read from any thread
+  [[nodiscard]] double micros() const {
+    return now.load(std::memory_order_relaxed);
+  };
+  [[nodiscard]] double seconds() const { return micros() / 1000000.0; };
+
+  // Refreshes the cached time from the source, for clocks that have one
+  virtual void tick() {}
+
+protected:
+  void publish(double micros) {
+    now.store(micros, std::memory_order_relaxed);
+  };
+
+private:
+  std::atomic<double> now{0.0};
+};
+
+// elapsedMicros() as of the last tick(); call tick() once per
+// frame or block
+class WallClock : public Clock {
+public:
+  WallClock() { tick(); }
+  void tick() override {
+    publish(static_cast<double>(elapsedMicros()));
+  };
+};
+
+/**
+ * Time counted in audio samples: advance() by each block's frame count
+ * from the audio callback, and the phasors stay locked to the audio stream
+ * whatever the callback's wall clock jitter.
+ */
+class SampleClock : public Clock {
+public:
+  explicit SampleClock(float sampleRate);
+
+  void advance(std::uint64_t numFrames);
+  void reset(std::uint64_t frame = 0);
+  [[nodiscard]] std::uint64_t getFrame() const { return frame; };
+  [[nodiscard]] float getSampleRate() const { return sampleRate; };
+
+private:
+  float sampleRate;
+  std::uint64_t frame = 0;
+};
+
+// Time set by hand, e.g. by an offline render stepping a frame at a time
+// faster than real time
+class ManualClock : public Clock {
+public:
+  void set(double seconds) { publish(seconds * 1000000.0); };
+  void advance(double seconds) { set(this->seconds() + seconds); };
+};
+
+/**
+ * Local time steered onto an external timeline, such as a sync master
+ * shared by several machines. Call sync() with the timeline's time as each
+ * timestamp arrives, from any one thread, and tick() once per block. Each
+ * sync moves the offset from local time a fraction smoothing of the way
+ * to the new one, so network jitter doesn't show; the first jumps
+ * straight there. Apart from that first jump, the cached time never runs
+ * backwards.
+ */
+class SyncedClock : public Clock {
+public:
+  // smoothing in (0, 1]; 1 follows every timestamp exactly
+  explicit SyncedClock(double smoothing = 0.1);
+
+  void sync(double timelineMicros);
+  void tick() override;
+  // Timeline minus local time, in microseconds
+  [[nodiscard]] double getOffset() const {
+    return offset.load(std::memory_order_relaxed);
+  };
+
+private:
+  double smoothing;
+  std::atomic<double> offset{0.0};
+  bool synced = false;
+  // Set by the first sync() for the next tick()
+  std::atomic<bool> jumped{false};
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSCLOCK_H
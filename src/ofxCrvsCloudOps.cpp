@@ -0,0 +1,145 @@
+#include "ofxCrvsCloudOps.h"
+
+#include "ofxCrvsNoise.h"
+#include "ofxCrvsUtils.hpp"
+
+namespace ofxCrvs {
+
+CloudOp CloudOps::zero() const {
+  return [](const CloudChunk &chunk) {
+    std::fill(chunk.points, chunk.points + chunk.size, glm::vec3(0.f));
+  };
+}
+
+CloudOp CloudOps::floatOp(const FloatOp op) const {
+  return tripleFloatOp(op, op, op);
+}
+
+CloudOp CloudOps::tripleFloatOp(const FloatOp xOp, const FloatOp yOp,
+                                const FloatOp zOp) const {
+  return [xOp, yOp, zOp](const CloudChunk &chunk) {
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      glm::vec3 &p = chunk.points[i];
+      if (xOp)
+        p.x = xOp(p.x);
+      if (yOp)
+        p.y = yOp(p.y);
+      if (zOp)
+        p.z = zOp(p.z);
+    }
+  };
+}
+
+CloudOp CloudOps::tripleCrv(const std::shared_ptr<Crv> xCrv,
+                            const std::shared_ptr<Crv> yCrv,
+                            const std::shared_ptr<Crv> zCrv) const {
+  return [xCrv, yCrv, zCrv](const CloudChunk &chunk) {
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      glm::vec3 &p = chunk.points[i];
+      if (xCrv)
+        p.x = xCrv->yAt(p.x);
+      if (yCrv)
+        p.y = yCrv->yAt(p.y);
+      if (zCrv)
+        p.z = zCrv->yAt(p.z);
+    }
+  };
+}
+
+CloudOp CloudOps::displace(const std::shared_ptr<Crv> crv,
+                           const glm::vec3 amount,
+                           const bool transformed) const {
+  return [crv, amount, transformed](const CloudChunk &chunk) {
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      const glm::vec3 offset = crv->uVector(chunk.posAt(i), transformed);
+      chunk.points[i] += (offset - UCENTER) * amount;
+    }
+  };
+}
+
+CloudOp CloudOps::displace(const FloatOp op, const glm::vec3 direction) const {
+  return [op, direction](const CloudChunk &chunk) {
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      chunk.points[i] += direction * op(chunk.posAt(i));
+    }
+  };
+}
+
+CloudOp CloudOps::transform(const glm::vec3 center, const glm::vec3 scale,
+                            const glm::vec3 translation,
+                            const float rotation) const {
+  return [center, scale, translation, rotation](const CloudChunk &chunk) {
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      Utils::transform(chunk.points[i], center, scale, translation, rotation);
+    }
+  };
+}
+
+CloudOp CloudOps::noiseWarp(const float frequency, const float amplitude,
+                            const float time,
+                            const std::uint32_t seed) const {
+  return [frequency, amplitude, time, seed](const CloudChunk &chunk) {
+    // Offset each axis in the 4th noise dimension so the warp isn't diagonal.
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      glm::vec3 &p = chunk.points[i];
+      const glm::vec3 f = p * frequency;
+      const glm::vec3 warp(
+          Noise::signedNoise(f.x, f.y, f.z, time, seed),
+          Noise::signedNoise(f.x, f.y, f.z, time + 31.7f, seed),
+          Noise::signedNoise(f.x, f.y, f.z, time + 73.1f, seed));
+      p += warp * amplitude;
+    }
+  };
+}
+
+CloudOp CloudOps::attract(const glm::vec3 target, const float strength,
+                          const float radius) const {
+  const float radiusSq = radius * radius;
+  return [target, strength, radius, radiusSq](const CloudChunk &chunk) {
+    for (std::size_t i = 0; i < chunk.size; ++i) {
+      glm::vec3 &p = chunk.points[i];
+      const glm::vec3 toTarget = target - p;
+      const float distSq = glm::dot(toTarget, toTarget);
+      if (distSq >= radiusSq || distSq == 0.f)
+        continue;
+      // Linear falloff from full strength at the target to zero at radius
+      const float falloff = 1.f - std::sqrt(distSq) / radius;
+      p += toTarget * (strength * falloff);
+    }
+  };
+}
+
+CloudOp CloudOps::repel(const glm::vec3 target, const float strength,
+                        const float radius) const {
+  return attract(target, -strength, radius);
+}
+
+CloudOp CloudOps::chain(const vector<CloudOp> ops) const {
+  // Each op runs over the whole chunk before the next, so the chain touches
+  // memory once per chunk while it is still in cache.
+  return [ops](const CloudChunk &chunk) {
+    for (const auto &op : ops) {
+      op(chunk);
+    }
+  };
+}
+
+void CloudOps::apply(const CloudOp &op, glm::vec3 *points,
+                     const std::size_t count, const int numThreads,
+                     const std::size_t chunkSize) const {
+  if (!op)
+    return;
+  Utils::parallelFor(
+      count, chunkSize,
+      [&op, points, count](const std::size_t begin, const std::size_t end) {
+        op(CloudChunk{points + begin, end - begin, begin, count});
+      },
+      numThreads);
+}
+
+void CloudOps::apply(const CloudOp &op, vector<glm::vec3> &cloud,
+                     const int numThreads, const std::size_t chunkSize) const {
+  apply(op, cloud.data(), cloud.size(), numThreads, chunkSize);
+}
+
+}  // namespace ofxCrvs
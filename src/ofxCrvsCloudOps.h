@@ -1,31 +1,69 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsOps.h"
 
 namespace ofxCrvs {
 
-using CloudOp = std::function<vector<glm::vec3>(vector<glm::vec3>)>;
+/**
+ * A contiguous run of points handed to a CloudOp. `first` is the index of
+ * points[0] within the whole cloud of `total` points, so ops can map each
+ * point to a curve position regardless of how the cloud was chunked.
+ */
+struct CloudChunk {
+  glm::vec3 *points;
+  std::size_t size;
+  std::size_t first;
+  std::size_t total;
+
+  float posAt(std::size_t i) const {
+    return total > 1 ? static_cast<float>(first + i) / (total - 1) : 0.f;
+  }
+};
+
+// CloudOps modify points in place. Ops run concurrently on disjoint chunks, so
+// any FloatOp or Crv they capture must be free of per-call state (e.g. avoid
+// ema() or sineFb()) unless apply() is called with a single thread.
+using CloudOp = std::function<void(const CloudChunk &)>;
 
 class CloudOps {
  public:
-  CloudOp zero() {
-    return [](vector<glm::vec3> cloud) {
-      return vector<glm::vec3>(cloud.size(), glm::vec3(0.0f));
-    };
-  };
-
-  // CloudOp tripleFloatOp(FloatOp xOp, FloatOp yOp, FloatOp zOp) {
-  //   return [xOp, yOp, zOp](vector<glm::vec3> cloud) {
-  //     vector<glm::vec3> newCloud;
-  //     for (int i = 0; i < cloud.size(); i++) {
-  //       newCloud.push_back(
-  //           glm::vec3(xOp(cloud[i].x), yOp(cloud[i].y), zOp(cloud[i].z)));
-  //     }
-  //     return newCloud;
-  //   };
-  // };
+  static constexpr std::size_t defaultChunkSize = 4096;
+
+  [[nodiscard]] CloudOp zero() const;
+  [[nodiscard]] CloudOp floatOp(const FloatOp op) const;
+  [[nodiscard]] CloudOp tripleFloatOp(const FloatOp xOp, const FloatOp yOp,
+                                      const FloatOp zOp) const;
+  [[nodiscard]] CloudOp tripleCrv(const std::shared_ptr<Crv> xCrv,
+                                  const std::shared_ptr<Crv> yCrv,
+                                  const std::shared_ptr<Crv> zCrv) const;
+  [[nodiscard]] CloudOp displace(const std::shared_ptr<Crv> crv,
+                                 const glm::vec3 amount,
+                                 bool transformed = true) const;
+  [[nodiscard]] CloudOp displace(const FloatOp op,
+                                 const glm::vec3 direction) const;
+  [[nodiscard]] CloudOp transform(const glm::vec3 center,
+                                  const glm::vec3 scale,
+                                  const glm::vec3 translation,
+                                  float rotation) const;
+  [[nodiscard]] CloudOp noiseWarp(float frequency, float amplitude,
+                                  float time = 0.f,
+                                  std::uint32_t seed = 0) const;
+  [[nodiscard]] CloudOp attract(const glm::vec3 target, float strength,
+                                float radius) const;
+  [[nodiscard]] CloudOp repel(const glm::vec3 target, float strength,
+                              float radius) const;
+  [[nodiscard]] CloudOp chain(const vector<CloudOp> ops) const;
+
+  void apply(const CloudOp &op, glm::vec3 *points, std::size_t count,
+             int numThreads = 0,
+             std::size_t chunkSize = defaultChunkSize) const;
+  void apply(const CloudOp &op, vector<glm::vec3> &cloud, int numThreads = 0,
+             std::size_t chunkSize = defaultChunkSize) const;
 };
 
-}  // namespace ofxCrvs
\ No newline at end of file
+}  // namespace ofxCrvs
@@ -3,7 +3,7 @@
 #ifndef ofxCrvsConstants_h
 #define ofxCrvsConstants_h
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 
 namespace ofxCrvs {
 
@@ -0,0 +1,189 @@
+#pragma once
+
+#ifndef OFXCRVSCORE_H
+#define OFXCRVSCORE_H
+
+/**
+ * Single entry point for everything the ofxCrvs core needs from its
+ * environment: glm and the standard library, nothing else. The core builds
+ * the same way for an openFrameworks app, a CLI tool, a render farm node
+ * or a test, with no window or GL context.
+ *
+ * The scalar helpers the core uses are defined here with openFrameworks'
+ * semantics, under names of their own so they can't clash with OF's. The
+ * openFrameworks API (ofPolyline/ofVec arrays, ofMesh/ofVbo upload, plot,
+ * mouse ops) lives in the adapter, ofxCrvsOf.h.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef GLM_ENABLE_EXPERIMENTAL
+#define GLM_ENABLE_EXPERIMENTAL
+#endif
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+// openFrameworks brings std into the global namespace and the sources rely
+// on it; keep that true without OF.
+using namespace std;
+
+namespace ofxCrvs {
+
+// ofLerp()
+inline float lerpValue(float start, float stop, float amt) {
+  return start + (stop - start) * amt;
+}
+
+// ofClamp()
+inline float clampValue(float value, float min, float max) {
+  return value < min ? min : value > max ? max : value;
+}
+
+// ofMap()
+inline float mapValue(float value, float inputMin, float inputMax,
+                      float outputMin, float outputMax, bool clamp = false) {
+  if (std::fabs(inputMin - inputMax) < FLT_EPSILON)
+    return outputMin;
+  float outVal = ((value - inputMin) / (inputMax - inputMin) *
+                      (outputMax - outputMin) +
+                  outputMin);
+  if (clamp) {
+    if (outputMax < outputMin)
+      outVal = clampValue(outVal, outputMax, outputMin);
+    else
+      outVal = clampValue(outVal, outputMin, outputMax);
+  }
+  return outVal;
+}
+
+inline float degToRad(float degrees) {
+  return degrees * glm::pi<float>() / 180.f;
+}
+
+// Uniform in [0, max), from an unseeded per-thread engine like ofRandom()
+inline float randomFloat(float max) {
+  thread_local std::mt19937 engine{std::random_device{}()};
+  return std::uniform_real_distribution<float>(0.f, max)(engine);
+}
+
+/** Microseconds since the first call, standing in for time since launch. */
+inline std::uint64_t elapsedMicros() {
+  static const auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+using IndexType = std::uint32_t;
+
+/**
+ * The parts of ofBoxPrimitive that Box relies on: a size plus the
+ * position, orientation and scale of ofNode. ofxCrvsOf.h converts a Box
+ * to an ofBoxPrimitive for drawing.
+ */
+class BoxPrimitive {
+public:
+  BoxPrimitive() : BoxPrimitive(100.f, 100.f, 100.f) {}
+  BoxPrimitive(float width, float height, float depth)
+      : size(width, height, depth) {}
+  virtual ~BoxPrimitive() = default;
+
+  void set(float width, float height, float depth) {
+    size = glm::vec3(width, height, depth);
+  }
+  void set(float s) { size = glm::vec3(s); }
+  void setWidth(float width) { size.x = width; }
+  void setHeight(float height) { size.y = height; }
+  void setDepth(float depth) { size.z = depth; }
+  [[nodiscard]] float getWidth() const { return size.x; }
+  [[nodiscard]] float getHeight() const { return size.y; }
+  [[nodiscard]] float getDepth() const { return size.z; }
+  [[nodiscard]] glm::vec3 getSize() const { return size; }
+
+  void setPosition(const glm::vec3 &p) { position = p; }
+  void setPosition(float x, float y, float z) { position = {x, y, z}; }
+  void setOrientation(const glm::quat &q) { orientation = q; }
+  void setScale(const glm::vec3 &s) { scale = s; }
+  void setScale(float s) { scale = glm::vec3(s); }
+  [[nodiscard]] glm::vec3 getPosition() const { return position; }
+  [[nodiscard]] glm::quat getOrientationQuat() const { return orientation; }
+  [[nodiscard]] glm::vec3 getScale() const { return scale; }
+
+  [[nodiscard]] glm::mat4 getLocalTransformMatrix() const {
+    return glm::translate(glm::mat4(1.f), position) *
+           glm::mat4_cast(orientation) * glm::scale(glm::mat4(1.f), scale);
+  }
+
+private:
+  glm::vec3 size;
+  glm::vec3 position{0.f};
+  glm::quat orientation{1.f, 0.f, 0.f, 0.f};
+  glm::vec3 scale{1.f};
+};
+
+/**
+ * Size used for default Boxes and Ops::appWidth. Defaults to
+ * openFrameworks' default window size; set it by hand, or install a source
+ * that is asked on every read, such as the window's size, which the
+ * openFrameworks adapter does.
+ */
+using ViewSizeSource = glm::vec2 (*)();
+
+inline std::atomic<ViewSizeSource> &viewSizeSource() {
+  static std::atomic<ViewSizeSource> source{nullptr};
+  return source;
+}
+inline std::atomic<float> &viewWidth() {
+  static std::atomic<float> width{1024.f};
+  return width;
+}
+inline std::atomic<float> &viewHeight() {
+  static std::atomic<float> height{768.f};
+  return height;
+}
+
+inline float getViewWidth() {
+  const ViewSizeSource source = viewSizeSource().load();
+  return source ? source().x : viewWidth().load();
+}
+inline float getViewHeight() {
+  const ViewSizeSource source = viewSizeSource().load();
+  return source ? source().y : viewHeight().load();
+}
+inline void setViewSize(float width, float height) {
+  viewWidth().store(width);
+  viewHeight().store(height);
+}
+// nullptr goes back to the size set by setViewSize()
+inline void setViewSizeSource(ViewSizeSource source) {
+  viewSizeSource().store(source);
+}
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSCORE_H
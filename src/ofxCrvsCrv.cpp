@@ -2,26 +2,46 @@
 #include "ofxCrvsCrv.h"
 
 #include <algorithm>
+#include <queue>
 
 #include "ofxCrvsConstants.h"
 #include "ofxCrvsEdg.hpp"
+#include "ofxCrvsSpatial.h"
 #include "ofxCrvsUtils.hpp"
 
 namespace ofxCrvs {
 
-float Crv::calculate(float pos) const { return quantize(op(pos)); }
+float Crv::calculate(float pos) const {
+  OFXCRVS_PROFILE_SCOPE("op", name);
+  return quantize(op(pos));
+}
 
 float Crv::apply(float pos) const { return calculate(pos); }
 
-float Crv::ampBias(float value, float pos) const {
+float Crv::ampFactorAt(float pos) const {
   float ampFactor = ampOffset;
-  if (ampCrv)
+  if (ampCrv) {
+    OFXCRVS_PROFILE_SCOPE("amp", ampCrv->name);
     ampFactor *= ampCrv->yAt(pos) * ampModAmt;
-  ampFactor = ampFactor / 2.f;
-  value = value * ampFactor + ampFactor;
-  if (biasCrv)
-    value += biasCrv->yAt(pos) * biasModAmt;
-  return value + biasOffset;
+  }
+  return ampFactor / 2.f;
+}
+
+float Crv::biasAt(float pos) const {
+  float bias = biasOffset;
+  if (biasCrv) {
+    OFXCRVS_PROFILE_SCOPE("bias", biasCrv->name);
+    bias += biasCrv->yAt(pos) * biasModAmt;
+  }
+  return bias;
+}
+
+float Crv::ampBias(float value, float ampFactor, float bias) const {
+  return value * ampFactor + ampFactor + bias;
+}
+
+float Crv::ampBias(float value, float pos) const {
+  return ampBias(value, ampFactorAt(pos), biasAt(pos));
 }
 
 float Crv::calcPos(float pos) const {
@@ -29,10 +49,14 @@ float Crv::calcPos(float pos) const {
   pos *= rateOffset;
   if (pos > 1.f)
     pos = fmod(pos, 1.f);
-  if (rateCrv)
+  if (rateCrv) {
+    OFXCRVS_PROFILE_SCOPE("rate", rateCrv->name);
     pos *= rateCrv->yAt(pos) * rateModAmt;
-  if (phaseCrv)
+  }
+  if (phaseCrv) {
+    OFXCRVS_PROFILE_SCOPE("phase", phaseCrv->name);
     pos += phaseCrv->yAt(pos) * phaseModAmt;
+  }
   pos += phaseOffset;
   if (pos > 1.f)
     pos = fmod(pos, 1.f);
@@ -60,6 +84,30 @@ float Crv::zAt(float pos) const { return componentAt(Component::Z, pos); }
 
 float Crv::wAt(float pos) const { return componentAt(Component::W, pos); }
 
+glm::vec3 Crv::componentsAt(float pos) const {
+  return {componentAt(Component::X, pos), componentAt(Component::Y, pos),
+          componentAt(Component::Z, pos)};
+}
+
+float Crv::uComponentAt(Component component, float pos,
+                        bool transformed) const {
+  if (component == Component::W)
+    return wAt(pos);
+  const int index = static_cast<int>(component);
+  // Rotation is around Z, so X and Y depend on each other once transformed.
+  glm::vec3 v(0.f);
+  if (transformed && rotation != 0.f && component != Component::Z) {
+    v.x = xAt(pos);
+    v.y = yAt(pos);
+  } else {
+    v[index] = componentAt(component, pos);
+  }
+  if (transformed)
+    Utils::transform(v, UCENTER, scale, translation, rotation);
+  bounded(v);
+  return v[index];
+}
+
 float Crv::quantize(float y) const {
   if (quantization > 1) {
     float levelSize = 1.f / (quantization - 1);
@@ -126,17 +174,31 @@ vector<glm::vec2> Crv::glv2Array(int numPoints, bool boxed, bool transformed,
 vector<glm::vec3> Crv::glv3Array(int numPoints, bool boxed, bool transformed,
                                  FloatOp samplingRateOp) const {
   vector<glm::vec3> vectors(numPoints);
-  for (int i = 0; i < numPoints; ++i) {
-    float x = static_cast<float>(i) / (numPoints - 1);
+  sampleInto(vectors.data(), numPoints, boxed, transformed, samplingRateOp);
+  return vectors;
+}
+
+void Crv::sampleInto(glm::vec3 *out, int numPoints, bool boxed,
+                     bool transformed, FloatOp samplingRateOp) const {
+  sampleRangeInto(out, 0, std::max(numPoints, 0), std::max(numPoints, 0),
+                  boxed, transformed, samplingRateOp);
+}
+
+void Crv::sampleRangeInto(glm::vec3 *out, std::uint64_t first,
+                          std::size_t count, std::uint64_t numPoints,
+                          bool boxed, bool transformed,
+                          FloatOp samplingRateOp) const {
+  // Double, so indices past 2^24 still land on their own positions
+  const double step = 1.0 / (static_cast<double>(numPoints) - 1.0);
+  for (std::size_t i = 0; i < count; ++i) {
+    float x = static_cast<float>((first + i) * step);
     if (samplingRateOp)
       x = samplingRateOp(x);
     if (boxed)
-      vectors[i] = wVector(x, transformed);
+      out[i] = wVector(x, transformed);
     else
-      vectors[i] = uVector(x, transformed);
-    ;
+      out[i] = uVector(x, transformed);
   }
-  return vectors;
 }
 
 vector<vector<float>> Crv::f2dArray(int numPoints, bool boxed, bool transformed,
@@ -164,54 +226,172 @@ vector<vector<float>> Crv::f3dArray(int numPoints, bool boxed, bool transformed,
   return points;
 }
 
-vector<ofVec3f> Crv::ofv3Array(int numPoints, bool boxed, bool transformed,
-                               FloatOp samplingRateOp) const {
-  vector<ofVec3f> vectors(numPoints);
-  for (int i = 0; i < numPoints; ++i) {
-    float x = static_cast<float>(i) / (numPoints - 1);
-    if (samplingRateOp)
-      x = samplingRateOp(x);
-    glm::vec3 v;
-    if (boxed)
-      v = wVector(x, transformed);
-    else
-      v = uVector(x, transformed);
-    vectors[i] = ofVec3f(v.x, v.y, v.z);
+vector<float> Crv::arcLengthKey(bool boxed, bool transformed) const {
+  vector<float> key = {static_cast<float>(boxed),
+                       static_cast<float>(transformed),
+                       static_cast<float>(resolution),
+                       static_cast<float>(quantization),
+                       static_cast<float>(bounding),
+                       ampOffset,
+                       rateOffset,
+                       phaseOffset,
+                       biasOffset,
+                       ampModAmt,
+                       rateModAmt,
+                       phaseModAmt,
+                       biasModAmt,
+                       translation.x,
+                       translation.y,
+                       translation.z,
+                       scale.x,
+                       scale.y,
+                       scale.z,
+                       rotation};
+  if (boxed) {
+    key.insert(key.end(), {box.getWidth(), box.getHeight(), box.getDepth()});
+    const glm::mat4 m = box.getLocalTransformMatrix();
+    for (int i = 0; i < 4; ++i) {
+      key.insert(key.end(), {m[i].x, m[i].y, m[i].z, m[i].w});
+    }
   }
-  return vectors;
+  return key;
 }
 
-vector<ofVec2f> Crv::ofv2Array(int numPoints, bool boxed, bool transformed,
-                               FloatOp samplingRateOp) const {
-  vector<ofVec2f> vectors(numPoints);
-  for (int i = 0; i < numPoints; ++i) {
-    float x = static_cast<float>(i) / (numPoints - 1);
-    if (samplingRateOp)
-      x = samplingRateOp(x);
-    glm::vec3 v;
-    if (boxed)
-      v = wVector(x, transformed);
-    else
-      v = uVector(x, transformed);
-    vectors[i] = ofVec2f(v.x, v.y);
+std::shared_ptr<const ArcLength> Crv::arcLength(bool boxed,
+                                                bool transformed) const {
+  vector<float> key = arcLengthKey(boxed, transformed);
+  auto sample = [&] {
+    return glv3Array(std::max(resolution, 2) + 1, boxed, transformed);
+  };
+  if (!cacheArcLength)
+    return std::make_shared<const ArcLength>(sample(), std::move(key));
+  std::shared_ptr<const ArcLength> &slot =
+      arcLengthCache.slots[(boxed ? 2 : 0) + (transformed ? 1 : 0)];
+  auto cached = std::atomic_load(&slot);
+  if (cached && cached->getKey() == key)
+    return cached;
+  auto table = std::make_shared<const ArcLength>(sample(), std::move(key));
+  std::atomic_store(&slot, table);
+  return table;
+}
+
+std::shared_ptr<Crv> Crv::deepCopy() const {
+  auto copy = std::make_shared<Crv>(*this);
+  for (std::shared_ptr<Crv> *mod :
+       {&copy->ampCrv, &copy->rateCrv, &copy->phaseCrv, &copy->biasCrv}) {
+    if (*mod)
+      *mod = (*mod)->deepCopy();
   }
-  return vectors;
+  return copy;
 }
 
-ofPolyline Crv::polyline(int numPoints, bool boxed, bool transformed,
-                         FloatOp samplingRateOp) const {
-  vector<glm::vec3> vectors =
-      glv3Array(numPoints, boxed, transformed, std::move(samplingRateOp));
-  ofPolyline polyline;
-  polyline.addVertices(vectors);
-  return polyline;
+void Crv::ArcLengthCache::clear() {
+  for (std::shared_ptr<const ArcLength> &slot : slots)
+    std::atomic_store(&slot, std::shared_ptr<const ArcLength>());
+}
+
+void Crv::invalidateArcLength() { arcLengthCache.clear(); }
+
+FloatOp Crv::arcLengthOp(bool boxed, bool transformed) const {
+  std::shared_ptr<const ArcLength> table = arcLength(boxed, transformed);
+  return [table](const float pos) { return table->posAt(pos); };
+}
+
+vector<glm::vec3> Crv::resample(int numPoints, bool boxed,
+                                bool transformed) const {
+  return glv3Array(numPoints, boxed, transformed,
+                   arcLengthOp(boxed, transformed));
+}
+
+namespace {
+
+float distanceToChord(const glm::vec3 &p, const glm::vec3 &a,
+                      const glm::vec3 &b) {
+  const glm::vec3 ab = b - a;
+  const float lengthSq = glm::dot(ab, ab);
+  if (lengthSq == 0.f)
+    return glm::distance(p, a);
+  const float t = clampValue(glm::dot(p - a, ab) / lengthSq, 0.f, 1.f);
+  return glm::distance(p, a + ab * t);
+}
+
+} // namespace
+
+vector<glm::vec3> Crv::adaptiveArray(float tolerance, bool boxed,
+                                     bool transformed, int maxDepth,
+                                     int maxVertices) const {
+  // A few uniform segments to start with, so features narrower than half
+  // the curve can't hide behind a flat-looking midpoint. Depth counts
+  // halvings of the whole curve, so the start is already depth 3, less if
+  // maxDepth or maxVertices don't allow 9 vertices.
+  maxDepth = std::max(maxDepth, 0);
+  if (maxVertices > 0)
+    maxVertices = std::max(maxVertices, 2);
+  int initialDepth = std::min(3, maxDepth);
+  while (initialDepth > 0 && maxVertices > 0 &&
+         (1 << initialDepth) + 1 > maxVertices)
+    --initialDepth;
+  const int initialSegments = 1 << initialDepth;
+
+  struct Segment {
+    float a, b;
+    glm::vec3 pa, pb, pm;
+    float error;
+    int depth;
+    bool operator<(const Segment &other) const { return error < other.error; }
+  };
+
+  auto pointAt = [&](float pos) {
+    return boxed ? wVector(pos, transformed) : uVector(pos, transformed);
+  };
+  auto makeSegment = [&](float a, float b, const glm::vec3 &pa,
+                         const glm::vec3 &pb, int depth) {
+    const glm::vec3 pm = pointAt((a + b) * 0.5f);
+    return Segment{a, b, pa, pb, pm, distanceToChord(pm, pa, pb), depth};
+  };
+
+  vector<std::pair<float, glm::vec3>> vertices;
+  std::priority_queue<Segment> segments;
+  glm::vec3 prev = pointAt(0.f);
+  vertices.emplace_back(0.f, prev);
+  for (int i = 1; i <= initialSegments; ++i) {
+    const float pos = static_cast<float>(i) / initialSegments;
+    const glm::vec3 p = pointAt(pos);
+    vertices.emplace_back(pos, p);
+    if (initialDepth < maxDepth)
+      segments.push(
+          makeSegment(vertices[i - 1].first, pos, prev, p, initialDepth));
+    prev = p;
+  }
+
+  // Always refine the worst segment first so a vertex budget is spent where
+  // the chord error is largest.
+  while (!segments.empty()) {
+    const Segment s = segments.top();
+    if (s.error <= tolerance)
+      break;
+    if (maxVertices > 0 && static_cast<int>(vertices.size()) >= maxVertices)
+      break;
+    segments.pop();
+    const float m = (s.a + s.b) * 0.5f;
+    vertices.emplace_back(m, s.pm);
+    if (s.depth + 1 < maxDepth) {
+      segments.push(makeSegment(s.a, m, s.pa, s.pm, s.depth + 1));
+      segments.push(makeSegment(m, s.b, s.pm, s.pb, s.depth + 1));
+    }
+  }
+
+  std::sort(vertices.begin(), vertices.end(),
+            [](const auto &l, const auto &r) { return l.first < r.first; });
+  vector<glm::vec3> points(vertices.size());
+  for (std::size_t i = 0; i < vertices.size(); ++i) {
+    points[i] = vertices[i].second;
+  }
+  return points;
 }
 
 glm::vec3 Crv::uVector(float pos, bool transformed) const {
-  float x = xAt(pos);
-  float y = yAt(pos);
-  float z = zAt(pos);
-  glm::vec3 v = glm::vec3(x, y, z);
+  glm::vec3 v = componentsAt(pos);
   if (transformed)
     Utils::transform(v, UCENTER, scale, translation, rotation);
   bounded(v);
@@ -227,8 +407,8 @@ glm::vec3 Crv::wVector(float pos, bool transformed) const {
 void Crv::bounded(glm::vec3 &v) const {
   switch (bounding) {
   case Bounding::CLIPPING:
-    glm::vec3(ofClamp(v.x, 0.f, 1.f), ofClamp(v.y, 0.f, 1.f),
-              ofClamp(v.z, 0.f, 1.f));
+    glm::vec3(clampValue(v.x, 0.f, 1.f), clampValue(v.y, 0.f, 1.f),
+              clampValue(v.z, 0.f, 1.f));
     break;
   case Bounding::WRAPPING:
     wrapped(v);
@@ -273,4 +453,64 @@ vector<Edg> Crv::getWebEdgs(int numPoints, bool boxed, bool transformed) const {
   return getWebEdgs(numPoints, boxed, transformed, resolution);
 }
 
+vector<Edg> Crv::getWebEdgs(int numPoints, bool boxed, bool transformed,
+                            int resolution, float maxDistance) const {
+  vector<glm::vec3> vectors = glv3Array(numPoints, boxed, transformed);
+  HashGrid grid(vectors, maxDistance);
+  vector<Edg> edgs;
+  vector<std::size_t> neighbors;
+  for (std::size_t i = 0; i < vectors.size(); ++i) {
+    grid.radius(vectors[i], maxDistance, neighbors);
+    for (const std::size_t j : neighbors) {
+      if (i != j) {
+        edgs.push_back(Edg(vectors[i], vectors[j], resolution));
+      }
+    }
+  }
+  return edgs;
+}
+
+std::size_t Crv::webLinesInto(glm::vec3 *out, std::size_t capacity,
+                              int numPoints, bool boxed,
+                              bool transformed) const {
+  // Reused across calls so steady-state frames don't allocate
+  thread_local vector<glm::vec3> vectors;
+  vectors.resize(std::max(numPoints, 0));
+  sampleInto(vectors.data(), numPoints, boxed, transformed);
+  std::size_t count = 0;
+  for (int i = 0; i < numPoints; ++i) {
+    for (int j = i + 1; j < numPoints; ++j) {
+      if (count + 2 > capacity)
+        return count;
+      out[count++] = vectors[i];
+      out[count++] = vectors[j];
+    }
+  }
+  return count;
+}
+
+std::size_t Crv::webLinesInto(glm::vec3 *out, std::size_t capacity,
+                              int numPoints, bool boxed, bool transformed,
+                              float maxDistance) const {
+  thread_local vector<glm::vec3> vectors;
+  thread_local HashGrid grid;
+  thread_local vector<std::size_t> neighbors;
+  vectors.resize(std::max(numPoints, 0));
+  sampleInto(vectors.data(), numPoints, boxed, transformed);
+  grid.build(vectors, maxDistance);
+  std::size_t count = 0;
+  for (int i = 0; i < numPoints; ++i) {
+    grid.radius(vectors[i], maxDistance, neighbors);
+    for (const std::size_t j : neighbors) {
+      if (j <= static_cast<std::size_t>(i))
+        continue;
+      if (count + 2 > capacity)
+        return count;
+      out[count++] = vectors[i];
+      out[count++] = vectors[j];
+    }
+  }
+  return count;
+}
+
 } // namespace ofxCrvs
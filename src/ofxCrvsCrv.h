@@ -1,9 +1,11 @@
 
 #pragma once
 
+#include "ofxCrvsArcLength.h"
 #include "ofxCrvsBox.hpp"
 #include "ofxCrvsEdg.hpp"
 #include "ofxCrvsOps.h"
+#include "ofxCrvsProfiler.h"
 
 namespace ofxCrvs {
 class Edg;
@@ -65,6 +67,12 @@ public:
 
   Bounding bounding;
 
+  // Shown in profiler frames; see Profiler
+  std::string name;
+
+  // False rebuilds the arc-length table on every arcLength() call
+  bool cacheArcLength = true;
+
   static std::shared_ptr<Crv> create() { return std::make_shared<Crv>(); }
 
   static std::shared_ptr<Crv> create(FloatOp op) {
@@ -105,12 +113,12 @@ public:
 
   Crv(FloatOp op, std::shared_ptr<Crv> ampCrv, std::shared_ptr<Crv> rateCrv,
       std::shared_ptr<Crv> phaseCrv, std::shared_ptr<Crv> biasCrv)
-      : Crv(Box(ofGetWidth(), ofGetHeight(), 0.f), op, ampCrv, rateCrv,
+      : Crv(Box(getViewWidth(), getViewHeight(), 0.f), op, ampCrv, rateCrv,
             phaseCrv, biasCrv, 1.0f, 1.0f, 0.0f, 0.0f) {}
 
   Crv(FloatOp op, float ampOffset, float rateOffset, float phaseOffset,
       float biasOffset)
-      : Crv(Box(ofGetWidth(), ofGetHeight(), 0.f), op, nullptr, nullptr,
+      : Crv(Box(getViewWidth(), getViewHeight(), 0.f), op, nullptr, nullptr,
             nullptr, nullptr, ampOffset, rateOffset, phaseOffset, biasOffset) {}
 
   Crv(Box box, FloatOp op, std::shared_ptr<Crv> ampCrv,
@@ -132,11 +140,19 @@ public:
 
   virtual ~Crv() = default;
 
+  // Copies this curve and, recursively, its modulators, so stateful ops
+  // (ema, lpFb, sineFb, ...) in the copy keep their own state. Ops that
+  // share state through a shared_ptr, like filter(), stay shared. A
+  // subclass is copied as a plain Crv.
+  [[nodiscard]] std::shared_ptr<Crv> deepCopy() const;
+
   float apply(float pos) const;
   float xAt(float pos) const;
   float yAt(float pos) const;
   float zAt(float pos) const;
   float wAt(float pos) const;
+  virtual glm::vec3 componentsAt(float pos) const;
+  float uComponentAt(Component component, float pos, bool transformed) const;
   float bipolarize(float unipolar) const;
   float wrap(float value, float min, float max) const;
   float fold(float value, float min, float max) const;
@@ -154,12 +170,33 @@ public:
                                    FloatOp samplingRateOp = FloatOp()) const;
   std::vector<glm::vec3> glv3Array(int numPoints, bool boxed, bool transformed,
                                    FloatOp samplingRateOp = FloatOp()) const;
-  std::vector<ofVec3f> ofv3Array(int numPoints, bool boxed, bool transformed,
-                                 FloatOp samplingRateOp = FloatOp()) const;
-  std::vector<ofVec2f> ofv2Array(int numPoints, bool boxed, bool transformed,
-                                 FloatOp samplingRateOp = FloatOp()) const;
-  ofPolyline polyline(int numPoints, bool boxed, bool transformed,
-                      FloatOp samplingRateOp = FloatOp()) const;
+  // glv3Array() written straight into out, e.g. a mapped vertex buffer;
+  // out needs room for numPoints vertices
+  void sampleInto(glm::vec3 *out, int numPoints, bool boxed, bool transformed,
+                  FloatOp samplingRateOp = FloatOp()) const;
+  // Points first to first + count - 1 of a numPoints sampleInto(), so a long
+  // render can be produced a chunk at a time
+  void sampleRangeInto(glm::vec3 *out, std::uint64_t first, std::size_t count,
+                       std::uint64_t numPoints, bool boxed, bool transformed,
+                       FloatOp samplingRateOp = FloatOp()) const;
+  // Points placed where the chord error exceeds tolerance. No segment is
+  // shorter than 1 / 2^maxDepth of the curve, so maxDepth 0 gives just the
+  // end points; maxVertices > 0 caps the count, and is at least 2.
+  std::vector<glm::vec3> adaptiveArray(float tolerance, bool boxed,
+                                       bool transformed, int maxDepth = 16,
+                                       int maxVertices = 0) const;
+
+  // Cached per (boxed, transformed) pair and rebuilt when a setting it
+  // depends on changes. op and the modulator curves can't be compared, so
+  // whoever replaces them, or anything they read, must call
+  // invalidateArcLength(); set cacheArcLength to false instead when they
+  // change on their own, e.g. ops driven by timePhasor().
+  std::shared_ptr<const ArcLength> arcLength(bool boxed,
+                                             bool transformed) const;
+  void invalidateArcLength();
+  FloatOp arcLengthOp(bool boxed, bool transformed) const;
+  std::vector<glm::vec3> resample(int numPoints, bool boxed,
+                                  bool transformed) const;
 
   glm::vec3 uVector(float pos, bool transformed) const;
   glm::vec3 wVector(float pos, bool transformed) const;
@@ -173,12 +210,56 @@ public:
                               int resolution) const;
   std::vector<Edg> getWebEdgs(int numPoints, bool boxed,
                               bool transformed) const;
+  std::vector<Edg> getWebEdgs(int numPoints, bool boxed, bool transformed,
+                              int resolution, float maxDistance) const;
+  // The web as a GL_LINES vertex list written into out: two vertices per
+  // edge, each pair of points once (getWebEdgs() has both directions).
+  // Writes at most capacity vertices and returns how many it wrote;
+  // webLinesCapacity() covers every pair.
+  std::size_t webLinesInto(glm::vec3 *out, std::size_t capacity,
+                           int numPoints, bool boxed, bool transformed) const;
+  std::size_t webLinesInto(glm::vec3 *out, std::size_t capacity,
+                           int numPoints, bool boxed, bool transformed,
+                           float maxDistance) const;
+  static std::size_t webLinesCapacity(int numPoints) {
+    return numPoints > 1
+               ? static_cast<std::size_t>(numPoints) * (numPoints - 1)
+               : 0;
+  };
 
 protected:
   float calculate(float pos) const;
   float ampBias(float value, float pos) const;
+  float ampBias(float value, float ampFactor, float bias) const;
+  float ampFactorAt(float pos) const;
+  float biasAt(float pos) const;
   float calcPos(float pos) const;
   virtual float componentAt(Component component, float pos) const;
   float quantize(float y) const;
+  // Y of an axis curve, timed under role when profiling
+  static float axisAt([[maybe_unused]] const char *role, const Crv &crv,
+                      float pos) {
+    OFXCRVS_PROFILE_SCOPE(role, crv.name);
+    return crv.uComponentAt(Component::Y, pos, true);
+  };
+  std::vector<float> arcLengthKey(bool boxed, bool transformed) const;
+
+
+private:
+  // One table per (boxed, transformed) pair, each rebuilt whenever its
+  // arcLengthKey() changes. A copied or assigned Crv starts empty, since
+  // its op may be swapped without the original's tables going stale.
+  struct ArcLengthCache {
+    ArcLengthCache() = default;
+    ArcLengthCache(const ArcLengthCache &) {}
+    ArcLengthCache &operator=(const ArcLengthCache &) {
+      clear();
+      return *this;
+    };
+    void clear();
+
+    std::array<std::shared_ptr<const ArcLength>, 4> slots;
+  };
+  mutable ArcLengthCache arcLengthCache;
 };
 } // namespace ofxCrvs
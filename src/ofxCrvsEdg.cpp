@@ -16,8 +16,8 @@ float Edg::length() const { return glm::distance(source, target); }
 
 glm::vec3 Edg::at(float pos) const {
   glm::vec3 point;
-  point.x = ofMap(pos, 0, 1, source.x, target.x);
-  point.y = ofMap(pos, 0, 1, source.y, target.y);
+  point.x = mapValue(pos, 0, 1, source.x, target.x);
+  point.y = mapValue(pos, 0, 1, source.y, target.y);
   point.z = 0.f;
 
   return point;
@@ -69,14 +69,17 @@ glm::vec3 Edg::getPerpendicularPoint(glm::vec3 point, float magnitude) const {
 }
 
 std::vector<glm::vec3> Edg::getCrvPoints(Crv crv, int resolution) const {
-  std::vector<glm::vec3> edgPoints = points(resolution);
-  std::vector<glm::vec3> crvPoints;
+  std::vector<glm::vec3> crvPoints(std::max(resolution, 0));
+  crvPointsInto(crv, resolution, crvPoints.data());
+  return crvPoints;
+}
+
+void Edg::crvPointsInto(const Crv &crv, int resolution, glm::vec3 *out) const {
   for (int i = 0; i < resolution; ++i) {
     float x = (float)i / (float)(resolution - 1.f);
     float mag = crv.yAt(x);
-    crvPoints.push_back(getPerpendicularPoint(edgPoints[i], mag));
+    out[i] = getPerpendicularPoint(at((float)i / (float)resolution), mag);
   }
-  return crvPoints;
 }
 
 std::vector<glm::vec3> Edg::getCrvPoints(Crv crv) const {
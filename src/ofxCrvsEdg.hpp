@@ -10,7 +10,7 @@
 #ifndef ofxCrvsEdg_hpp
 #define ofxCrvsEdg_hpp
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 
 namespace ofxCrvs {
 
@@ -54,6 +54,9 @@ class Edg {
   glm::vec3 getPerpendicularPoint(glm::vec3 point, float magnitude) const;
   std::vector<glm::vec3> getCrvPoints(Crv crv, int resolution) const;
   std::vector<glm::vec3> getCrvPoints(Crv crv) const;
+  // getCrvPoints() written straight into out, which needs room for
+  // resolution vertices
+  void crvPointsInto(const Crv &crv, int resolution, glm::vec3 *out) const;
   glm::vec3 asVector() const;
 };
 
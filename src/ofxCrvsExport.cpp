@@ -0,0 +1,287 @@
+#include "ofxCrvsExport.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "ofxCrvsSimplify.h"
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+namespace ofxCrvs {
+
+namespace {
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Same as Crv::wrap() and Crv::fold(), over any range
+float wrap(const float value, const float min, const float max) {
+  const float range = max - min;
+  float wrapped = std::fmod(value - min, range);
+  if (wrapped < 0.f)
+    wrapped += range;
+  else if (wrapped == 0.f && value == max)
+    wrapped = range;
+  return wrapped + min;
+}
+
+float fold(const float value, const float min, const float max) {
+  const float range = max - min;
+  float folded = std::fmod(value - min, 2 * range);
+  if (folded < 0.f)
+    folded += 2 * range;
+  return max - std::abs(folded - range);
+}
+
+} // namespace
+
+void TransformStage::process(ExportChunk &chunk) {
+  for (glm::vec3 &p : chunk.points)
+    p = glm::vec3(matrix * glm::vec4(p, 1.f));
+}
+
+void BoundingStage::process(ExportChunk &chunk) {
+  for (glm::vec3 &p : chunk.points) {
+    for (int c = 0; c < 3; ++c) {
+      switch (bounding) {
+      case Bounding::CLIPPING:
+        p[c] = std::clamp(p[c], min[c], max[c]);
+        break;
+      case Bounding::WRAPPING:
+        p[c] = wrap(p[c], min[c], max[c]);
+        break;
+      case Bounding::FOLDING:
+        p[c] = fold(p[c], min[c], max[c]);
+        break;
+      default:
+        break;
+      }
+    }
+  }
+}
+
+void SimplifyStage::process(ExportChunk &chunk) {
+  if (chunk.first == 0)
+    hasCarry = false;
+  if (chunk.points.empty())
+    return;
+  window.clear();
+  if (hasCarry)
+    window.push_back(carry);
+  window.insert(window.end(), chunk.points.begin(), chunk.points.end());
+  carry = window.back();
+  const vector<std::size_t> kept =
+      method == Method::RDP ? Simplify::rdpIndices(window, tolerance)
+                            : Simplify::visvalingamIndices(window, tolerance);
+  chunk.points.clear();
+  for (const std::size_t index : kept) {
+    // The carried point was written with the previous chunk
+    if (!(hasCarry && index == 0))
+      chunk.points.push_back(window[index]);
+  }
+  hasCarry = true;
+}
+
+FileSink::FileSink(std::FILE *file, const bool pipe, const Format format,
+                   std::string name)
+    : file(file), pipe(pipe), format(format), name(std::move(name)) {}
+
+std::unique_ptr<FileSink> FileSink::toFile(const std::string &path,
+                                           const Format format) {
+  std::FILE *file = std::fopen(
+      path.c_str(), format == Format::BINARY ? "wb" : "w");
+  if (!file)
+    throw std::runtime_error("FileSink: can't write " + path);
+  return std::unique_ptr<FileSink>(new FileSink(file, false, format, path));
+}
+
+std::unique_ptr<FileSink> FileSink::toPipe(const std::string &command,
+                                           const Format format) {
+  std::FILE *file =
+      popen(command.c_str(), format == Format::BINARY ? "wb" : "w");
+  if (!file)
+    throw std::runtime_error("FileSink: can't run " + command);
+  return std::unique_ptr<FileSink>(new FileSink(file, true, format, command));
+}
+
+FileSink::~FileSink() {
+  try {
+    close();
+  } catch (...) {
+  }
+}
+
+void FileSink::put(const char *bytes, const std::size_t size) {
+  if (std::fwrite(bytes, 1, size, file) != size)
+    throw std::runtime_error("FileSink: can't write " + name);
+  bytesWritten += size;
+}
+
+void FileSink::write(const ExportChunk &chunk) {
+  if (!file)
+    throw std::runtime_error("FileSink: " + name + " is closed");
+  if (format == Format::BINARY) {
+    put(reinterpret_cast<const char *>(chunk.points.data()),
+        chunk.points.size() * sizeof(glm::vec3));
+    return;
+  }
+  // Formats the chunk into one string, then writes it in one go
+  text.clear();
+  char line[96];
+  for (std::size_t i = 0; i < chunk.points.size(); ++i) {
+    const glm::vec3 &p = chunk.points[i];
+    int length;
+    if (format == Format::CSV) {
+      length = std::snprintf(line, sizeof(line), "%.7g,%.7g,%.7g\n", p.x, p.y,
+                             p.z);
+    } else {
+      const bool start = chunk.first == 0 && i == 0;
+      if (start)
+        text += "G90\n";
+      length = std::snprintf(line, sizeof(line), "%s X%.4f Y%.4f Z%.4f\n",
+                             start ? "G0" : "G1", p.x, p.y, p.z);
+    }
+    text.append(line, std::min<std::size_t>(length, sizeof(line) - 1));
+  }
+  put(text.data(), text.size());
+}
+
+void FileSink::close() {
+  if (!file)
+    return;
+  const int status = pipe ? pclose(file) : std::fclose(file);
+  file = nullptr;
+  if (status != 0)
+    throw std::runtime_error(pipe ? "FileSink: " + name + " failed, status " +
+                                        std::to_string(status)
+                                  : "FileSink: can't write " + name);
+}
+
+void FileSink::finish() {
+  if (file && std::fflush(file) != 0)
+    throw std::runtime_error("FileSink: can't write " + name);
+  close();
+}
+
+ExportPipeline::ExportPipeline(std::shared_ptr<const Crv> crv,
+                               const std::uint64_t numPoints,
+                               const bool boxed, const bool transformed,
+                               const std::size_t chunkSize)
+    : crv(std::move(crv)), numPoints(numPoints), boxed(boxed),
+      transformed(transformed), chunkSize(chunkSize) {
+  if (!this->crv)
+    throw std::invalid_argument("ExportPipeline: null Crv");
+  if (chunkSize == 0)
+    throw std::invalid_argument("ExportPipeline: chunkSize must be positive");
+}
+
+ExportPipeline &ExportPipeline::add(std::unique_ptr<ExportStage> stage) {
+  if (!stage)
+    throw std::invalid_argument("ExportPipeline: null stage");
+  stages.push_back(std::move(stage));
+  return *this;
+}
+
+ExportStats ExportPipeline::run(ExportSink &sink) {
+  ExportStats stats;
+  const SteadyClock::time_point start = SteadyClock::now();
+
+  std::array<ExportChunk, 2> chunks;
+  for (ExportChunk &chunk : chunks)
+    chunk.points.reserve(std::min<std::uint64_t>(chunkSize, numPoints));
+  // Filled and waiting for the sink, per buffer
+  std::array<bool, 2> pending = {false, false};
+  bool sampling = true;
+  std::exception_ptr sinkError;
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  std::thread writer([&] {
+    for (std::size_t index = 0;; index = 1 - index) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        const SteadyClock::time_point waitStart = SteadyClock::now();
+        changed.wait(lock, [&] { return pending[index] || !sampling; });
+        stats.sinkWaiting += SteadyClock::now() - waitStart;
+        if (!pending[index])
+          return;
+      }
+      std::exception_ptr error;
+      try {
+        sink.write(chunks[index]);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending[index] = false;
+        if (error)
+          sinkError = error;
+      }
+      changed.notify_all();
+      if (error)
+        return;
+    }
+  });
+
+  std::exception_ptr samplerError;
+  try {
+    std::size_t index = 0;
+    for (std::uint64_t first = 0; first < numPoints;
+         first += chunkSize, index = 1 - index) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        const SteadyClock::time_point waitStart = SteadyClock::now();
+        changed.wait(lock, [&] { return !pending[index] || sinkError; });
+        stats.samplerWaiting += SteadyClock::now() - waitStart;
+        if (sinkError)
+          break;
+      }
+      ExportChunk &chunk = chunks[index];
+      const std::size_t count =
+          static_cast<std::size_t>(std::min<std::uint64_t>(
+              chunkSize, numPoints - first));
+      chunk.points.resize(count);
+      crv->sampleRangeInto(chunk.points.data(), first, count, numPoints,
+                           boxed, transformed);
+      chunk.first = first;
+      chunk.last = first + count == numPoints;
+      stats.pointsSampled += count;
+      for (const auto &stage : stages)
+        stage->process(chunk);
+      stats.pointsWritten += chunk.points.size();
+      stats.chunks++;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending[index] = true;
+      }
+      changed.notify_all();
+    }
+  } catch (...) {
+    samplerError = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    sampling = false;
+  }
+  changed.notify_all();
+  writer.join();
+
+  if (samplerError)
+    std::rethrow_exception(samplerError);
+  if (sinkError)
+    std::rethrow_exception(sinkError);
+  sink.finish();
+  stats.elapsed = SteadyClock::now() - start;
+  return stats;
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,186 @@
+#pragma once
+
+#ifndef OFXCRVSEXPORT_H
+#define OFXCRVSEXPORT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsCrv.h"
+
+namespace ofxCrvs {
+
+// A run of consecutive points from a streamed render
+struct ExportChunk {
+  vector<glm::vec3> points;
+  // Index of the chunk's first sample in the whole render
+  std::uint64_t first = 0;
+  bool last = false;
+};
+
+/**
+ * One step of an ExportPipeline. process() sees every chunk in order and
+ * rewrites its points in place; it may drop points but should not grow a
+ * chunk much, since chunk memory is what bounds the pipeline. A chunk with
+ * first == 0 starts a new run.
+ */
+class ExportStage {
+public:
+  virtual ~ExportStage() = default;
+  virtual void process(ExportChunk &chunk) = 0;
+};
+
+// Applies a matrix, e.g. from curve space to plotter units
+class TransformStage : public ExportStage {
+public:
+  explicit TransformStage(const glm::mat4 &matrix) : matrix(matrix) {}
+  void process(ExportChunk &chunk) override;
+
+private:
+  glm::mat4 matrix;
+};
+
+// Keeps points inside [min, max] the way Crv's Bounding modes keep them
+// inside [0, 1]
+class BoundingStage : public ExportStage {
+public:
+  BoundingStage(Bounding bounding, const glm::vec3 &min, const glm::vec3 &max)
+      : bounding(bounding), min(min), max(max) {}
+  void process(ExportChunk &chunk) override;
+
+private:
+  Bounding bounding;
+  glm::vec3 min;
+  glm::vec3 max;
+};
+
+/**
+ * Simplify applied chunk by chunk. Each chunk is simplified together with
+ * the last point of the one before, so the output stays connected; every
+ * chunk's last point is kept, so the result has at most one more vertex
+ * per chunk than simplifying the whole render at once.
+ */
+class SimplifyStage : public ExportStage {
+public:
+  enum class Method { RDP, VISVALINGAM };
+
+  // tolerance is the distance for RDP, the area for VISVALINGAM
+  explicit SimplifyStage(float tolerance, Method method = Method::RDP)
+      : tolerance(tolerance), method(method) {}
+  void process(ExportChunk &chunk) override;
+
+private:
+  float tolerance;
+  Method method;
+  vector<glm::vec3> window;
+  bool hasCarry = false;
+  glm::vec3 carry{0.f};
+};
+
+// Where an ExportPipeline's chunks end up
+class ExportSink {
+public:
+  virtual ~ExportSink() = default;
+  virtual void write(const ExportChunk &chunk) = 0;
+  // After the last chunk has been written
+  virtual void finish() {}
+};
+
+/**
+ * Writes points to a file, or to the standard input of a command for
+ * devices driven by their own tools. CSV is one "x,y,z" line per point,
+ * BINARY is packed float32 x, y, z in native byte order, and GCODE is
+ * absolute moves, rapid to the first point and linear after it.
+ */
+class FileSink : public ExportSink {
+public:
+  enum class Format { CSV, BINARY, GCODE };
+
+  [[nodiscard]] static std::unique_ptr<FileSink>
+  toFile(const std::string &path, Format format = Format::CSV);
+  [[nodiscard]] static std::unique_ptr<FileSink>
+  toPipe(const std::string &command, Format format = Format::CSV);
+  ~FileSink() override;
+
+  FileSink(const FileSink &) = delete;
+  FileSink &operator=(const FileSink &) = delete;
+
+  void write(const ExportChunk &chunk) override;
+  // Flushes and closes; throws if a piped command failed
+  void finish() override;
+
+  [[nodiscard]] std::uint64_t getBytesWritten() const {
+    return bytesWritten;
+  };
+
+private:
+  FileSink(std::FILE *file, bool pipe, Format format, std::string name);
+  void put(const char *bytes, std::size_t size);
+  void close();
+
+  std::FILE *file;
+  bool pipe;
+  Format format;
+  std::string name;
+  std::string text;
+  std::uint64_t bytesWritten = 0;
+};
+
+struct ExportStats {
+  std::uint64_t pointsSampled = 0;
+  std::uint64_t pointsWritten = 0;
+  std::uint64_t chunks = 0;
+  std::chrono::nanoseconds elapsed{0};
+  // Time the sampler waited on the sink and the sink on the sampler; the
+  // larger one shows which side limits the export
+  std::chrono::nanoseconds samplerWaiting{0};
+  std::chrono::nanoseconds sinkWaiting{0};
+};
+
+/**
+ * Renders numPoints points of a Crv, as glv3Array() would, without ever
+ * holding them all. The calling thread samples chunkSize points at a time
+ * and runs them through the stages in order; a writer thread hands each
+ * finished chunk to the sink. Two chunk buffers alternate, so chunk N+1 is
+ * computed while chunk N is written, and memory stays at two chunks
+ * whatever the length of the render:
+ *
+ *   auto sink = FileSink::toFile("plot.gcode", FileSink::Format::GCODE);
+ *   ExportPipeline(crv, 100000000, true, true)
+ *       .add(std::make_unique<SimplifyStage>(0.05f))
+ *       .run(*sink);
+ *
+ * An exception from the sampler, a stage or the sink stops the export and
+ * is rethrown from run().
+ */
+class ExportPipeline {
+public:
+  static constexpr std::size_t defaultChunkSize = 65536;
+
+  ExportPipeline(std::shared_ptr<const Crv> crv, std::uint64_t numPoints,
+                 bool boxed = false, bool transformed = true,
+                 std::size_t chunkSize = defaultChunkSize);
+
+  // Appends a stage; returns *this for chaining
+  ExportPipeline &add(std::unique_ptr<ExportStage> stage);
+
+  // Streams the whole render into sink, then calls sink.finish()
+  ExportStats run(ExportSink &sink);
+
+private:
+  std::shared_ptr<const Crv> crv;
+  std::uint64_t numPoints;
+  bool boxed;
+  bool transformed;
+  std::size_t chunkSize;
+  vector<std::unique_ptr<ExportStage>> stages;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSEXPORT_H
@@ -0,0 +1,149 @@
+#include "ofxCrvsFilter.h"
+
+#include <cmath>
+
+namespace ofxCrvs {
+
+Boxcar::Boxcar(const int windowSize)
+    : history(static_cast<std::size_t>(std::max(windowSize, 1))) {}
+
+void Boxcar::reset() {
+  std::fill(history.begin(), history.end(), 0.f);
+  next = 0;
+  sum = 0.0;
+  primed = false;
+}
+
+void Boxcar::process(const float *in, float *out, const std::size_t count) {
+  if (count == 0)
+    return;
+  if (!primed) {
+    std::fill(history.begin(), history.end(), in[0]);
+    sum = static_cast<double>(in[0]) * history.size();
+    primed = true;
+  }
+  const std::size_t size = history.size();
+  const double scale = 1.0 / size;
+  for (std::size_t i = 0; i < count; ++i) {
+    const float input = in[i];
+    sum += static_cast<double>(input) - history[next];
+    history[next] = input;
+    if (++next == size)
+      next = 0;
+    out[i] = static_cast<float>(sum * scale);
+  }
+}
+
+Biquad::Biquad(const BiquadType type, const float cutoff, const float q) {
+  const float w0 =
+      glm::two_pi<float>() * clampValue(cutoff, 1e-6f, 0.5f - 1e-6f);
+  const float cosW0 = std::cos(w0);
+  const float alpha = std::sin(w0) / (2.f * std::max(q, 1e-3f));
+  float c0, c1, c2;
+  switch (type) {
+  case BiquadType::HIGHPASS:
+    c0 = (1.f + cosW0) * 0.5f;
+    c1 = -(1.f + cosW0);
+    c2 = c0;
+    break;
+  case BiquadType::BANDPASS:
+    c0 = alpha;
+    c1 = 0.f;
+    c2 = -alpha;
+    break;
+  case BiquadType::NOTCH:
+    c0 = 1.f;
+    c1 = -2.f * cosW0;
+    c2 = 1.f;
+    break;
+  case BiquadType::LOWPASS:
+  default:
+    c0 = (1.f - cosW0) * 0.5f;
+    c1 = 1.f - cosW0;
+    c2 = c0;
+    break;
+  }
+  const float a0 = 1.f + alpha;
+  b0 = c0 / a0;
+  b1 = c1 / a0;
+  b2 = c2 / a0;
+  a1 = -2.f * cosW0 / a0;
+  a2 = (1.f - alpha) / a0;
+}
+
+void Biquad::reset() {
+  z1 = 0.f;
+  z2 = 0.f;
+}
+
+void Biquad::process(const float *in, float *out, const std::size_t count) {
+  // Locals so the compiler keeps the state in registers across the block
+  float s1 = z1;
+  float s2 = z2;
+  for (std::size_t i = 0; i < count; ++i) {
+    const float input = in[i];
+    const float output = b0 * input + s1;
+    s1 = b1 * input - a1 * output + s2;
+    s2 = b2 * input - a2 * output;
+    out[i] = output;
+  }
+  z1 = s1;
+  z2 = s2;
+}
+
+Sinc::Sinc(const float cutoff, const int numTaps) {
+  const int n = std::max(numTaps, 1) | 1;
+  const float fc = clampValue(cutoff, 1e-6f, 0.5f);
+  const int half = n / 2;
+  taps.resize(n);
+  float total = 0.f;
+  for (int i = 0; i < n; ++i) {
+    const int k = i - half;
+    const float sinc = k == 0 ? 2.f * fc
+                              : std::sin(glm::two_pi<float>() * fc * k) /
+                                    (glm::pi<float>() * k);
+    const float phase = glm::two_pi<float>() * i / std::max(n - 1, 1);
+    const float blackman =
+        n == 1 ? 1.f
+               : 0.42f - 0.5f * std::cos(phase) + 0.08f * std::cos(2.f * phase);
+    taps[i] = sinc * blackman;
+    total += taps[i];
+  }
+  for (float &tap : taps) {
+    tap /= total;
+  }
+  // Taps are symmetric, so no reversal is needed for the convolution
+  history.resize(2 * taps.size());
+}
+
+void Sinc::reset() {
+  std::fill(history.begin(), history.end(), 0.f);
+  next = 0;
+  primed = false;
+}
+
+void Sinc::process(const float *in, float *out, const std::size_t count) {
+  if (count == 0)
+    return;
+  const std::size_t n = taps.size();
+  if (!primed) {
+    std::fill(history.begin(), history.end(), in[0]);
+    primed = true;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    const float input = in[i];
+    history[next] = input;
+    history[next + n] = input;
+    if (++next == n)
+      next = 0;
+    // history[next .. next + n) now holds the newest n samples, oldest first
+    const float *window = history.data() + next;
+    float acc = 0.f;
+    for (std::size_t t = 0; t < n; ++t) {
+      acc += taps[t] * window[t];
+    }
+    out[i] = acc;
+  }
+}
+
+} // namespace ofxCrvs
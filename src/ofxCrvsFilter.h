@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef OFXCRVSFILTER_H
+#define OFXCRVSFILTER_H
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Streaming filters over evenly spaced samples. process() runs a whole
+ * block; operator() feeds one sample, so a filter can also sit inside a
+ * FloatOp chain the way Ops::lpFb does. Both keep state between calls
+ * until reset().
+ */
+class Filter {
+public:
+  virtual ~Filter() = default;
+
+  // out may alias in
+  virtual void process(const float *in, float *out, std::size_t count) = 0;
+  virtual void reset() = 0;
+
+  float operator()(float input) {
+    float output;
+    process(&input, &output, 1);
+    return output;
+  }
+};
+
+/**
+ * Moving average of the last windowSize samples, kept as a running sum so
+ * each sample costs O(1) whatever the window. Before the window fills,
+ * the first sample stands in for the missing history, matching how
+ * Ops::lpf clamps positions below 0.
+ */
+class Boxcar : public Filter {
+public:
+  explicit Boxcar(int windowSize);
+
+  void process(const float *in, float *out, std::size_t count) override;
+  void reset() override;
+
+private:
+  vector<float> history;
+  std::size_t next = 0;
+  // Double so the running sum doesn't drift over long streams
+  double sum = 0.0;
+  bool primed = false;
+};
+
+enum class BiquadType {
+  LOWPASS,
+  HIGHPASS,
+  BANDPASS,
+  NOTCH,
+};
+
+/**
+ * Second-order IIR section from the RBJ audio EQ cookbook, in transposed
+ * direct form II. cutoff is in cycles per sample, in (0, 0.5).
+ */
+class Biquad : public Filter {
+public:
+  Biquad(BiquadType type, float cutoff, float q = 0.70710678f);
+
+  void process(const float *in, float *out, std::size_t count) override;
+  void reset() override;
+
+private:
+  float b0, b1, b2, a1, a2;
+  float z1 = 0.f;
+  float z2 = 0.f;
+};
+
+/**
+ * Linear-phase FIR low-pass: a Blackman-windowed sinc with unity gain at
+ * DC. cutoff is in cycles per sample; numTaps is rounded up to odd. The
+ * output lags the input by (numTaps - 1) / 2 samples.
+ */
+class Sinc : public Filter {
+public:
+  Sinc(float cutoff, int numTaps);
+
+  void process(const float *in, float *out, std::size_t count) override;
+  void reset() override;
+
+private:
+  vector<float> taps;
+  // Each sample is written twice, numTaps apart, so the newest numTaps
+  // samples are always contiguous for the dot product.
+  vector<float> history;
+  std::size_t next = 0;
+  bool primed = false;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSFILTER_H
@@ -0,0 +1,968 @@
+#include "ofxCrvsGraph.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "ofxCrvsOpRegistry.h"
+
+namespace ofxCrvs {
+
+namespace {
+
+// Programs up to this size keep their slots on the stack
+constexpr std::size_t maxStackSlots = 64;
+
+struct Instruction {
+  NodeKind kind;
+  float value;
+  // Range of argument slots in Program::argSlots
+  std::uint32_t first;
+  std::uint32_t count;
+  int external;
+};
+
+struct Program {
+  vector<Instruction> code;
+  vector<std::uint32_t> argSlots;
+  vector<FloatOp> externals;
+};
+
+constexpr std::uint32_t binaryMagic = 0x47565243; // "CRVG"
+// Version 2 adds CALL nodes, their params and the seed
+constexpr std::uint32_t formatVersion = 2;
+
+// Indexed by NodeKind; the binary format stores the index, so only append
+constexpr const char *kindNames[] = {
+    "CONST", "POS",  "EXTERNAL", "NEG",   "ABS",  "SIN",      "COS",
+    "TAN",   "SQRT", "EXP",      "LOG",   "FLOOR", "FRACT",   "ADD",
+    "SUB",   "MULT", "DIV",      "MIN",   "MAX",  "POW",      "MOD",
+    "MIX",   "CLAMP", "MEAN",    "VARIANCE", "STD_DEV", "MEDIAN",
+    "CALL",
+};
+constexpr std::size_t numKinds = sizeof(kindNames) / sizeof(kindNames[0]);
+static_assert(numKinds == static_cast<std::size_t>(NodeKind::CALL) + 1,
+              "kindNames must list every NodeKind");
+
+NodeKind kindFromName(const std::string &name) {
+  for (std::size_t i = 0; i < numKinds; ++i) {
+    if (name == kindNames[i])
+      return static_cast<NodeKind>(i);
+  }
+  throw std::runtime_error("Graph: unknown node kind " + name);
+}
+
+// Argument count a kind requires, -1 for one or more, or -2 for any
+int arity(NodeKind kind) {
+  switch (kind) {
+  case NodeKind::CONST:
+  case NodeKind::POS:
+    return 0;
+  case NodeKind::CALL:
+    return -2;
+  case NodeKind::ADD:
+  case NodeKind::SUB:
+  case NodeKind::MULT:
+  case NodeKind::DIV:
+  case NodeKind::MIN:
+  case NodeKind::MAX:
+  case NodeKind::POW:
+  case NodeKind::MOD:
+    return 2;
+  case NodeKind::MIX:
+  case NodeKind::CLAMP:
+    return 3;
+  case NodeKind::MEAN:
+  case NodeKind::VARIANCE:
+  case NodeKind::STD_DEV:
+  case NodeKind::MEDIAN:
+    return -1;
+  default:
+    return 1;
+  }
+}
+
+// Little-endian regardless of host, so files move between machines
+class Writer {
+public:
+  void u8(std::uint8_t v) { bytes.push_back(v); }
+  void u32(std::uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+      bytes.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+  }
+  void f32(float v) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    u32(bits);
+  }
+  void str(const std::string &v) {
+    u32(static_cast<std::uint32_t>(v.size()));
+    bytes.insert(bytes.end(), v.begin(), v.end());
+  }
+  vector<std::uint8_t> bytes;
+};
+
+class Reader {
+public:
+  explicit Reader(const vector<std::uint8_t> &bytes) : bytes(bytes) {}
+  std::uint8_t u8() {
+    need(1);
+    return bytes[offset++];
+  }
+  std::uint32_t u32() {
+    need(4);
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) {
+      v |= static_cast<std::uint32_t>(bytes[offset++]) << (8 * i);
+    }
+    return v;
+  }
+  float f32() {
+    const std::uint32_t bits = u32();
+    float v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+  }
+  std::string str() {
+    const std::uint32_t size = u32();
+    need(size);
+    std::string v(bytes.begin() + offset, bytes.begin() + offset + size);
+    offset += size;
+    return v;
+  }
+
+private:
+  void need(std::size_t count) const {
+    if (bytes.size() - offset < count)
+      throw std::runtime_error("Graph: truncated binary data");
+  }
+  const vector<std::uint8_t> &bytes;
+  std::size_t offset = 0;
+};
+
+// Just enough JSON for the graph schema: objects, arrays, strings and
+// numbers, so loading doesn't depend on openFrameworks' ofJson.
+struct Json {
+  enum class Type { NUL, NUMBER, STRING, ARRAY, OBJECT, BOOL };
+  Type type = Type::NUL;
+  double number = 0.0;
+  std::string string;
+  vector<Json> items;
+  vector<std::pair<std::string, Json>> members;
+
+  const Json *find(const std::string &key) const {
+    for (const auto &member : members) {
+      if (member.first == key)
+        return &member.second;
+    }
+    return nullptr;
+  }
+};
+
+class JsonParser {
+public:
+  explicit JsonParser(const std::string &text) : text(text) {}
+
+  Json parse() {
+    Json value = parseValue();
+    skipSpace();
+    if (offset != text.size())
+      fail("trailing characters");
+    return value;
+  }
+
+private:
+  [[noreturn]] void fail(const std::string &what) const {
+    throw std::runtime_error("Graph: bad JSON at " + std::to_string(offset) +
+                             ": " + what);
+  }
+
+  void skipSpace() {
+    while (offset < text.size() &&
+           std::isspace(static_cast<unsigned char>(text[offset])))
+      ++offset;
+  }
+
+  bool consume(char c) {
+    skipSpace();
+    if (offset < text.size() && text[offset] == c) {
+      ++offset;
+      return true;
+    }
+    return false;
+  }
+
+  void expect(char c) {
+    if (!consume(c))
+      fail(std::string("expected '") + c + "'");
+  }
+
+  Json parseValue() {
+    skipSpace();
+    if (offset >= text.size())
+      fail("unexpected end");
+    const char c = text[offset];
+    Json value;
+    if (c == '{') {
+      value.type = Json::Type::OBJECT;
+      ++offset;
+      if (consume('}'))
+        return value;
+      do {
+        std::string key = parseString();
+        expect(':');
+        value.members.emplace_back(std::move(key), parseValue());
+      } while (consume(','));
+      expect('}');
+    } else if (c == '[') {
+      value.type = Json::Type::ARRAY;
+      ++offset;
+      if (consume(']'))
+        return value;
+      do {
+        value.items.push_back(parseValue());
+      } while (consume(','));
+      expect(']');
+    } else if (c == '"') {
+      value.type = Json::Type::STRING;
+      value.string = parseString();
+    } else if (text.compare(offset, 4, "true") == 0 ||
+               text.compare(offset, 5, "false") == 0) {
+      value.type = Json::Type::BOOL;
+      value.number = text[offset] == 't' ? 1.0 : 0.0;
+      offset += text[offset] == 't' ? 4 : 5;
+    } else if (text.compare(offset, 4, "null") == 0) {
+      offset += 4;
+    } else {
+      value.type = Json::Type::NUMBER;
+      const char *begin = text.c_str() + offset;
+      char *end = nullptr;
+      value.number = std::strtod(begin, &end);
+      if (end == begin)
+        fail("expected a value");
+      offset += end - begin;
+    }
+    return value;
+  }
+
+  std::string parseString() {
+    skipSpace();
+    if (offset >= text.size() || text[offset] != '"')
+      fail("expected a string");
+    ++offset;
+    std::string result;
+    while (offset < text.size() && text[offset] != '"') {
+      char c = text[offset++];
+      if (c == '\\') {
+        if (offset >= text.size())
+          fail("unterminated escape");
+        c = text[offset++];
+        switch (c) {
+        case 'n':
+          c = '\n';
+          break;
+        case 't':
+          c = '\t';
+          break;
+        case 'r':
+          c = '\r';
+          break;
+        case 'b':
+          c = '\b';
+          break;
+        case 'f':
+          c = '\f';
+          break;
+        case 'u':
+          fail("\\u escapes are not supported");
+        default:
+          break;
+        }
+      }
+      result.push_back(c);
+    }
+    if (offset >= text.size())
+      fail("unterminated string");
+    ++offset;
+    return result;
+  }
+
+  const std::string &text;
+  std::size_t offset = 0;
+};
+
+std::string quoted(const std::string &value) {
+  std::string result = "\"";
+  for (const char c : value) {
+    if (c == '"' || c == '\\')
+      result.push_back('\\');
+    result.push_back(c);
+  }
+  result.push_back('"');
+  return result;
+}
+
+bool isJsonPath(const std::string &path) {
+  const std::string extension = ".json";
+  return path.size() >= extension.size() &&
+         path.compare(path.size() - extension.size(), extension.size(),
+                      extension) == 0;
+}
+
+std::uint32_t jsonIndex(const Json &value) {
+  if (value.type != Json::Type::NUMBER || value.number < 0)
+    throw std::runtime_error("Graph: expected a node index");
+  return static_cast<std::uint32_t>(value.number);
+}
+
+std::uint32_t floatBits(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+bool isCommutative(NodeKind kind) {
+  return kind == NodeKind::ADD || kind == NodeKind::MULT ||
+         kind == NodeKind::MIN || kind == NodeKind::MAX;
+}
+
+// Evaluates one node given the slots holding its arguments. Shared by the
+// compiled program and by constant folding, so both agree exactly.
+float run(const NodeKind kind, const float value, const std::uint32_t *args,
+          const std::uint32_t count, const float *slots, const float pos,
+          const FloatOp *external) {
+  const auto arg = [&](std::uint32_t i) { return slots[args[i]]; };
+  switch (kind) {
+  case NodeKind::CONST:
+    return value;
+  case NodeKind::POS:
+    return pos;
+  case NodeKind::EXTERNAL:
+    return (*external)(arg(0));
+  case NodeKind::CALL:
+    return (*external)(pos);
+  case NodeKind::NEG:
+    return -arg(0);
+  case NodeKind::ABS:
+    return std::abs(arg(0));
+  case NodeKind::SIN:
+    return std::sin(arg(0));
+  case NodeKind::COS:
+    return std::cos(arg(0));
+  case NodeKind::TAN:
+    return std::tan(arg(0));
+  case NodeKind::SQRT:
+    return std::sqrt(arg(0));
+  case NodeKind::EXP:
+    return std::exp(arg(0));
+  case NodeKind::LOG:
+    return std::log(arg(0));
+  case NodeKind::FLOOR:
+    return std::floor(arg(0));
+  case NodeKind::FRACT:
+    return arg(0) - std::floor(arg(0));
+  case NodeKind::ADD:
+    return arg(0) + arg(1);
+  case NodeKind::SUB:
+    return arg(0) - arg(1);
+  case NodeKind::MULT:
+    return arg(0) * arg(1);
+  case NodeKind::DIV:
+    return arg(0) / arg(1);
+  case NodeKind::MIN:
+    return std::min(arg(0), arg(1));
+  case NodeKind::MAX:
+    return std::max(arg(0), arg(1));
+  case NodeKind::POW:
+    return std::pow(arg(0), arg(1));
+  case NodeKind::MOD:
+    return std::fmod(arg(0), arg(1));
+  case NodeKind::MIX:
+    return lerpValue(arg(0), arg(1), arg(2));
+  case NodeKind::CLAMP:
+    return clampValue(arg(0), arg(1), arg(2));
+  case NodeKind::MEAN:
+  case NodeKind::VARIANCE:
+  case NodeKind::STD_DEV: {
+    float sum = 0.f;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      sum += arg(i);
+    }
+    const float mean = sum / count;
+    if (kind == NodeKind::MEAN)
+      return mean;
+    float variance = 0.f;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      const float diff = arg(i) - mean;
+      variance += diff * diff;
+    }
+    variance /= count;
+    return kind == NodeKind::VARIANCE ? variance : std::sqrt(variance);
+  }
+  case NodeKind::MEDIAN: {
+    float stackValues[maxStackSlots] = {};
+    vector<float> heapValues;
+    float *values = stackValues;
+    if (count > maxStackSlots) {
+      heapValues.resize(count);
+      values = heapValues.data();
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+      values[i] = arg(i);
+    }
+    std::nth_element(values, values + count / 2, values + count);
+    return values[count / 2];
+  }
+  }
+  return 0.f;
+}
+
+float execute(const Program &program, const float pos) {
+  const std::size_t size = program.code.size();
+  float stackSlots[maxStackSlots] = {};
+  vector<float> heapSlots;
+  float *slots = stackSlots;
+  if (size > maxStackSlots) {
+    heapSlots.resize(size);
+    slots = heapSlots.data();
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    const Instruction &in = program.code[i];
+    slots[i] = run(in.kind, in.value, program.argSlots.data() + in.first,
+                   in.count, slots, pos,
+                   in.external >= 0 ? &program.externals[in.external]
+                                    : nullptr);
+  }
+  return slots[size - 1];
+}
+
+} // namespace
+
+NodeId Graph::intern(Node node) {
+  reindex();
+  if (isCommutative(node.kind))
+    std::sort(node.args.begin(), node.args.end());
+  // Fold pure nodes whose arguments are all constant
+  if (node.kind != NodeKind::CONST && node.kind != NodeKind::POS &&
+      node.kind != NodeKind::EXTERNAL && node.kind != NodeKind::CALL &&
+      !node.args.empty() &&
+      std::all_of(node.args.begin(), node.args.end(),
+                  [this](NodeId arg) { return isConst(arg); })) {
+    vector<float> values;
+    vector<std::uint32_t> args;
+    for (const NodeId arg : node.args) {
+      args.push_back(static_cast<std::uint32_t>(values.size()));
+      values.push_back(nodes[arg].value);
+    }
+    const float folded = run(node.kind, 0.f, args.data(),
+                             static_cast<std::uint32_t>(args.size()),
+                             values.data(), 0.f, nullptr);
+    return c(folded);
+  }
+  Key key(node.kind, floatBits(node.value), node.args, node.external);
+  if (const auto it = index.find(key); it != index.end())
+    return it->second;
+  const NodeId id = static_cast<NodeId>(nodes.size());
+  nodes.push_back(std::move(node));
+  index.emplace(std::move(key), id);
+  return id;
+}
+
+bool Graph::isConst(const NodeId id, const float value) const {
+  return isConst(id) && nodes[id].value == value;
+}
+
+NodeId Graph::pos() { return intern(Node(NodeKind::POS)); }
+
+NodeId Graph::c(const float value) {
+  reindex();
+  Node node(NodeKind::CONST);
+  node.value = value;
+  Key key(node.kind, floatBits(value), node.args, node.external);
+  if (const auto it = index.find(key); it != index.end())
+    return it->second;
+  const NodeId id = static_cast<NodeId>(nodes.size());
+  nodes.push_back(node);
+  index.emplace(std::move(key), id);
+  return id;
+}
+
+NodeId Graph::op(const FloatOp op) { return this->op(op, pos()); }
+
+NodeId Graph::op(const std::string &name, const FloatOp op) {
+  return this->op(name, op, pos());
+}
+
+NodeId Graph::op(const std::string &name, const FloatOp op,
+                 const NodeId input) {
+  const NodeId id = this->op(op, input);
+  nodes[id].name = name;
+  return id;
+}
+
+NodeId Graph::op(const FloatOp op, const NodeId input) {
+  Node node(NodeKind::EXTERNAL);
+  node.args = {input};
+  node.external = static_cast<int>(externals.size());
+  externals.push_back(op);
+  return intern(std::move(node));
+}
+
+NodeId Graph::call(const std::string &name, const vector<NodeId> &children,
+                   const vector<float> &params) {
+  Node node(NodeKind::CALL);
+  for (const NodeId child : children) {
+    if (child >= nodes.size())
+      throw std::out_of_range("Graph: no node " + std::to_string(child));
+  }
+  node.name = name;
+  node.args = children;
+  node.params = params;
+  FloatOp op = build(node);
+  node.external = static_cast<int>(externals.size());
+  externals.push_back(std::move(op));
+  return intern(std::move(node));
+}
+
+FloatOp Graph::build(const Node &node) const {
+  vector<FloatOp> children;
+  children.reserve(node.args.size());
+  for (const NodeId arg : node.args) {
+    const Node &child = nodes[arg];
+    children.push_back(child.kind == NodeKind::CALL ? externals[child.external]
+                                                    : compile(arg));
+  }
+  return OpRegistry::build(ops, node.name, children, node.params);
+}
+
+NodeId Graph::unary(const NodeKind kind, const NodeId x) {
+  Node node(kind);
+  node.args = {x};
+  return intern(std::move(node));
+}
+
+NodeId Graph::binary(const NodeKind kind, const NodeId a, const NodeId b) {
+  Node node(kind);
+  node.args = {a, b};
+  return intern(std::move(node));
+}
+
+NodeId Graph::nary(const NodeKind kind, vector<NodeId> args) {
+  if (args.empty())
+    return c(0.f);
+  Node node(kind);
+  node.args = std::move(args);
+  return intern(std::move(node));
+}
+
+NodeId Graph::neg(const NodeId x) {
+  if (nodes[x].kind == NodeKind::NEG)
+    return nodes[x].args[0];
+  return unary(NodeKind::NEG, x);
+}
+
+NodeId Graph::abs(const NodeId x) { return unary(NodeKind::ABS, x); }
+NodeId Graph::sin(const NodeId x) { return unary(NodeKind::SIN, x); }
+NodeId Graph::cos(const NodeId x) { return unary(NodeKind::COS, x); }
+NodeId Graph::tan(const NodeId x) { return unary(NodeKind::TAN, x); }
+NodeId Graph::sqrt(const NodeId x) { return unary(NodeKind::SQRT, x); }
+NodeId Graph::exp(const NodeId x) { return unary(NodeKind::EXP, x); }
+NodeId Graph::log(const NodeId x) { return unary(NodeKind::LOG, x); }
+NodeId Graph::floor(const NodeId x) { return unary(NodeKind::FLOOR, x); }
+NodeId Graph::fract(const NodeId x) { return unary(NodeKind::FRACT, x); }
+
+NodeId Graph::add(const NodeId a, const NodeId b) {
+  if (isConst(a, 0.f))
+    return b;
+  if (isConst(b, 0.f))
+    return a;
+  return binary(NodeKind::ADD, a, b);
+}
+
+NodeId Graph::sub(const NodeId a, const NodeId b) {
+  if (isConst(b, 0.f))
+    return a;
+  if (a == b)
+    return c(0.f);
+  return binary(NodeKind::SUB, a, b);
+}
+
+NodeId Graph::mult(const NodeId a, const NodeId b) {
+  if (isConst(a, 1.f))
+    return b;
+  if (isConst(b, 1.f))
+    return a;
+  if (isConst(a, 0.f) || isConst(b, 0.f))
+    return c(0.f);
+  return binary(NodeKind::MULT, a, b);
+}
+
+NodeId Graph::div(const NodeId a, const NodeId b) {
+  if (isConst(b, 1.f))
+    return a;
+  return binary(NodeKind::DIV, a, b);
+}
+
+NodeId Graph::min(const NodeId a, const NodeId b) {
+  return a == b ? a : binary(NodeKind::MIN, a, b);
+}
+
+NodeId Graph::max(const NodeId a, const NodeId b) {
+  return a == b ? a : binary(NodeKind::MAX, a, b);
+}
+
+NodeId Graph::pow(const NodeId a, const NodeId b) {
+  if (isConst(b, 1.f))
+    return a;
+  if (isConst(b, 0.f))
+    return c(1.f);
+  return binary(NodeKind::POW, a, b);
+}
+
+NodeId Graph::mod(const NodeId a, const NodeId b) {
+  return binary(NodeKind::MOD, a, b);
+}
+
+NodeId Graph::mix(const NodeId a, const NodeId b, const NodeId t) {
+  if (a == b || isConst(t, 0.f))
+    return a;
+  if (isConst(t, 1.f))
+    return b;
+  Node node(NodeKind::MIX);
+  node.args = {a, b, t};
+  return intern(std::move(node));
+}
+
+NodeId Graph::clamp(const NodeId x, const NodeId lo, const NodeId hi) {
+  Node node(NodeKind::CLAMP);
+  node.args = {x, lo, hi};
+  return intern(std::move(node));
+}
+
+NodeId Graph::mean(const vector<NodeId> &xs) {
+  return xs.size() == 1 ? xs[0] : nary(NodeKind::MEAN, xs);
+}
+
+NodeId Graph::variance(const vector<NodeId> &xs) {
+  return nary(NodeKind::VARIANCE, xs);
+}
+
+NodeId Graph::stdDev(const vector<NodeId> &xs) {
+  return nary(NodeKind::STD_DEV, xs);
+}
+
+NodeId Graph::median(const vector<NodeId> &xs) {
+  return xs.size() == 1 ? xs[0] : nary(NodeKind::MEDIAN, xs);
+}
+
+FloatOp Graph::compile(const NodeId root) const {
+  if (root >= nodes.size())
+    throw std::out_of_range("Graph: no node " + std::to_string(root));
+  // Ids are already topologically ordered: arguments are interned first.
+  vector<bool> reachable(root + 1, false);
+  reachable[root] = true;
+  for (NodeId id = root + 1; id-- > 0;) {
+    // A CALL's children are inside its op, not slots of this program
+    if (!reachable[id] || nodes[id].kind == NodeKind::CALL)
+      continue;
+    for (const NodeId arg : nodes[id].args) {
+      reachable[arg] = true;
+    }
+  }
+  auto program = std::make_shared<Program>();
+  vector<std::uint32_t> slotOf(root + 1, 0);
+  for (NodeId id = 0; id <= root; ++id) {
+    if (!reachable[id])
+      continue;
+    const Node &node = nodes[id];
+    const bool call = node.kind == NodeKind::CALL;
+    Instruction in{node.kind, node.value,
+                   static_cast<std::uint32_t>(program->argSlots.size()),
+                   call ? 0u : static_cast<std::uint32_t>(node.args.size()),
+                   -1};
+    for (std::uint32_t a = 0; a < in.count; ++a) {
+      program->argSlots.push_back(slotOf[node.args[a]]);
+    }
+    if (node.kind == NodeKind::EXTERNAL || call) {
+      in.external = static_cast<int>(program->externals.size());
+      program->externals.push_back(externals[node.external]);
+    }
+    slotOf[id] = static_cast<std::uint32_t>(program->code.size());
+    program->code.push_back(in);
+  }
+  return [program = std::shared_ptr<const Program>(std::move(program))](
+             const float pos) { return execute(*program, pos); };
+}
+
+float Graph::evaluate(const NodeId root, const float pos) const {
+  return compile(root)(pos);
+}
+
+void Graph::restore(Node node, const OpResolver &resolver) {
+  const NodeId id = static_cast<NodeId>(nodes.size());
+  const int expected = arity(node.kind);
+  const std::size_t numArgs = node.args.size();
+  if ((expected >= 0 && numArgs != static_cast<std::size_t>(expected)) ||
+      (expected == -1 && numArgs == 0))
+    throw std::runtime_error("Graph: wrong argument count for node " +
+                             std::to_string(id));
+  for (const NodeId arg : node.args) {
+    // Saved graphs are in creation order, so arguments precede their users
+    if (arg >= id)
+      throw std::runtime_error("Graph: node " + std::to_string(id) +
+                               " refers forward to " + std::to_string(arg));
+  }
+  if (node.kind == NodeKind::EXTERNAL) {
+    FloatOp op = resolver ? resolver(node.name) : FloatOp();
+    if (!op)
+      throw std::runtime_error("Graph: no op named " + node.name);
+    node.external = static_cast<int>(externals.size());
+    externals.push_back(std::move(op));
+  } else if (node.kind == NodeKind::CALL) {
+    FloatOp op;
+    try {
+      op = build(node);
+    } catch (const std::logic_error &e) {
+      // Bad arity or params from the file, whichever factory noticed
+      throw std::runtime_error(std::string("Graph: ") + e.what());
+    }
+    node.external = static_cast<int>(externals.size());
+    externals.push_back(std::move(op));
+  }
+  // The hash-cons index is rebuilt on the first edit, not on load
+  indexStale = true;
+  nodes.push_back(std::move(node));
+}
+
+void Graph::reindex() {
+  if (!indexStale)
+    return;
+  index.clear();
+  for (NodeId id = 0; id < nodes.size(); ++id) {
+    const Node &node = nodes[id];
+    index.emplace(
+        Key(node.kind, floatBits(node.value), node.args, node.external), id);
+  }
+  indexStale = false;
+}
+
+void Graph::setOutput(const std::string &name, const NodeId id) {
+  outputs[name] = id;
+}
+
+NodeId Graph::getOutput(const std::string &name) const {
+  return outputs.at(name);
+}
+
+std::string Graph::toJson() const {
+  std::ostringstream out;
+  out.precision(9);
+  out << "{\n  \"version\": " << formatVersion
+      << ",\n  \"seed\": " << getSeed() << ",\n  \"nodes\": [";
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    const Node &node = nodes[i];
+    if (node.kind == NodeKind::EXTERNAL && node.name.empty())
+      throw std::invalid_argument("Graph: can't save unnamed op node " +
+                                  std::to_string(i));
+    out << (i == 0 ? "\n" : ",\n") << "    {\"kind\": "
+        << quoted(kindNames[static_cast<int>(node.kind)]);
+    if (node.kind == NodeKind::CONST)
+      out << ", \"value\": " << node.value;
+    if (node.kind == NodeKind::EXTERNAL || node.kind == NodeKind::CALL)
+      out << ", \"name\": " << quoted(node.name);
+    if (!node.params.empty()) {
+      out << ", \"params\": [";
+      for (std::size_t p = 0; p < node.params.size(); ++p) {
+        out << (p == 0 ? "" : ", ") << node.params[p];
+      }
+      out << "]";
+    }
+    if (!node.args.empty()) {
+      out << ", \"args\": [";
+      for (std::size_t a = 0; a < node.args.size(); ++a) {
+        out << (a == 0 ? "" : ", ") << node.args[a];
+      }
+      out << "]";
+    }
+    out << "}";
+  }
+  out << "\n  ],\n  \"outputs\": {";
+  bool first = true;
+  for (const auto &[name, id] : outputs) {
+    out << (first ? "\n" : ",\n") << "    " << quoted(name) << ": " << id;
+    first = false;
+  }
+  out << "\n  }\n}\n";
+  return out.str();
+}
+
+vector<std::uint8_t> Graph::toBinary() const {
+  Writer out;
+  out.u32(binaryMagic);
+  out.u32(formatVersion);
+  out.u32(getSeed());
+  out.u32(static_cast<std::uint32_t>(nodes.size()));
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    const Node &node = nodes[i];
+    if (node.kind == NodeKind::EXTERNAL && node.name.empty())
+      throw std::invalid_argument("Graph: can't save unnamed op node " +
+                                  std::to_string(i));
+    out.u8(static_cast<std::uint8_t>(node.kind));
+    out.f32(node.value);
+    out.u32(static_cast<std::uint32_t>(node.args.size()));
+    for (const NodeId arg : node.args) {
+      out.u32(arg);
+    }
+    out.str(node.name);
+    out.u32(static_cast<std::uint32_t>(node.params.size()));
+    for (const float param : node.params) {
+      out.f32(param);
+    }
+  }
+  out.u32(static_cast<std::uint32_t>(outputs.size()));
+  for (const auto &[name, id] : outputs) {
+    out.str(name);
+    out.u32(id);
+  }
+  return std::move(out.bytes);
+}
+
+Graph Graph::fromJson(const std::string &json, const OpResolver &resolver,
+                      std::shared_ptr<const Clock> clock) {
+  const Json root = JsonParser(json).parse();
+  const Json *version = root.find("version");
+  if (!version || version->number < 1 || version->number > formatVersion)
+    throw std::runtime_error("Graph: unsupported JSON version");
+  const Json *nodeList = root.find("nodes");
+  if (!nodeList || nodeList->type != Json::Type::ARRAY)
+    throw std::runtime_error("Graph: missing nodes");
+  Graph graph;
+  if (const Json *seed = root.find("seed"))
+    graph.setSeed(static_cast<std::uint32_t>(seed->number));
+  graph.setClock(std::move(clock));
+  graph.nodes.reserve(nodeList->items.size());
+  for (const Json &item : nodeList->items) {
+    const Json *kind = item.find("kind");
+    if (!kind || kind->type != Json::Type::STRING)
+      throw std::runtime_error("Graph: node without a kind");
+    Node node(kindFromName(kind->string));
+    if (const Json *value = item.find("value"))
+      node.value = static_cast<float>(value->number);
+    if (const Json *name = item.find("name"))
+      node.name = name->string;
+    if (const Json *params = item.find("params")) {
+      for (const Json &param : params->items) {
+        node.params.push_back(static_cast<float>(param.number));
+      }
+    }
+    if (const Json *args = item.find("args")) {
+      for (const Json &arg : args->items) {
+        node.args.push_back(jsonIndex(arg));
+      }
+    }
+    graph.restore(std::move(node), resolver);
+  }
+  if (const Json *outputList = root.find("outputs")) {
+    for (const auto &[name, id] : outputList->members) {
+      const NodeId nodeId = jsonIndex(id);
+      if (nodeId >= graph.nodes.size())
+        throw std::runtime_error("Graph: output " + name + " out of range");
+      graph.outputs[name] = nodeId;
+    }
+  }
+  return graph;
+}
+
+Graph Graph::fromBinary(const vector<std::uint8_t> &data,
+                        const OpResolver &resolver,
+                        std::shared_ptr<const Clock> clock) {
+  Reader in(data);
+  if (in.u32() != binaryMagic)
+    throw std::runtime_error("Graph: not a binary graph");
+  const std::uint32_t version = in.u32();
+  if (version < 1 || version > formatVersion)
+    throw std::runtime_error("Graph: unsupported binary version");
+  Graph graph;
+  if (version >= 2)
+    graph.setSeed(in.u32());
+  graph.setClock(std::move(clock));
+  const std::uint32_t count = in.u32();
+  graph.nodes.reserve(std::min<std::size_t>(count, data.size()));
+  for (std::uint32_t i = 0; i < count; ++i) {
+    const std::uint8_t kind = in.u8();
+    if (kind >= numKinds)
+      throw std::runtime_error("Graph: unknown node kind");
+    Node node(static_cast<NodeKind>(kind));
+    node.value = in.f32();
+    const std::uint32_t numArgs = in.u32();
+    for (std::uint32_t a = 0; a < numArgs; ++a) {
+      node.args.push_back(in.u32());
+    }
+    node.name = in.str();
+    if (version >= 2) {
+      const std::uint32_t numParams = in.u32();
+      for (std::uint32_t p = 0; p < numParams; ++p) {
+        node.params.push_back(in.f32());
+      }
+    }
+    graph.restore(std::move(node), resolver);
+  }
+  const std::uint32_t numOutputs = in.u32();
+  for (std::uint32_t i = 0; i < numOutputs; ++i) {
+    std::string name = in.str();
+    const NodeId id = in.u32();
+    if (id >= graph.nodes.size())
+      throw std::runtime_error("Graph: output " + name + " out of range");
+    graph.outputs[std::move(name)] = id;
+  }
+  return graph;
+}
+
+void Graph::save(const std::string &path) const {
+  std::ofstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Graph: can't write " + path);
+  if (isJsonPath(path)) {
+    file << toJson();
+  } else {
+    const vector<std::uint8_t> bytes = toBinary();
+    file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+  }
+}
+
+Graph Graph::load(const std::string &path, const OpResolver &resolver,
+                  std::shared_ptr<const Clock> clock) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("Graph: can't read " + path);
+  const vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+  if (isJsonPath(path))
+    return fromJson(std::string(bytes.begin(), bytes.end()), resolver,
+                    std::move(clock));
+  return fromBinary(bytes, resolver, std::move(clock));
+}
+
+LiveOp::LiveOp() : holder(std::make_shared<Holder>()) {}
+
+LiveOp::LiveOp(const FloatOp op) : LiveOp() { set(op); }
+
+void LiveOp::set(const FloatOp op) {
+  std::atomic_store(&holder->current, std::make_shared<const FloatOp>(op));
+}
+
+FloatOp LiveOp::op() const {
+  return [holder = holder](const float pos) {
+    const std::shared_ptr<const FloatOp> current =
+        std::atomic_load(&holder->current);
+    return current && *current ? (*current)(pos) : 0.f;
+  };
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,239 @@
+#pragma once
+
+#ifndef OFXCRVSGRAPH_H
+#define OFXCRVSGRAPH_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsOps.h"
+
+namespace ofxCrvs {
+
+enum class NodeKind {
+  CONST,
+  POS,
+  // Opaque FloatOp applied to its argument; never folded or merged
+  EXTERNAL,
+  NEG,
+  ABS,
+  SIN,
+  COS,
+  TAN,
+  SQRT,
+  EXP,
+  LOG,
+  FLOOR,
+  FRACT,
+  ADD,
+  SUB,
+  MULT,
+  DIV,
+  MIN,
+  MAX,
+  POW,
+  MOD,
+  MIX,
+  CLAMP,
+  MEAN,
+  VARIANCE,
+  STD_DEV,
+  MEDIAN,
+  // Ops factory, looked up by name in OpRegistry, over child nodes as ops
+  // of pos; never folded or merged
+  CALL,
+};
+
+using NodeId = std::uint32_t;
+
+// Looks up the FloatOp behind a named EXTERNAL node when a graph is loaded
+using OpResolver = std::function<FloatOp(const std::string &name)>;
+
+/**
+ * Expression DAG for building FloatOps that share work. Nodes are
+ * hash-consed, so building the same subtree twice returns the same node
+ * and it is evaluated once per sample. Nodes whose arguments are all
+ * constants are folded as they are built, along with the usual identities
+ * (x + 0, x * 1, x * 0, ...). compile() flattens the nodes reachable from
+ * a root into a linear program over value slots.
+ *
+ * Folding x * 0 to 0 assumes x is finite.
+ *
+ * call() adds an Ops factory by name, so a show built from Ops is a graph
+ * too:
+ *
+ *   Graph graph;
+ *   const NodeId lfo = graph.call("rate", {graph.call("sine")}, {0.25f});
+ *   graph.setOutput("lfo", graph.call("bias", {lfo, graph.call("saw")}));
+ *
+ * builds ops.bias(ops.rate(ops.sine(), 0.25f), ops.saw()) with the graph's
+ * Ops, and the other Graph nodes mix freely with CALL nodes.
+ *
+ * Graphs serialize to JSON, for diffing and hand edits, or to a compact
+ * binary form that loads without re-interning. CALL nodes are saved as the
+ * factory name, params and children, along with the graph's seed, and
+ * rebuilt from OpRegistry on load, random streams included. EXTERNAL nodes
+ * are saved by name and resolved through an OpResolver on load, so only
+ * named ones can be saved. Named outputs mark the roots a show file cares
+ * about.
+ */
+class Graph {
+public:
+  struct Node {
+    Node() = default;
+    explicit Node(NodeKind kind) : kind(kind) {}
+
+    NodeKind kind = NodeKind::CONST;
+    float value = 0.f;
+    // Inputs, or a CALL's children
+    vector<NodeId> args;
+    // Index into the external ops for EXTERNAL and CALL nodes
+    int external = -1;
+    // Name an EXTERNAL node is saved and resolved under, or a CALL's
+    // factory
+    std::string name;
+    // A CALL's number arguments
+    vector<float> params;
+  };
+
+  // Ops built by call() use seed 0 and no clock until set otherwise
+  Graph() { ops.setSeed(0); }
+
+  [[nodiscard]] NodeId pos();
+  [[nodiscard]] NodeId c(float value);
+  // Applies op to input, or to pos when input is omitted
+  [[nodiscard]] NodeId op(const FloatOp op);
+  [[nodiscard]] NodeId op(const FloatOp op, NodeId input);
+  [[nodiscard]] NodeId op(const std::string &name, const FloatOp op);
+  [[nodiscard]] NodeId op(const std::string &name, const FloatOp op,
+                          NodeId input);
+
+  [[nodiscard]] NodeId neg(NodeId x);
+  [[nodiscard]] NodeId abs(NodeId x);
+  [[nodiscard]] NodeId sin(NodeId x);
+  [[nodiscard]] NodeId cos(NodeId x);
+  [[nodiscard]] NodeId tan(NodeId x);
+  [[nodiscard]] NodeId sqrt(NodeId x);
+  [[nodiscard]] NodeId exp(NodeId x);
+  [[nodiscard]] NodeId log(NodeId x);
+  [[nodiscard]] NodeId floor(NodeId x);
+  [[nodiscard]] NodeId fract(NodeId x);
+
+  [[nodiscard]] NodeId add(NodeId a, NodeId b);
+  [[nodiscard]] NodeId sub(NodeId a, NodeId b);
+  [[nodiscard]] NodeId mult(NodeId a, NodeId b);
+  [[nodiscard]] NodeId div(NodeId a, NodeId b);
+  [[nodiscard]] NodeId min(NodeId a, NodeId b);
+  [[nodiscard]] NodeId max(NodeId a, NodeId b);
+  [[nodiscard]] NodeId pow(NodeId a, NodeId b);
+  [[nodiscard]] NodeId mod(NodeId a, NodeId b);
+  [[nodiscard]] NodeId mix(NodeId a, NodeId b, NodeId t);
+  [[nodiscard]] NodeId clamp(NodeId x, NodeId lo, NodeId hi);
+
+  // The Ops factory name over children and params, e.g. call("rate",
+  // {sine}, {2.f}) for ops.rate(sine, 2.f); each child is passed as an op
+  // of pos, so the factory may read it at any position. Throws
+  // std::invalid_argument if OpRegistry has no such overload and
+  // std::out_of_range for a child outside the graph.
+  [[nodiscard]] NodeId call(const std::string &name,
+                            const vector<NodeId> &children = {},
+                            const vector<float> &params = {});
+
+  // Seed and clock of the Ops that call() builds with. Set them before
+  // building: nodes already built keep theirs.
+  void setSeed(std::uint32_t seed) { ops.setSeed(seed); };
+  [[nodiscard]] std::uint32_t getSeed() const { return ops.getSeed(); };
+  void setClock(std::shared_ptr<const Clock> clock) {
+    ops.setClock(std::move(clock));
+  };
+
+  // Statistics over several nodes, each evaluated once per sample
+  [[nodiscard]] NodeId mean(const vector<NodeId> &xs);
+  [[nodiscard]] NodeId variance(const vector<NodeId> &xs);
+  [[nodiscard]] NodeId stdDev(const vector<NodeId> &xs);
+  [[nodiscard]] NodeId median(const vector<NodeId> &xs);
+
+  // Throws std::out_of_range if root isn't a node of this graph
+  [[nodiscard]] FloatOp compile(NodeId root) const;
+  // Single evaluation without compiling, mostly for testing
+  [[nodiscard]] float evaluate(NodeId root, float pos) const;
+
+  void setOutput(const std::string &name, NodeId id);
+  // Throws std::out_of_range for an unknown name
+  [[nodiscard]] NodeId getOutput(const std::string &name) const;
+  [[nodiscard]] const std::map<std::string, NodeId> &getOutputs() const {
+    return outputs;
+  };
+
+  // Throw std::invalid_argument on unnamed EXTERNAL nodes, and
+  // std::runtime_error on malformed input or unresolved names. clock is
+  // given to the ops CALL nodes are rebuilt with.
+  [[nodiscard]] std::string toJson() const;
+  [[nodiscard]] vector<std::uint8_t> toBinary() const;
+  static Graph fromJson(const std::string &json,
+                        const OpResolver &resolver = OpResolver(),
+                        std::shared_ptr<const Clock> clock = nullptr);
+  static Graph fromBinary(const vector<std::uint8_t> &data,
+                          const OpResolver &resolver = OpResolver(),
+                          std::shared_ptr<const Clock> clock = nullptr);
+  // Format follows the extension: .json is JSON, anything else binary
+  void save(const std::string &path) const;
+  static Graph load(const std::string &path,
+                    const OpResolver &resolver = OpResolver(),
+                    std::shared_ptr<const Clock> clock = nullptr);
+
+  [[nodiscard]] const Node &node(NodeId id) const { return nodes[id]; };
+  [[nodiscard]] std::size_t size() const { return nodes.size(); };
+  [[nodiscard]] bool isConst(NodeId id) const {
+    return nodes[id].kind == NodeKind::CONST;
+  };
+
+private:
+  using Key = std::tuple<NodeKind, std::uint32_t, vector<NodeId>, int>;
+
+  NodeId intern(Node node);
+  NodeId unary(NodeKind kind, NodeId x);
+  NodeId binary(NodeKind kind, NodeId a, NodeId b);
+  NodeId nary(NodeKind kind, vector<NodeId> args);
+  bool isConst(NodeId id, float value) const;
+  // Appends an already-validated node from a saved graph
+  void restore(Node node, const OpResolver &resolver);
+  void reindex();
+  // Builds a CALL node's op from its name, params and children
+  FloatOp build(const Node &node) const;
+
+  vector<Node> nodes;
+  std::map<Key, NodeId> index;
+  bool indexStale = false;
+  vector<FloatOp> externals;
+  std::map<std::string, NodeId> outputs;
+  Ops ops;
+};
+
+/**
+ * FloatOp whose implementation can be replaced while it is in use, e.g.
+ * with a freshly loaded Graph. Ops returned by op() always forward to the
+ * latest set() and stay valid after the LiveOp is destroyed.
+ */
+class LiveOp {
+public:
+  LiveOp();
+  explicit LiveOp(const FloatOp op);
+
+  void set(const FloatOp op);
+  [[nodiscard]] FloatOp op() const;
+
+private:
+  struct Holder {
+    std::shared_ptr<const FloatOp> current;
+  };
+  std::shared_ptr<Holder> holder;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSGRAPH_H
@@ -4,38 +4,67 @@
 
 #include "ofxCrvsHypr.h"
 
+#include "ofxCrvsUtils.hpp"
+
 namespace ofxCrvs {
 
 float Hypr::componentAt(Component c, float pos) const {
   pos = calcPos(pos);
   float value;
   if (c == Component::X) {
-    glm::vec3 xV = this->xCrv->uVector(pos, true);
-    value = xV.y;
+    value = axisAt("x", *this->xCrv, pos);
   } else if (c == Component::Y) {
-    glm::vec3 yV = this->yCrv->uVector(pos, true);
-    value = quantize(yV.y);
+    value = quantize(axisAt("y", *this->yCrv, pos));
   } else if (c == Component::Z) {
-    glm::vec3 zV = this->zCrv->uVector(pos, true);
-    value = quantize(zV.y);
+    value = quantize(axisAt("z", *this->zCrv, pos));
   } else {
-    glm::vec3 wV = this->wCrv->uVector(pos, true);
-    value = quantize(wV.y);
+    value = quantize(axisAt("w", *this->wCrv, pos));
   }
   value = bipolarize(value);
   value = ampBias(value, pos);
   return value;
 }
 
+// Evaluates the modulated position, amp and bias once and reads only the Y of
+// each axis curve, instead of a full componentAt() per component.
+glm::vec4 Hypr::jointAt(float pos, bool withW) const {
+  pos = calcPos(pos);
+  const float ampFactor = ampFactorAt(pos);
+  const float bias = biasAt(pos);
+  glm::vec4 v(0.f);
+  v.x = axisAt("x", *this->xCrv, pos);
+  v.y = quantize(axisAt("y", *this->yCrv, pos));
+  v.z = quantize(axisAt("z", *this->zCrv, pos));
+  if (withW)
+    v.w = quantize(axisAt("w", *this->wCrv, pos));
+  const int numComponents = withW ? 4 : 3;
+  for (int i = 0; i < numComponents; ++i) {
+    v[i] = ampBias(bipolarize(v[i]), ampFactor, bias);
+  }
+  return v;
+}
+
+glm::vec3 Hypr::componentsAt(float pos) const {
+  const glm::vec4 v = jointAt(pos, false);
+  return {v.x, v.y, v.z};
+}
+
+glm::vec4 Hypr::components4At(float pos) const { return jointAt(pos, true); }
+
 glm::vec4 Hypr::uVector4(float pos, bool transformed) const {
-  glm::vec3 v = Crv::uVector(pos, transformed);
-  return {v, wAt(pos)};
+  const glm::vec4 c = jointAt(pos, true);
+  glm::vec3 v(c.x, c.y, c.z);
+  if (transformed)
+    Utils::transform(v, UCENTER, scale, translation, rotation);
+  bounded(v);
+  return {v, c.w};
 }
 
 glm::vec4 Hypr::wVector4(float pos, bool transformed) const {
-  glm::vec3 v = Crv::wVector(pos, transformed);
+  const glm::vec4 u = uVector4(pos, transformed);
+  glm::vec3 v(u.x, u.y, u.z);
   boxed(v);
-  return {v, wAt(pos)};
+  return {v, u.w};
 }
 
 std::array<float, 4> Hypr::uFloat4(float pos, bool transformed) const {
@@ -48,4 +77,20 @@ std::array<float, 4> Hypr::wFloat4(float pos, bool transformed) const {
   return {v.x, v.y, v.z, v.w};
 }
 
-} // namespace ofxCrvs
\ No newline at end of file
+std::vector<glm::vec4> Hypr::glv4Array(int numPoints, bool boxed,
+                                       bool transformed,
+                                       FloatOp samplingRateOp) const {
+  std::vector<glm::vec4> vectors(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    float x = static_cast<float>(i) / (numPoints - 1);
+    if (samplingRateOp)
+      x = samplingRateOp(x);
+    if (boxed)
+      vectors[i] = wVector4(x, transformed);
+    else
+      vectors[i] = uVector4(x, transformed);
+  }
+  return vectors;
+}
+
+} // namespace ofxCrvs
@@ -8,7 +8,7 @@
 
 #include <utility>
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 #include "ofxCrvsCrv.h"
 
 namespace ofxCrvs {
@@ -40,10 +40,17 @@ public:
         zCrv(std::move(zCrv)), wCrv(std::move(wCrv)){};
 
   float componentAt(Component c, float pos) const override;
+  glm::vec3 componentsAt(float pos) const override;
+  glm::vec4 components4At(float pos) const;
   glm::vec4 uVector4(float pos, bool transformed) const;
   glm::vec4 wVector4(float pos, bool transformed) const;
   std::array<float, 4> uFloat4(float pos, bool transformed) const;
   std::array<float, 4> wFloat4(float pos, bool transformed) const;
+  std::vector<glm::vec4> glv4Array(int numPoints, bool boxed, bool transformed,
+                                   FloatOp samplingRateOp = FloatOp()) const;
+
+private:
+  glm::vec4 jointAt(float pos, bool withW) const;
 };
 } // namespace ofxCrvs
 
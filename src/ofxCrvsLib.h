@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * Every header of the ofxCrvs core, which needs only glm and the standard
+ * library. ofxCrvs.h adds the openFrameworks adapter, ofxCrvsOf.h.
+ */
+
+#include "ofxCrvsArcLength.h"
+#include "ofxCrvsAudioRenderer.h"
+#include "ofxCrvsBox.hpp"
+#include "ofxCrvsBreakpoints.h"
+#include "ofxCrvsBufferedContainer.h"
+#include "ofxCrvsClock.h"
+#include "ofxCrvsCloudOps.h"
+#include "ofxCrvsConstants.h"
+#include "ofxCrvsCore.h"
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsEdg.hpp"
+#include "ofxCrvsExport.h"
+#include "ofxCrvsFilter.h"
+#include "ofxCrvsGraph.h"
+#include "ofxCrvsHypr.h"
+#include "ofxCrvsLsjs.hpp"
+#include "ofxCrvsMetrics.h"
+#include "ofxCrvsMsh.h"
+#include "ofxCrvsNoise.h"
+#include "ofxCrvsNoiseField.h"
+#include "ofxCrvsOpRegistry.h"
+#include "ofxCrvsOps.h"
+#include "ofxCrvsProfiler.h"
+#include "ofxCrvsPtrn.h"
+#include "ofxCrvsRng.h"
+#include "ofxCrvsSimplify.h"
+#include "ofxCrvsSpatial.h"
+#include "ofxCrvsSrfc.h"
+#include "ofxCrvsStrm.h"
+#include "ofxCrvsTable.h"
+#include "ofxCrvsUtils.hpp"
+#include "ofxCrvsVertexStream.h"
+#include "ofxCrvsVoicePool.h"
\ No newline at end of file
@@ -13,15 +13,19 @@ float Lsjs::componentAt(Component c, float pos) const {
   pos = calcPos(pos);
   float value;
   if (c == Component::X) {
-    glm::vec3 xV = this->xCrv->uVector(pos, true);
-    value = xV.y;
+    value = axisAt("x", *this->xCrv, pos);
   } else if (c == Component::Y) {
-    glm::vec3 yV = this->yCrv->uVector(pos, true);
-    value = quantize(yV.y);
+    value = quantize(axisAt("y", *this->yCrv, pos));
   } else {
     return 0.f;
   }
   return value;
 }
 
+glm::vec3 Lsjs::componentsAt(float pos) const {
+  pos = calcPos(pos);
+  return {axisAt("x", *this->xCrv, pos),
+          quantize(axisAt("y", *this->yCrv, pos)), 0.f};
+}
+
 }  // namespace ofxCrvs
@@ -12,7 +12,7 @@
 
 #include <functional>
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 #include "ofxCrvsCrv.h"
 
 namespace ofxCrvs {
@@ -31,6 +31,7 @@ class Lsjs : public Crv {
       : Crv(box), xCrv(xCrv), yCrv(yCrv){};
 
   float componentAt(Component c, float pos) const;
+  glm::vec3 componentsAt(float pos) const override;
 };
 
 }  // namespace ofxCrvs
@@ -0,0 +1,232 @@
+#include "ofxCrvsMetrics.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace ofxCrvs {
+
+namespace {
+
+template <typename T>
+T &lookup(std::map<std::string, std::unique_ptr<T>> &metrics,
+          const std::string &name) {
+  std::unique_ptr<T> &metric = metrics[name];
+  if (!metric)
+    metric = std::make_unique<T>();
+  return *metric;
+}
+
+std::string jsonString(const std::string &s) {
+  std::string quoted = "\"";
+  for (const char ch : s) {
+    if (ch == '"' || ch == '\\')
+      quoted += '\\';
+    quoted += ch;
+  }
+  return quoted + "\"";
+}
+
+} // namespace
+
+std::uint64_t Histogram::lowerBound(const int bucket) {
+  const int group = bucket / kSubBuckets;
+  const std::uint64_t sub = bucket % kSubBuckets;
+  if (group == 0)
+    return sub;
+  return (kSubBuckets + sub) << (group - 1);
+}
+
+std::uint64_t Histogram::upperBound(const int bucket) {
+  const int group = bucket / kSubBuckets;
+  if (group == 0)
+    return lowerBound(bucket);
+  return lowerBound(bucket) + ((std::uint64_t{1} << (group - 1)) - 1);
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+  std::array<std::uint64_t, kNumBuckets> values;
+  Snapshot s;
+  int first = -1;
+  int last = -1;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    values[i] = counts[i].load(std::memory_order_relaxed);
+    if (values[i] == 0)
+      continue;
+    if (first < 0)
+      first = i;
+    last = i;
+    s.count += values[i];
+  }
+  s.sum = total.load(std::memory_order_relaxed);
+  if (s.count == 0)
+    return s;
+  s.min = lowerBound(first);
+  s.max = upperBound(last);
+  s.mean = static_cast<double>(s.sum) / s.count;
+
+  const auto quantile = [&](double q) {
+    const auto rank = static_cast<std::uint64_t>(std::ceil(q * s.count));
+    std::uint64_t seen = 0;
+    for (int i = first; i <= last; ++i) {
+      seen += values[i];
+      if (seen >= std::max<std::uint64_t>(rank, 1))
+        return upperBound(i);
+    }
+    return s.max;
+  };
+  s.p50 = quantile(0.5);
+  s.p90 = quantile(0.9);
+  s.p99 = quantile(0.99);
+  s.p999 = quantile(0.999);
+  return s;
+}
+
+void Histogram::reset() {
+  for (auto &count : counts)
+    count.store(0, std::memory_order_relaxed);
+  total.store(0, std::memory_order_relaxed);
+}
+
+Metrics &Metrics::global() {
+  static Metrics metrics;
+  return metrics;
+}
+
+Counter &Metrics::counter(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lookup(counters, name);
+}
+
+Gauge &Metrics::gauge(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lookup(gauges, name);
+}
+
+Histogram &Metrics::histogram(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex);
+  return lookup(histograms, name);
+}
+
+Metrics::Snapshot Metrics::snapshot() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  Snapshot s;
+  for (const auto &[name, counter] : counters)
+    s.counters[name] = counter->get();
+  for (const auto &[name, gauge] : gauges)
+    s.gauges[name] = gauge->get();
+  for (const auto &[name, histogram] : histograms)
+    s.histograms[name] = histogram->snapshot();
+  return s;
+}
+
+std::string Metrics::text() const {
+  const Snapshot s = snapshot();
+  std::ostringstream os;
+  for (const auto &[name, value] : s.counters)
+    os << name << ' ' << value << '\n';
+  for (const auto &[name, value] : s.gauges)
+    os << name << ' ' << value << '\n';
+  for (const auto &[name, h] : s.histograms) {
+    os << name << " count=" << h.count << " mean=" << h.mean
+       << " min=" << h.min << " p50=" << h.p50 << " p90=" << h.p90
+       << " p99=" << h.p99 << " p999=" << h.p999 << " max=" << h.max << '\n';
+  }
+  return os.str();
+}
+
+std::string Metrics::json() const {
+  const Snapshot s = snapshot();
+  std::ostringstream os;
+  os << "{\"counters\": {";
+  const char *sep = "";
+  for (const auto &[name, value] : s.counters) {
+    os << sep << jsonString(name) << ": " << value;
+    sep = ", ";
+  }
+  os << "}, \"gauges\": {";
+  sep = "";
+  for (const auto &[name, value] : s.gauges) {
+    os << sep << jsonString(name) << ": " << value;
+    sep = ", ";
+  }
+  os << "}, \"histograms\": {";
+  sep = "";
+  for (const auto &[name, h] : s.histograms) {
+    os << sep << jsonString(name) << ": {\"count\": " << h.count
+       << ", \"sum\": " << h.sum << ", \"mean\": " << h.mean
+       << ", \"min\": " << h.min << ", \"p50\": " << h.p50
+       << ", \"p90\": " << h.p90 << ", \"p99\": " << h.p99
+       << ", \"p999\": " << h.p999 << ", \"max\": " << h.max << "}";
+    sep = ", ";
+  }
+  os << "}}\n";
+  return os.str();
+}
+
+std::string Metrics::format(const Format format) const {
+  return format == Format::JSON ? json() : text();
+}
+
+void Metrics::reset() {
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto &[name, counter] : counters)
+    counter->reset();
+  for (auto &[name, gauge] : gauges)
+    gauge->set(0.0);
+  for (auto &[name, histogram] : histograms)
+    histogram->reset();
+}
+
+MetricsWriter::MetricsWriter(std::string path,
+                             const std::chrono::milliseconds interval,
+                             const Metrics::Format format, Metrics &metrics)
+    : path(std::move(path)), interval(interval), format(format),
+      metrics(metrics) {
+  if (interval.count() <= 0)
+    throw std::invalid_argument("MetricsWriter: interval must be positive");
+  // Surfaces a bad path here rather than on the background thread
+  write();
+  worker = std::thread([this] { run(); });
+}
+
+MetricsWriter::~MetricsWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  worker.join();
+}
+
+void MetricsWriter::write() const {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream file(tmp);
+    if (!file)
+      throw std::runtime_error("MetricsWriter: cannot write " + tmp);
+    file << metrics.format(format);
+    if (!file)
+      throw std::runtime_error("MetricsWriter: cannot write " + tmp);
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0)
+    throw std::runtime_error("MetricsWriter: cannot replace " + path);
+}
+
+void MetricsWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (!wake.wait_for(lock, interval, [this] { return stopping; })) {
+    lock.unlock();
+    // A failed write is retried on the next interval
+    try {
+      write();
+    } catch (const std::runtime_error &) {
+    }
+    lock.lock();
+  }
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,194 @@
+#pragma once
+
+#ifndef OFXCRVSMETRICS_H
+#define OFXCRVSMETRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/** Monotonic event count. add() is one relaxed atomic increment. */
+class alignas(64) Counter {
+public:
+  void add(std::uint64_t n = 1) {
+    value.fetch_add(n, std::memory_order_relaxed);
+  };
+  [[nodiscard]] std::uint64_t get() const {
+    return value.load(std::memory_order_relaxed);
+  };
+  void reset() { value.store(0, std::memory_order_relaxed); };
+
+private:
+  std::atomic<std::uint64_t> value{0};
+};
+
+/** Last value of a level, e.g. a cache size. set() is one relaxed store. */
+class alignas(64) Gauge {
+public:
+  void set(double v) { value.store(v, std::memory_order_relaxed); };
+  [[nodiscard]] double get() const {
+    return value.load(std::memory_order_relaxed);
+  };
+
+private:
+  std::atomic<double> value{0.0};
+};
+
+/**
+ * Latency histogram in the HdrHistogram layout: values below 16 get a bucket
+ * each, above that every power of two is split into 16 linear sub-buckets,
+ * so a bucket is never wider than 1/16 of its value. Covers the full
+ * uint64 range in fixed memory, and record() is two relaxed increments with
+ * no locks or allocation. Quantiles report a bucket's upper bound.
+ */
+class Histogram {
+public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+  struct Snapshot {
+    std::uint64_t count = 0;
+    std::uint64_t sum = 0;
+    std::uint64_t min = 0;
+    std::uint64_t max = 0;
+    double mean = 0.0;
+    std::uint64_t p50 = 0;
+    std::uint64_t p90 = 0;
+    std::uint64_t p99 = 0;
+    std::uint64_t p999 = 0;
+  };
+
+  void record(std::uint64_t value) {
+    counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+  };
+  void record(std::chrono::nanoseconds elapsed) {
+    record(static_cast<std::uint64_t>(std::max<std::int64_t>(
+        elapsed.count(), 0)));
+  };
+
+  // Reads the buckets without stopping writers; events recorded during the
+  // read may be missing from some fields
+  [[nodiscard]] Snapshot snapshot() const;
+  void reset();
+
+  [[nodiscard]] static int bucketOf(std::uint64_t value) {
+    if (value < kSubBuckets)
+      return static_cast<int>(value);
+    const int msb = 63 - countLeadingZeros(value);
+    const int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets +
+           static_cast<int>((value >> shift) - kSubBuckets);
+  };
+  [[nodiscard]] static std::uint64_t lowerBound(int bucket);
+  [[nodiscard]] static std::uint64_t upperBound(int bucket);
+
+private:
+  static int countLeadingZeros(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(value);
+#else
+    int n = 0;
+    for (std::uint64_t bit = 1ull << 63; !(value & bit); bit >>= 1)
+      ++n;
+    return n;
+#endif
+  };
+
+  std::array<std::atomic<std::uint64_t>, kNumBuckets> counts{};
+  std::atomic<std::uint64_t> total{0};
+};
+
+/**
+ * Named counters, gauges and histograms. Looking a metric up takes a lock,
+ * so callers resolve names once and keep the reference, which stays valid
+ * for the registry's lifetime; recording through it is lock-free. Names are
+ * dotted paths such as "ptrn.kick.rebuild_ns".
+ *
+ *   Counter &steps = Metrics::global().counter("ptrn.kick.steps");
+ *   steps.add();
+ *   std::cout << Metrics::global().text();
+ */
+class Metrics {
+public:
+  enum class Format { TEXT, JSON };
+
+  struct Snapshot {
+    std::map<std::string, std::uint64_t> counters;
+    std::map<std::string, double> gauges;
+    std::map<std::string, Histogram::Snapshot> histograms;
+  };
+
+  [[nodiscard]] static Metrics &global();
+
+  [[nodiscard]] Counter &counter(const std::string &name);
+  [[nodiscard]] Gauge &gauge(const std::string &name);
+  [[nodiscard]] Histogram &histogram(const std::string &name);
+
+  // Pull API
+  [[nodiscard]] Snapshot snapshot() const;
+  // One "name value" line per counter and gauge, and one line of count,
+  // mean and quantiles per histogram
+  [[nodiscard]] std::string text() const;
+  [[nodiscard]] std::string json() const;
+  [[nodiscard]] std::string format(Format format) const;
+  // Zeroes every metric; references stay valid
+  void reset();
+
+private:
+  mutable std::mutex mutex;
+  std::map<std::string, std::unique_ptr<Counter>> counters;
+  std::map<std::string, std::unique_ptr<Gauge>> gauges;
+  std::map<std::string, std::unique_ptr<Histogram>> histograms;
+};
+
+/**
+ * Writes a snapshot of a registry to a file every interval from a
+ * background thread, until destroyed. Each write goes to a temporary file
+ * that is renamed over path, so readers never see a partial snapshot.
+ */
+class MetricsWriter {
+public:
+  MetricsWriter(std::string path, std::chrono::milliseconds interval,
+                Metrics::Format format = Metrics::Format::JSON,
+                Metrics &metrics = Metrics::global());
+  ~MetricsWriter();
+
+  MetricsWriter(const MetricsWriter &) = delete;
+  MetricsWriter &operator=(const MetricsWriter &) = delete;
+
+  // Writes a snapshot now, on the calling thread; waits for a write already
+  // in progress on another thread
+  void write() const;
+
+private:
+  void run();
+
+  std::string path;
+  std::chrono::milliseconds interval;
+  Metrics::Format format;
+  Metrics &metrics;
+
+  // Held for a whole write(), so a caller's write and the background one
+  // never share the temporary file
+  mutable std::mutex writeMutex;
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+  std::thread worker;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSMETRICS_H
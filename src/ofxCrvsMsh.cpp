@@ -13,18 +13,29 @@ float Msh::componentAt(Component c, float pos) const {
   pos = calcPos(pos);
   float value;
   if (c == Component::X) {
-    glm::vec3 xV = this->xCrv->uVector(pos, true);
-    value = xV.y;
+    value = axisAt("x", *this->xCrv, pos);
   } else if (c == Component::Y) {
-    glm::vec3 yV = this->yCrv->uVector(pos, true);
-    value = quantize(yV.y);
+    value = quantize(axisAt("y", *this->yCrv, pos));
   } else {
-    glm::vec3 zV = this->zCrv->uVector(pos, true);
-    value = quantize(zV.y);
+    value = quantize(axisAt("z", *this->zCrv, pos));
   }
   value = bipolarize(value);
   value = ampBias(value, pos);
   return value;
 }
 
+glm::vec3 Msh::componentsAt(float pos) const {
+  pos = calcPos(pos);
+  const float ampFactor = ampFactorAt(pos);
+  const float bias = biasAt(pos);
+  glm::vec3 v;
+  v.x = axisAt("x", *this->xCrv, pos);
+  v.y = quantize(axisAt("y", *this->yCrv, pos));
+  v.z = quantize(axisAt("z", *this->zCrv, pos));
+  for (int i = 0; i < 3; ++i) {
+    v[i] = ampBias(bipolarize(v[i]), ampFactor, bias);
+  }
+  return v;
+}
+
 }  // namespace ofxCrvs
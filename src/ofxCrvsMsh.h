@@ -1,5 +1,5 @@
 //
-//  ofxCrvsLsjs.hpp
+//  ofxCrvsMsh.h
 //  example_ofxCrvs
 //
 //  Created by Jared McFarland on 12/22/23.
@@ -7,17 +7,18 @@
 
 #pragma once
 
-#ifndef ofxCrvsLsjs_hpp
-#define ofxCrvsLsjs_hpp
+#ifndef ofxCrvsMsh_h
+#define ofxCrvsMsh_h
 
 #include <functional>
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 #include "ofxCrvsCrv.h"
 
 namespace ofxCrvs {
 
-using VctrOp = std::function<glm::vec3(glm::vec3)>;
+// The 3D counterpart of Lsjs's VctrOp
+using Vctr3Op = std::function<glm::vec3(glm::vec3)>;
 
 class Msh : public Crv {
  public:
@@ -35,8 +36,9 @@ class Msh : public Crv {
       : Crv(box), xCrv(xCrv), yCrv(yCrv), zCrv(zCrv){};
 
   float componentAt(Component c, float pos) const;
+  glm::vec3 componentsAt(float pos) const override;
 };
 
 }  // namespace ofxCrvs
 
-#endif /* ofxCrvsLsjs_hpp */
+#endif /* ofxCrvsMsh_h */
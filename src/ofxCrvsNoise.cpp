@@ -0,0 +1,471 @@
+#include "ofxCrvsNoise.h"
+
+#include <algorithm>
+
+#include "ofxCrvsRng.h"
+
+// The block loops in Fbm only vectorize if the lattice kernels are inlined
+// into them, which GCC declines to do on size alone for 3D and 4D.
+#if defined(_MSC_VER)
+#define OFXCRVS_FORCE_INLINE __forceinline
+#else
+#define OFXCRVS_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace ofxCrvs {
+
+namespace {
+
+constexpr std::uint32_t primeX = 0x8da6b343u;
+constexpr std::uint32_t primeY = 0xd8163841u;
+constexpr std::uint32_t primeZ = 0xcb1ab31fu;
+constexpr std::uint32_t primeW = 0x165667b1u;
+
+// Empirical scale factors bringing each dimension to roughly [-1, 1]
+constexpr float scale1 = 2.f;
+constexpr float scale2 = 1.f;
+constexpr float scale3 = 1.f;
+constexpr float scale4 = 0.85f;
+
+inline int fastFloor(float x) {
+  const int i = static_cast<int>(x);
+  return i - static_cast<int>(x < static_cast<float>(i));
+}
+
+inline float fade(float t) { return t * t * t * (t * (t * 6.f - 15.f) + 10.f); }
+
+inline float lerp(float a, float b, float t) { return a + t * (b - a); }
+
+inline std::uint32_t corner(std::uint32_t seed, int x) {
+  return Rng::hash(static_cast<std::uint32_t>(x) * primeX ^ seed);
+}
+
+inline std::uint32_t corner(std::uint32_t seed, int x, int y) {
+  return Rng::hash(static_cast<std::uint32_t>(x) * primeX ^
+                   static_cast<std::uint32_t>(y) * primeY ^ seed);
+}
+
+inline std::uint32_t corner(std::uint32_t seed, int x, int y, int z) {
+  return Rng::hash(static_cast<std::uint32_t>(x) * primeX ^
+                   static_cast<std::uint32_t>(y) * primeY ^
+                   static_cast<std::uint32_t>(z) * primeZ ^ seed);
+}
+
+inline std::uint32_t corner(std::uint32_t seed, int x, int y, int z, int w) {
+  return Rng::hash(static_cast<std::uint32_t>(x) * primeX ^
+                   static_cast<std::uint32_t>(y) * primeY ^
+                   static_cast<std::uint32_t>(z) * primeZ ^
+                   static_cast<std::uint32_t>(w) * primeW ^ seed);
+}
+
+inline float grad(std::uint32_t h, float x) {
+  return (static_cast<int>(h >> 8) * (2.f / 16777216.f) - 1.f) * x;
+}
+
+// Four diagonal gradients; the sign flips are written arithmetically
+// because GCC won't if-convert them here.
+inline float grad(std::uint32_t h, float x, float y) {
+  const float sx = 1.f - static_cast<float>(static_cast<int>(h & 1) << 1);
+  const float sy = 1.f - static_cast<float>(static_cast<int>(h & 2));
+  return sx * x + sy * y;
+}
+
+// Ken Perlin's 12 cube-edge gradients
+inline float grad(std::uint32_t h, float x, float y, float z) {
+  h &= 15;
+  const float u = h < 8 ? x : y;
+  const float v = h < 4 ? y : (h & 13) == 12 ? x : z;
+  return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+}
+
+inline float grad(std::uint32_t h, float x, float y, float z, float w) {
+  h &= 31;
+  const float a = h < 24 ? x : y;
+  const float b = h < 16 ? y : z;
+  const float c = h < 8 ? z : w;
+  return ((h & 1) ? -a : a) + ((h & 2) ? -b : b) + ((h & 4) ? -c : c);
+}
+
+inline float unipolar(float n) {
+  const float u = n * 0.5f + 0.5f;
+  const float lo = u < 0.f ? 0.f : u;
+  return lo > 1.f ? 1.f : lo;
+}
+
+// The lattice kernels take an already-hashed seed and contain no branches
+// or table lookups, so loops over them vectorize.
+OFXCRVS_FORCE_INLINE float noise1(float x, std::uint32_t seed) {
+  const int x0 = fastFloor(x);
+  const float fx = x - x0;
+  return scale1 * lerp(grad(corner(seed, x0), fx),
+                       grad(corner(seed, x0 + 1), fx - 1.f), fade(fx));
+}
+
+OFXCRVS_FORCE_INLINE float noise2(float x, float y, std::uint32_t seed) {
+  const int x0 = fastFloor(x);
+  const int y0 = fastFloor(y);
+  const float fx = x - x0;
+  const float fy = y - y0;
+  const float u = fade(fx);
+  const float v = fade(fy);
+  const float n00 = grad(corner(seed, x0, y0), fx, fy);
+  const float n10 = grad(corner(seed, x0 + 1, y0), fx - 1.f, fy);
+  const float n01 = grad(corner(seed, x0, y0 + 1), fx, fy - 1.f);
+  const float n11 = grad(corner(seed, x0 + 1, y0 + 1), fx - 1.f, fy - 1.f);
+  return scale2 * lerp(lerp(n00, n10, u), lerp(n01, n11, u), v);
+}
+
+OFXCRVS_FORCE_INLINE float noise3(float x, float y, float z,
+                                  std::uint32_t seed) {
+  const int x0 = fastFloor(x);
+  const int y0 = fastFloor(y);
+  const int z0 = fastFloor(z);
+  const float fx = x - x0;
+  const float fy = y - y0;
+  const float fz = z - z0;
+  const float gx = fx - 1.f;
+  const float gy = fy - 1.f;
+  const float gz = fz - 1.f;
+  const float u = fade(fx);
+  const float v = fade(fy);
+  const float t = fade(fz);
+  // Corners written out: GCC won't vectorize the callers' loops through
+  // a nested corner loop.
+  const float n000 = grad(corner(seed, x0, y0, z0), fx, fy, fz);
+  const float n100 = grad(corner(seed, x0 + 1, y0, z0), gx, fy, fz);
+  const float n010 = grad(corner(seed, x0, y0 + 1, z0), fx, gy, fz);
+  const float n110 = grad(corner(seed, x0 + 1, y0 + 1, z0), gx, gy, fz);
+  const float n001 = grad(corner(seed, x0, y0, z0 + 1), fx, fy, gz);
+  const float n101 = grad(corner(seed, x0 + 1, y0, z0 + 1), gx, fy, gz);
+  const float n011 = grad(corner(seed, x0, y0 + 1, z0 + 1), fx, gy, gz);
+  const float n111 = grad(corner(seed, x0 + 1, y0 + 1, z0 + 1), gx, gy, gz);
+  const float n0 = lerp(lerp(n000, n100, u), lerp(n010, n110, u), v);
+  const float n1 = lerp(lerp(n001, n101, u), lerp(n011, n111, u), v);
+  return scale3 * lerp(n0, n1, t);
+}
+
+// One w-slice of the 4D lattice cell
+OFXCRVS_FORCE_INLINE float slice4(std::uint32_t seed, int x0, int y0, int z0,
+                                  int w0, float fx, float fy, float fz,
+                                  float fw, float u, float v, float t) {
+  const float gx = fx - 1.f;
+  const float gy = fy - 1.f;
+  const float gz = fz - 1.f;
+  const float n000 = grad(corner(seed, x0, y0, z0, w0), fx, fy, fz, fw);
+  const float n100 = grad(corner(seed, x0 + 1, y0, z0, w0), gx, fy, fz, fw);
+  const float n010 = grad(corner(seed, x0, y0 + 1, z0, w0), fx, gy, fz, fw);
+  const float n110 =
+      grad(corner(seed, x0 + 1, y0 + 1, z0, w0), gx, gy, fz, fw);
+  const float n001 = grad(corner(seed, x0, y0, z0 + 1, w0), fx, fy, gz, fw);
+  const float n101 =
+      grad(corner(seed, x0 + 1, y0, z0 + 1, w0), gx, fy, gz, fw);
+  const float n011 =
+      grad(corner(seed, x0, y0 + 1, z0 + 1, w0), fx, gy, gz, fw);
+  const float n111 =
+      grad(corner(seed, x0 + 1, y0 + 1, z0 + 1, w0), gx, gy, gz, fw);
+  const float n0 = lerp(lerp(n000, n100, u), lerp(n010, n110, u), v);
+  const float n1 = lerp(lerp(n001, n101, u), lerp(n011, n111, u), v);
+  return lerp(n0, n1, t);
+}
+
+OFXCRVS_FORCE_INLINE float noise4(float x, float y, float z, float w,
+                                  std::uint32_t seed) {
+  const int x0 = fastFloor(x);
+  const int y0 = fastFloor(y);
+  const int z0 = fastFloor(z);
+  const int w0 = fastFloor(w);
+  const float fx = x - x0;
+  const float fy = y - y0;
+  const float fz = z - z0;
+  const float fw = w - w0;
+  const float u = fade(fx);
+  const float v = fade(fy);
+  const float t = fade(fz);
+  const float n0 = slice4(seed, x0, y0, z0, w0, fx, fy, fz, fw, u, v, t);
+  const float n1 =
+      slice4(seed, x0, y0, z0, w0 + 1, fx, fy, fz, fw - 1.f, u, v, t);
+  return scale4 * lerp(n0, n1, fade(fw));
+}
+
+} // namespace
+
+float Noise::signedNoise(float x, std::uint32_t seed) {
+  return noise1(x, Rng::hash(seed));
+}
+
+float Noise::signedNoise(float x, float y, std::uint32_t seed) {
+  return noise2(x, y, Rng::hash(seed));
+}
+
+float Noise::signedNoise(float x, float y, float z, std::uint32_t seed) {
+  return noise3(x, y, z, Rng::hash(seed));
+}
+
+float Noise::signedNoise(float x, float y, float z, float w,
+                         std::uint32_t seed) {
+  return noise4(x, y, z, w, Rng::hash(seed));
+}
+
+float Noise::noise(float x, std::uint32_t seed) {
+  return unipolar(signedNoise(x, seed));
+}
+
+float Noise::noise(float x, float y, std::uint32_t seed) {
+  return unipolar(signedNoise(x, y, seed));
+}
+
+float Noise::noise(float x, float y, float z, std::uint32_t seed) {
+  return unipolar(signedNoise(x, y, z, seed));
+}
+
+float Noise::noise(float x, float y, float z, float w, std::uint32_t seed) {
+  return unipolar(signedNoise(x, y, z, w, seed));
+}
+
+float Noise::fbm(float x, float falloff, int octaves, std::uint32_t seed) {
+  float amplitude = 1.0f;
+  float frequency = 1.0f;
+  float total = 0.0f;
+  float maxAmplitude = 0.0f;
+  for (int i = 0; i < std::max(octaves, 1); i++) {
+    total += noise(x * frequency, seed) * amplitude;
+    maxAmplitude += amplitude;
+    amplitude *= falloff;
+    frequency *= 2.0f;
+  }
+  return total / maxAmplitude;
+}
+
+float Noise::fbm(float x, float y, float falloff, int octaves,
+                 std::uint32_t seed) {
+  float amplitude = 1.0f;
+  float frequency = 1.0f;
+  float total = 0.0f;
+  float maxAmplitude = 0.0f;
+  for (int i = 0; i < std::max(octaves, 1); i++) {
+    total += noise(x * frequency, y * frequency, seed) * amplitude;
+    maxAmplitude += amplitude;
+    amplitude *= falloff;
+    frequency *= 2.0f;
+  }
+  return total / maxAmplitude;
+}
+
+float Noise::fbm(float x, float y, float z, float falloff, int octaves,
+                 std::uint32_t seed) {
+  float amplitude = 1.0f;
+  float frequency = 1.0f;
+  float total = 0.0f;
+  float maxAmplitude = 0.0f;
+  for (int i = 0; i < std::max(octaves, 1); i++) {
+    total += noise(x * frequency, y * frequency, z * frequency, seed) *
+             amplitude;
+    maxAmplitude += amplitude;
+    amplitude *= falloff;
+    frequency *= 2.0f;
+  }
+  return total / maxAmplitude;
+}
+
+float Noise::fbm(float x, float y, float z, float w, float falloff,
+                 int octaves, std::uint32_t seed) {
+  float amplitude = 1.0f;
+  float frequency = 1.0f;
+  float total = 0.0f;
+  float maxAmplitude = 0.0f;
+  for (int i = 0; i < std::max(octaves, 1); i++) {
+    total += noise(x * frequency, y * frequency, z * frequency, w * frequency,
+                   seed) *
+             amplitude;
+    maxAmplitude += amplitude;
+    amplitude *= falloff;
+    frequency *= 2.0f;
+  }
+  return total / maxAmplitude;
+}
+
+Fbm::Fbm(const float falloff, const int octaves, const std::uint32_t seed)
+    : seed(Rng::hash(seed)) {
+  float amplitude = 1.0f;
+  float frequency = 1.0f;
+  float maxAmplitude = 0.0f;
+  for (int i = 0; i < std::max(octaves, 1); i++) {
+    frequencies.push_back(frequency);
+    weights.push_back(amplitude);
+    maxAmplitude += amplitude;
+    amplitude *= falloff;
+    frequency *= 2.0f;
+  }
+  // Fold the normalization into each weight
+  for (float &weight : weights) {
+    weight /= maxAmplitude;
+  }
+}
+
+float Fbm::operator()(const float x) const {
+  float out;
+  (*this)(&x, &out, 1);
+  return out;
+}
+
+float Fbm::operator()(const float x, const float y) const {
+  float out;
+  (*this)(&x, &y, &out, 1);
+  return out;
+}
+
+float Fbm::operator()(const float x, const float y, const float z) const {
+  float out;
+  (*this)(&x, &y, &z, &out, 1);
+  return out;
+}
+
+float Fbm::operator()(const float x, const float y, const float z,
+                      const float w) const {
+  float out;
+  (*this)(&x, &y, &z, &w, &out, 1);
+  return out;
+}
+
+void Fbm::operator()(const float *x, float *out,
+                     const std::size_t count) const {
+  float bx[blockSize];
+  float sx[blockSize];
+  float acc[blockSize];
+  for (std::size_t begin = 0; begin < count; begin += blockSize) {
+    const std::size_t n = std::min(blockSize, count - begin);
+    // Copy first so out may alias an input
+    for (std::size_t i = 0; i < n; ++i) {
+      bx[i] = x[begin + i];
+    }
+    std::fill(acc, acc + n, 0.f);
+    for (std::size_t o = 0; o < weights.size(); ++o) {
+      const float frequency = frequencies[o];
+      const float weight = weights[o];
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = bx[i] * frequency;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = unipolar(noise1(sx[i], seed));
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        acc[i] += weight * sx[i];
+      }
+    }
+    std::copy(acc, acc + n, out + begin);
+  }
+}
+
+void Fbm::operator()(const float *x, const float *y, float *out,
+                     const std::size_t count) const {
+  float bx[blockSize];
+  float by[blockSize];
+  float sx[blockSize];
+  float sy[blockSize];
+  float acc[blockSize];
+  for (std::size_t begin = 0; begin < count; begin += blockSize) {
+    const std::size_t n = std::min(blockSize, count - begin);
+    // Copy first so out may alias an input
+    for (std::size_t i = 0; i < n; ++i) {
+      bx[i] = x[begin + i];
+      by[i] = y[begin + i];
+    }
+    std::fill(acc, acc + n, 0.f);
+    for (std::size_t o = 0; o < weights.size(); ++o) {
+      const float frequency = frequencies[o];
+      const float weight = weights[o];
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = bx[i] * frequency;
+        sy[i] = by[i] * frequency;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = unipolar(noise2(sx[i], sy[i], seed));
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        acc[i] += weight * sx[i];
+      }
+    }
+    std::copy(acc, acc + n, out + begin);
+  }
+}
+
+void Fbm::operator()(const float *x, const float *y, const float *z,
+                     float *out, const std::size_t count) const {
+  float bx[blockSize];
+  float by[blockSize];
+  float bz[blockSize];
+  float sx[blockSize];
+  float sy[blockSize];
+  float sz[blockSize];
+  float acc[blockSize];
+  for (std::size_t begin = 0; begin < count; begin += blockSize) {
+    const std::size_t n = std::min(blockSize, count - begin);
+    // Copy first so out may alias an input
+    for (std::size_t i = 0; i < n; ++i) {
+      bx[i] = x[begin + i];
+      by[i] = y[begin + i];
+      bz[i] = z[begin + i];
+    }
+    std::fill(acc, acc + n, 0.f);
+    for (std::size_t o = 0; o < weights.size(); ++o) {
+      const float frequency = frequencies[o];
+      const float weight = weights[o];
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = bx[i] * frequency;
+        sy[i] = by[i] * frequency;
+        sz[i] = bz[i] * frequency;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = unipolar(noise3(sx[i], sy[i], sz[i], seed));
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        acc[i] += weight * sx[i];
+      }
+    }
+    std::copy(acc, acc + n, out + begin);
+  }
+}
+
+void Fbm::operator()(const float *x, const float *y, const float *z,
+                     const float *w, float *out,
+                     const std::size_t count) const {
+  float bx[blockSize];
+  float by[blockSize];
+  float bz[blockSize];
+  float bw[blockSize];
+  float sx[blockSize];
+  float sy[blockSize];
+  float sz[blockSize];
+  float sw[blockSize];
+  float acc[blockSize];
+  for (std::size_t begin = 0; begin < count; begin += blockSize) {
+    const std::size_t n = std::min(blockSize, count - begin);
+    // Copy first so out may alias an input
+    for (std::size_t i = 0; i < n; ++i) {
+      bx[i] = x[begin + i];
+      by[i] = y[begin + i];
+      bz[i] = z[begin + i];
+      bw[i] = w[begin + i];
+    }
+    std::fill(acc, acc + n, 0.f);
+    for (std::size_t o = 0; o < weights.size(); ++o) {
+      const float frequency = frequencies[o];
+      const float weight = weights[o];
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = bx[i] * frequency;
+        sy[i] = by[i] * frequency;
+        sz[i] = bz[i] * frequency;
+        sw[i] = bw[i] * frequency;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        sx[i] = unipolar(noise4(sx[i], sy[i], sz[i], sw[i], seed));
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        acc[i] += weight * sx[i];
+      }
+    }
+    std::copy(acc, acc + n, out + begin);
+  }
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,265 @@
+#include "ofxCrvsNoiseField.h"
+
+#include <cmath>
+#include <mutex>
+
+#include "ofxCrvsRng.h"
+
+namespace ofxCrvs {
+
+namespace {
+
+// Finest spacing tried, relative to the highest octave's period
+constexpr int maxSamplesPerPeriod = 64;
+constexpr int numProbes = 512;
+
+inline int floorDiv(int a, int b) {
+  const int q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Lattice coordinates stay within this, so tile and sample indices can't
+// overflow an int
+constexpr float maxLattice = 1073741824.f;
+
+inline float clampLattice(const float g) {
+  // fmin and fmax also map NaN to a bound
+  return std::fmax(std::fmin(g, maxLattice), -maxLattice);
+}
+
+// splitmix64 finalizer over all three coordinates
+inline std::uint64_t tileHash(const std::array<int, 3> &coords) {
+  std::uint64_t h = static_cast<std::uint32_t>(coords[0]);
+  h = h << 32 | static_cast<std::uint32_t>(coords[1]);
+  h ^= static_cast<std::uint64_t>(static_cast<std::uint32_t>(coords[2])) *
+       0x9e3779b97f4a7c15ull;
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+  return h ^ (h >> 31);
+}
+
+// Catmull-Rom weights for the samples at -1, 0, 1, 2
+inline void cubicWeights(float t, float w[4]) {
+  const float t2 = t * t;
+  const float t3 = t2 * t;
+  w[0] = 0.5f * (-t3 + 2.f * t2 - t);
+  w[1] = 0.5f * (3.f * t3 - 5.f * t2 + 2.f);
+  w[2] = 0.5f * (-3.f * t3 + 4.f * t2 + t);
+  w[3] = 0.5f * (t3 - t2);
+}
+
+} // namespace
+
+NoiseField::NoiseField(const float falloff, const int octaves,
+                       const std::uint32_t seed, const float tolerance,
+                       const int tileSize, const std::size_t maxTiles)
+    : fbm(falloff, octaves, seed), tolerance(tolerance),
+      tileSize(std::max(tileSize, 1)), tileSamples(this->tileSize + 3),
+      slots2D((std::max<std::size_t>(maxTiles, 1) + ways - 1) / ways * ways),
+      slots3D(slots2D.size()) {
+  // Halve the spacing from four samples per period of the highest octave
+  // until the probes agree with Fbm.
+  const float period = std::ldexp(1.f, -std::max(octaves - 1, 0));
+  for (int samples = 4; samples <= maxSamplesPerPeriod; samples *= 2) {
+    spacing = period / samples;
+    invSpacing = 1.f / spacing;
+    clear();
+    if (maxProbeError() <= tolerance)
+      break;
+  }
+  clear();
+}
+
+float NoiseField::maxProbeError() const {
+  const float extent = tileSize * spacing;
+  float maxError = 0.f;
+  for (std::uint32_t i = 0; i < numProbes; ++i) {
+    const float x = Rng::uniform(i, 0, 0) * extent;
+    const float y = Rng::uniform(i, 1, 0) * extent;
+    const float z = Rng::uniform(i, 2, 0) * extent;
+    maxError = std::max(maxError, std::abs((*this)(x, y) - fbm(x, y)));
+    maxError = std::max(maxError, std::abs((*this)(x, y, z) - fbm(x, y, z)));
+  }
+  return maxError;
+}
+
+std::size_t NoiseField::getNumTiles() const {
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  std::size_t count = 0;
+  for (const vector<Slot> *slots : {&slots2D, &slots3D}) {
+    for (const Slot &slot : *slots)
+      count += slot.tile ? 1 : 0;
+  }
+  return count;
+}
+
+void NoiseField::clear() {
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  for (vector<Slot> *slots : {&slots2D, &slots3D}) {
+    for (Slot &slot : *slots) {
+      slot.tile.reset();
+      slot.lastUse.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+std::size_t NoiseField::setOf(const vector<Slot> &slots,
+                              const std::array<int, 3> &coords) const {
+  return tileHash(coords) % (slots.size() / ways) * ways;
+}
+
+std::shared_ptr<const NoiseField::Tile>
+NoiseField::find(const vector<Slot> &slots,
+                 const std::array<int, 3> &coords) const {
+  const std::size_t first = setOf(slots, coords);
+  std::shared_lock<std::shared_mutex> lock(mutex);
+  for (std::size_t i = first; i < first + ways; ++i) {
+    const Slot &slot = slots[i];
+    if (slot.tile && slot.coords == coords) {
+      slot.lastUse.store(fills.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+      return slot.tile;
+    }
+  }
+  return nullptr;
+}
+
+void NoiseField::store(vector<Slot> &slots, const std::array<int, 3> &coords,
+                       std::shared_ptr<const Tile> tile) const {
+  const std::size_t first = setOf(slots, coords);
+  const std::uint64_t now = fills.fetch_add(1, std::memory_order_relaxed) + 1;
+  std::unique_lock<std::shared_mutex> lock(mutex);
+  // An empty slot, the tile itself if another thread stored it meanwhile,
+  // or else the least recently used
+  Slot *victim = &slots[first];
+  for (std::size_t i = first; i < first + ways; ++i) {
+    Slot &slot = slots[i];
+    if (!slot.tile || slot.coords == coords) {
+      victim = &slot;
+      break;
+    }
+    if (slot.lastUse.load(std::memory_order_relaxed) <
+        victim->lastUse.load(std::memory_order_relaxed))
+      victim = &slot;
+  }
+  victim->coords = coords;
+  victim->tile = std::move(tile);
+  victim->lastUse.store(now, std::memory_order_relaxed);
+}
+
+std::shared_ptr<const NoiseField::Tile> NoiseField::tile2(const int tx,
+                                                          const int ty) const {
+  const std::array<int, 3> coords = {tx, ty, 0};
+  if (auto cached = find(slots2D, coords))
+    return cached;
+  // Fill outside the lock; a tile another thread stores meanwhile is
+  // simply replaced by this identical one.
+  const std::size_t count = tileSamples * tileSamples;
+  vector<float> xs(count);
+  vector<float> ys(count);
+  const int x0 = tx * tileSize - 1;
+  const int y0 = ty * tileSize - 1;
+  for (int j = 0; j < tileSamples; ++j) {
+    for (int i = 0; i < tileSamples; ++i) {
+      xs[j * tileSamples + i] = (x0 + i) * spacing;
+      ys[j * tileSamples + i] = (y0 + j) * spacing;
+    }
+  }
+  auto tile = std::make_shared<Tile>(count);
+  fbm(xs.data(), ys.data(), tile->data(), count);
+  store(slots2D, coords, tile);
+  return tile;
+}
+
+std::shared_ptr<const NoiseField::Tile>
+NoiseField::tile3(const int tx, const int ty, const int tz) const {
+  const std::array<int, 3> coords = {tx, ty, tz};
+  if (auto cached = find(slots3D, coords))
+    return cached;
+  const std::size_t plane = tileSamples * tileSamples;
+  const std::size_t count = plane * tileSamples;
+  vector<float> xs(count);
+  vector<float> ys(count);
+  vector<float> zs(count);
+  const int x0 = tx * tileSize - 1;
+  const int y0 = ty * tileSize - 1;
+  const int z0 = tz * tileSize - 1;
+  for (int k = 0; k < tileSamples; ++k) {
+    for (int j = 0; j < tileSamples; ++j) {
+      for (int i = 0; i < tileSamples; ++i) {
+        const std::size_t index = k * plane + j * tileSamples + i;
+        xs[index] = (x0 + i) * spacing;
+        ys[index] = (y0 + j) * spacing;
+        zs[index] = (z0 + k) * spacing;
+      }
+    }
+  }
+  auto tile = std::make_shared<Tile>(count);
+  fbm(xs.data(), ys.data(), zs.data(), tile->data(), count);
+  store(slots3D, coords, tile);
+  return tile;
+}
+
+float NoiseField::operator()(const float x, const float y) const {
+  const float gx = clampLattice(x * invSpacing);
+  const float gy = clampLattice(y * invSpacing);
+  const int ix = static_cast<int>(std::floor(gx));
+  const int iy = static_cast<int>(std::floor(gy));
+  const int tx = floorDiv(ix, tileSize);
+  const int ty = floorDiv(iy, tileSize);
+  const std::shared_ptr<const Tile> tile = tile2(tx, ty);
+  const Tile &values = *tile;
+  // Offset of the stencil's first sample within the tile
+  const int lx = ix - tx * tileSize;
+  const int ly = iy - ty * tileSize;
+  float wx[4];
+  float wy[4];
+  cubicWeights(gx - ix, wx);
+  cubicWeights(gy - iy, wy);
+  float result = 0.f;
+  for (int j = 0; j < 4; ++j) {
+    const float *row = values.data() + (ly + j) * tileSamples + lx;
+    result += wy[j] * (wx[0] * row[0] + wx[1] * row[1] + wx[2] * row[2] +
+                       wx[3] * row[3]);
+  }
+  return clampValue(result, 0.f, 1.f);
+}
+
+float NoiseField::operator()(const float x, const float y,
+                             const float z) const {
+  const float gx = clampLattice(x * invSpacing);
+  const float gy = clampLattice(y * invSpacing);
+  const float gz = clampLattice(z * invSpacing);
+  const int ix = static_cast<int>(std::floor(gx));
+  const int iy = static_cast<int>(std::floor(gy));
+  const int iz = static_cast<int>(std::floor(gz));
+  const int tx = floorDiv(ix, tileSize);
+  const int ty = floorDiv(iy, tileSize);
+  const int tz = floorDiv(iz, tileSize);
+  const std::shared_ptr<const Tile> tile = tile3(tx, ty, tz);
+  const Tile &values = *tile;
+  const int lx = ix - tx * tileSize;
+  const int ly = iy - ty * tileSize;
+  const int lz = iz - tz * tileSize;
+  float wx[4];
+  float wy[4];
+  float wz[4];
+  cubicWeights(gx - ix, wx);
+  cubicWeights(gy - iy, wy);
+  cubicWeights(gz - iz, wz);
+  const std::size_t plane = tileSamples * tileSamples;
+  float result = 0.f;
+  for (int k = 0; k < 4; ++k) {
+    float slice = 0.f;
+    for (int j = 0; j < 4; ++j) {
+      const float *row =
+          values.data() + (lz + k) * plane + (ly + j) * tileSamples + lx;
+      slice += wy[j] * (wx[0] * row[0] + wx[1] * row[1] + wx[2] * row[2] +
+                        wx[3] * row[3]);
+    }
+    result += wz[k] * slice;
+  }
+  return clampValue(result, 0.f, 1.f);
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef OFXCRVSNOISEFIELD_H
+#define OFXCRVSNOISEFIELD_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsNoise.h"
+
+namespace ofxCrvs {
+
+/**
+ * fBm cached on a regular lattice and read back with Catmull-Rom
+ * interpolation (bicubic in 2D, tricubic in 3D). Lattice tiles are filled
+ * with the block Fbm kernel the first time a lookup lands in them, so only
+ * the regions actually visited are computed. The lattice spacing is chosen
+ * at construction so that the interpolated field stays within tolerance of
+ * Fbm at a set of probe points.
+ *
+ * Tiles live in about maxTiles fixed slots per dimension, in sets of four
+ * picked by a hash of the tile's coordinates, so memory stays bounded
+ * however far lookups wander. A new tile replaces the least recently used
+ * one in its set, and an evicted tile is refilled when next needed.
+ * Coordinates beyond +-2^30 lattice steps are clamped.
+ *
+ * Lookups and clear() are safe from several threads.
+ */
+class NoiseField {
+public:
+  NoiseField(float falloff, int octaves, std::uint32_t seed = 0,
+             float tolerance = 1e-3f, int tileSize = 32,
+             std::size_t maxTiles = 256);
+
+  [[nodiscard]] float operator()(float x, float y) const;
+  [[nodiscard]] float operator()(float x, float y, float z) const;
+
+  [[nodiscard]] const Fbm &getFbm() const { return fbm; };
+  [[nodiscard]] float getSpacing() const { return spacing; };
+  [[nodiscard]] float getTolerance() const { return tolerance; };
+  [[nodiscard]] std::size_t getMaxTiles() const { return slots2D.size(); };
+  // Tiles currently held, 2D and 3D together
+  [[nodiscard]] std::size_t getNumTiles() const;
+  void clear();
+
+private:
+  using Tile = vector<float>;
+  struct Slot {
+    std::array<int, 3> coords{};
+    std::shared_ptr<const Tile> tile;
+    // Value of fills when the tile was last read
+    mutable std::atomic<std::uint64_t> lastUse{0};
+  };
+  static constexpr std::size_t ways = 4;
+
+  std::shared_ptr<const Tile> tile2(int tx, int ty) const;
+  std::shared_ptr<const Tile> tile3(int tx, int ty, int tz) const;
+  // First slot of the set coords belong to
+  std::size_t setOf(const vector<Slot> &slots,
+                    const std::array<int, 3> &coords) const;
+  // The cached tile at coords, or nullptr
+  std::shared_ptr<const Tile> find(const vector<Slot> &slots,
+                                   const std::array<int, 3> &coords) const;
+  void store(vector<Slot> &slots, const std::array<int, 3> &coords,
+             std::shared_ptr<const Tile> tile) const;
+  float maxProbeError() const;
+
+  Fbm fbm;
+  float tolerance;
+  int tileSize;
+  // Samples per tile edge, including the one-sample apron below and the
+  // two-sample apron above that the cubic stencil reads.
+  int tileSamples;
+  float spacing = 1.f;
+  float invSpacing = 1.f;
+
+  mutable std::shared_mutex mutex;
+  mutable vector<Slot> slots2D;
+  mutable vector<Slot> slots3D;
+  // Tiles filled so far, the clock for Slot::lastUse
+  mutable std::atomic<std::uint64_t> fills{0};
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSNOISEFIELD_H
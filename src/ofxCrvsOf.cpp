@@ -0,0 +1,249 @@
+#include "ofxCrvsOf.h"
+
+#include <stdexcept>
+#include <type_traits>
+
+#include "ofxCrvsOpRegistry.h"
+
+namespace ofxCrvs {
+
+namespace {
+
+glm::vec2 windowSize() {
+  return glm::vec2(static_cast<float>(ofGetWidth()),
+                   static_cast<float>(ofGetHeight()));
+}
+
+// Runs when the adapter is linked in, before main()
+const bool installed = [] {
+  setViewSizeSource(&windowSize);
+  OpRegistry::add("mouseX", 0, 0,
+                  [](const Ops &, const vector<FloatOp> &,
+                     const vector<float> &) { return mouseX(); });
+  OpRegistry::add("mouseY", 0, 0,
+                  [](const Ops &, const vector<FloatOp> &,
+                     const vector<float> &) { return mouseY(); });
+  return true;
+}();
+
+// ofIndexType is narrower than IndexType on GLES, so indices are copied
+// there. A template, so the branch not taken is never instantiated.
+template <typename Index>
+void setIndexData(ofVbo &vbo, const std::vector<Index> &indices) {
+  const int count = static_cast<int>(indices.size());
+  if constexpr (std::is_same_v<Index, ofIndexType>) {
+    vbo.setIndexData(indices.data(), count, GL_STATIC_DRAW);
+  } else {
+    const std::vector<ofIndexType> narrowed(indices.begin(), indices.end());
+    vbo.setIndexData(narrowed.data(), count, GL_STATIC_DRAW);
+  }
+}
+
+} // namespace
+
+vector<ofVec3f> ofv3Array(const Crv &crv, int numPoints, bool boxed,
+                          bool transformed, FloatOp samplingRateOp) {
+  vector<ofVec3f> vectors(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    float x = static_cast<float>(i) / (numPoints - 1);
+    if (samplingRateOp)
+      x = samplingRateOp(x);
+    glm::vec3 v;
+    if (boxed)
+      v = crv.wVector(x, transformed);
+    else
+      v = crv.uVector(x, transformed);
+    vectors[i] = ofVec3f(v.x, v.y, v.z);
+  }
+  return vectors;
+}
+
+vector<ofVec2f> ofv2Array(const Crv &crv, int numPoints, bool boxed,
+                          bool transformed, FloatOp samplingRateOp) {
+  vector<ofVec2f> vectors(numPoints);
+  for (int i = 0; i < numPoints; ++i) {
+    float x = static_cast<float>(i) / (numPoints - 1);
+    if (samplingRateOp)
+      x = samplingRateOp(x);
+    glm::vec3 v;
+    if (boxed)
+      v = crv.wVector(x, transformed);
+    else
+      v = crv.uVector(x, transformed);
+    vectors[i] = ofVec2f(v.x, v.y);
+  }
+  return vectors;
+}
+
+ofPolyline polyline(const Crv &crv, int numPoints, bool boxed,
+                    bool transformed, FloatOp samplingRateOp) {
+  vector<glm::vec3> vectors =
+      crv.glv3Array(numPoints, boxed, transformed, std::move(samplingRateOp));
+  ofPolyline polyline;
+  polyline.addVertices(vectors);
+  return polyline;
+}
+
+ofPolyline adaptivePolyline(const Crv &crv, float tolerance, bool boxed,
+                            bool transformed, int maxDepth,
+                            int maxVertices) {
+  ofPolyline polyline;
+  polyline.addVertices(crv.adaptiveArray(tolerance, boxed, transformed,
+                                         maxDepth, maxVertices));
+  return polyline;
+}
+
+vector<ofVec2f> ofv2Array(const FloatOp curve, const float start,
+                          const float end, const int numPoints,
+                          const float yScale) {
+  vector<ofVec2f> points(numPoints);
+  const float step = (end - start) / numPoints;
+  const float modEnd = end - (step - 1);
+  for (int i = 0; i < numPoints; ++i) {
+    const float x = start + (i * step);
+    const float y = curve(x / modEnd);
+    points[i] = ofVec2f(x, ofGetHeight() - (y * yScale));
+  }
+  return points;
+}
+
+vector<ofVec3f> ofv3Array(const FloatOp curve, const float start,
+                          const float end, const int numPoints,
+                          const float yScale) {
+  vector<ofVec3f> points(numPoints);
+  const float step = (end - start) / numPoints;
+  const float modEnd = end - (step - 1);
+  for (int i = 0; i < numPoints; ++i) {
+    const float x = start + (i * step);
+    const float y = curve(x / modEnd);
+    points[i] = ofVec3f(x, ofGetHeight() - (y * yScale), 0.f);
+  }
+  return points;
+}
+
+void plot(const FloatOp op, const float yScale, const ofColor color,
+          const bool fill) {
+  ofPushStyle();
+  ofSetColor(color);
+  ofSetLineWidth(1);
+  if (fill)
+    ofFill();
+  else
+    ofNoFill();
+  const float width = ofGetWidth();
+  const vector<glm::vec2> points =
+      Ops().glv2Array(op, 0.f, width, width, yScale);
+  ofBeginShape();
+  for (auto point : points) {
+    ofVertex(point);
+  }
+  ofEndShape();
+  ofPopStyle();
+}
+
+FloatOp mouseX() {
+  return [](const float) { return static_cast<float>(ofGetMouseX()); };
+}
+
+FloatOp mouseY() {
+  return [](const float) { return static_cast<float>(ofGetMouseY()); };
+}
+
+void toMesh(const Srfc &srfc, ofMesh &mesh) {
+  const std::vector<Srfc::Vertex> &vertices = srfc.getVertices();
+  const std::vector<IndexType> &indices = srfc.getIndices();
+  mesh.clear();
+  mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+  std::vector<glm::vec3> positions(vertices.size());
+  std::vector<glm::vec3> normals(vertices.size());
+  std::vector<glm::vec2> texCoords(vertices.size());
+  for (std::size_t i = 0; i < vertices.size(); ++i) {
+    positions[i] = vertices[i].position;
+    normals[i] = vertices[i].normal;
+    texCoords[i] = vertices[i].texCoord;
+  }
+  mesh.addVertices(positions);
+  mesh.addNormals(normals);
+  mesh.addTexCoords(texCoords);
+  mesh.addIndices(std::vector<ofIndexType>(indices.begin(), indices.end()));
+}
+
+void toVbo(const Srfc &srfc, ofVbo &vbo, int usage) {
+  const int total = srfc.getNumVertices();
+  vbo.setVertexData(srfc.getPositionData(), 3, total, usage, Srfc::stride);
+  vbo.setNormalData(srfc.getNormalData(), total, usage, Srfc::stride);
+  vbo.setTexCoordData(srfc.getTexCoordData(), total, GL_STATIC_DRAW,
+                      Srfc::stride);
+  setIndexData(vbo, srfc.getIndices());
+}
+
+void updateVbo(const Srfc &srfc, ofVbo &vbo) {
+  const int total = srfc.getNumVertices();
+  vbo.updateVertexData(srfc.getPositionData(), total);
+  vbo.updateNormalData(srfc.getNormalData(), total);
+}
+
+ofBoxPrimitive toBoxPrimitive(const Box &box) {
+  ofBoxPrimitive primitive;
+  primitive.set(box.getWidth(), box.getHeight(), box.getDepth());
+  primitive.setPosition(box.getPosition());
+  primitive.setOrientation(box.getOrientationQuat());
+  primitive.setScale(box.getScale());
+  return primitive;
+}
+
+VboVertexTarget::~VboVertexTarget() {
+  if (fence)
+    glDeleteSync(fence);
+}
+
+void VboVertexTarget::waitForGpu() {
+  if (!fence)
+    return;
+  while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) ==
+         GL_TIMEOUT_EXPIRED) {
+  }
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+glm::vec3 *VboVertexTarget::map(const std::size_t capacity) {
+  if (capacity > allocated || allocated == 0) {
+    // Fresh storage; nothing the GPU reads can be overwritten
+    allocated = std::max<std::size_t>(capacity, 1);
+    buffer.allocate(allocated * sizeof(glm::vec3), GL_STREAM_DRAW);
+    vbo.setVertexBuffer(buffer, 3, sizeof(glm::vec3));
+    if (fence)
+      glDeleteSync(fence);
+    fence = nullptr;
+  } else {
+    waitForGpu();
+  }
+  void *data = buffer.mapRange(0, allocated * sizeof(glm::vec3),
+                               GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                   GL_MAP_INVALIDATE_RANGE_BIT);
+  if (!data)
+    throw std::runtime_error("VboVertexTarget: glMapBufferRange failed");
+  return static_cast<glm::vec3 *>(data);
+}
+
+void VboVertexTarget::commit(const std::size_t count) {
+  buffer.unmap();
+  committed = std::min(count, allocated);
+}
+
+void VboVertexTarget::draw(const int mode) {
+  if (committed == 0)
+    return;
+  vbo.draw(mode, 0, static_cast<int>(committed));
+  if (fence)
+    glDeleteSync(fence);
+  fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+VertexStream gpuVertexStream() {
+  return VertexStream(std::make_unique<VboVertexTarget>(),
+                      std::make_unique<VboVertexTarget>());
+}
+
+} // namespace ofxCrvs
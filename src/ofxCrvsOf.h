@@ -0,0 +1,100 @@
+#pragma once
+
+#ifndef OFXCRVSOF_H
+#define OFXCRVSOF_H
+
+/**
+ * The openFrameworks adapter: everything that needs ofMain.h, kept out of
+ * the core so the core builds against glm and the standard library alone.
+ * Linking it also points getViewWidth()/getViewHeight() at the window, so
+ * default Boxes and Ops::appWidth/appHeight track the window size, and
+ * registers mouseX and mouseY with OpRegistry.
+ */
+
+#include <cstddef>
+
+#include "ofMain.h"
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsBox.hpp"
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsSrfc.h"
+#include "ofxCrvsVertexStream.h"
+
+namespace ofxCrvs {
+
+// Crv::glv3Array()/glv2Array() as ofVec3f/ofVec2f
+std::vector<ofVec3f> ofv3Array(const Crv &crv, int numPoints, bool boxed,
+                               bool transformed,
+                               FloatOp samplingRateOp = FloatOp());
+std::vector<ofVec2f> ofv2Array(const Crv &crv, int numPoints, bool boxed,
+                               bool transformed,
+                               FloatOp samplingRateOp = FloatOp());
+ofPolyline polyline(const Crv &crv, int numPoints, bool boxed,
+                    bool transformed, FloatOp samplingRateOp = FloatOp());
+// Crv::adaptiveArray() as a polyline
+ofPolyline adaptivePolyline(const Crv &crv, float tolerance, bool boxed,
+                            bool transformed, int maxDepth = 16,
+                            int maxVertices = 0);
+
+// Ops::glv2Array()/glv3Array() as ofVec2f/ofVec3f, flipped to the window
+[[nodiscard]] vector<ofVec2f> ofv2Array(const FloatOp curve, float start,
+                                        float end, int numPoints,
+                                        float yScale = 1.0f);
+[[nodiscard]] vector<ofVec3f> ofv3Array(const FloatOp curve, float start,
+                                        float end, int numPoints,
+                                        float yScale = 1.0f);
+// Draws op across the window's width
+void plot(const FloatOp op, float yScale, ofColor color = ofColor::white,
+          bool fill = false);
+
+// The mouse position in pixels, whatever pos
+[[nodiscard]] FloatOp mouseX();
+[[nodiscard]] FloatOp mouseY();
+
+void toMesh(const Srfc &srfc, ofMesh &mesh);
+void toVbo(const Srfc &srfc, ofVbo &vbo, int usage = GL_DYNAMIC_DRAW);
+// Refreshes positions and normals of a vbo filled by toVbo()
+void updateVbo(const Srfc &srfc, ofVbo &vbo);
+
+// box's size and transform on an ofBoxPrimitive, e.g. to draw it
+[[nodiscard]] ofBoxPrimitive toBoxPrimitive(const Box &box);
+
+/**
+ * GPU vertex buffer written through glMapBufferRange. The mapping is
+ * unsynchronized, so the driver never stalls or copies; instead draw()
+ * places a fence, and the next map() waits on it, which in a VertexStream
+ * means waiting on the frame before last. Draw it through draw() or bind
+ * getVbo() yourself; getVbo() has this buffer as its vertex attribute.
+ */
+class VboVertexTarget : public VertexTarget {
+public:
+  VboVertexTarget() = default;
+  ~VboVertexTarget() override;
+
+  VboVertexTarget(const VboVertexTarget &) = delete;
+  VboVertexTarget &operator=(const VboVertexTarget &) = delete;
+
+  [[nodiscard]] glm::vec3 *map(std::size_t capacity) override;
+  void commit(std::size_t count) override;
+  [[nodiscard]] std::size_t size() const override { return committed; };
+
+  void draw(int mode = GL_LINE_STRIP);
+  [[nodiscard]] ofVbo &getVbo() { return vbo; };
+
+private:
+  void waitForGpu();
+
+  ofBufferObject buffer;
+  ofVbo vbo;
+  std::size_t allocated = 0;
+  std::size_t committed = 0;
+  GLsync fence = nullptr;
+};
+
+// A VertexStream of two VboVertexTargets; needs a GL context
+[[nodiscard]] VertexStream gpuVertexStream();
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSOF_H
@@ -0,0 +1,347 @@
+#include "ofxCrvsOpRegistry.h"
+
+#include <cmath>
+#include <map>
+#include <shared_mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+namespace ofxCrvs {
+
+namespace {
+
+struct Overload {
+  int numChildren;
+  int numParams;
+  int minChildren;
+  OpFactory factory;
+};
+
+struct Registry {
+  std::shared_mutex mutex;
+  std::map<std::string, vector<Overload>> overloads;
+};
+
+template <typename... Args> using Method = FloatOp (Ops::*)(Args...) const;
+
+template <typename T> constexpr bool isOp = std::is_same_v<T, FloatOp>;
+template <typename T>
+constexpr bool isOps = std::is_same_v<T, vector<FloatOp>>;
+template <typename T>
+constexpr bool isFloats = std::is_same_v<T, vector<float>>;
+
+// Hands out a call's children and params to a factory's arguments in order
+struct Cursor {
+  const vector<FloatOp> &children;
+  const vector<float> &params;
+  // FloatOp arguments after the vector of them, which it must leave
+  std::size_t opsAfterVector;
+  std::size_t child = 0;
+  std::size_t param = 0;
+
+  template <typename T> T take() {
+    if constexpr (isOp<T>) {
+      return child < children.size() ? children[child++] : FloatOp();
+    } else if constexpr (isOps<T>) {
+      const std::size_t end = children.size() - opsAfterVector;
+      T ops(children.begin() + child, children.begin() + end);
+      child = end;
+      return ops;
+    } else if constexpr (isFloats<T>) {
+      T values(params.begin() + param, params.end());
+      param = params.size();
+      return values;
+    } else if constexpr (std::is_integral_v<T>) {
+      return static_cast<T>(std::lround(params[param++]));
+    } else {
+      return static_cast<T>(params[param++]);
+    }
+  }
+};
+
+template <typename... Args>
+void add(std::map<std::string, vector<Overload>> &overloads,
+         const std::string &name, const Method<Args...> method,
+         const int minChildren = OpRegistry::any) {
+  static_assert(((isOp<std::decay_t<Args>> || isOps<std::decay_t<Args>> ||
+                  isFloats<std::decay_t<Args>> ||
+                  std::is_arithmetic_v<std::decay_t<Args>>) &&
+                 ...),
+                "OpRegistry: unsupported argument type");
+  constexpr int ops = (0 + ... + (isOp<std::decay_t<Args>> ? 1 : 0));
+  constexpr bool variadicOps = (false || ... || isOps<std::decay_t<Args>>);
+  constexpr int numbers =
+      (0 + ... + (std::is_arithmetic_v<std::decay_t<Args>> ? 1 : 0));
+  constexpr bool variadicNumbers =
+      (false || ... || isFloats<std::decay_t<Args>>);
+  // Only FloatOps after a vector of them; registrations below keep it so
+  constexpr std::size_t opsAfterVector = variadicOps ? ops : 0;
+  OpFactory factory = [method](const Ops &self,
+                               const vector<FloatOp> &children,
+                               const vector<float> &params) {
+    Cursor cursor{children, params, opsAfterVector};
+    // Braced initialization takes the arguments in order
+    std::tuple<std::decay_t<Args>...> args{
+        cursor.take<std::decay_t<Args>>()...};
+    static_cast<void>(cursor);
+    return std::apply(
+        [&](const auto &...values) { return (self.*method)(values...); },
+        args);
+  };
+  auto &list = overloads[name];
+  const int numChildren = variadicOps ? OpRegistry::any : ops;
+  const int numParams = variadicNumbers ? OpRegistry::any : numbers;
+  for (const Overload &overload : list) {
+    // Already covered by an overload registered earlier
+    if (overload.numChildren == numChildren &&
+        overload.numParams == numParams)
+      return;
+  }
+  // A vector of FloatOps may be empty, but the ones after it are required
+  list.push_back({numChildren, numParams,
+                  minChildren == OpRegistry::any ? ops : minChildren,
+                  std::move(factory)});
+}
+
+std::map<std::string, vector<Overload>> builtIns() {
+  std::map<std::string, vector<Overload>> r;
+  using F = FloatOp;
+  using Fs = vector<FloatOp>;
+
+  // Constants
+  add(r, "zero", &Ops::zero);
+  add(r, "fourth", &Ops::fourth);
+  add(r, "third", &Ops::third);
+  add(r, "half", &Ops::half);
+  add(r, "one", &Ops::one);
+  add(r, "two", &Ops::two);
+  add(r, "three", &Ops::three);
+  add(r, "four", &Ops::four);
+  add(r, "quarterPi", &Ops::quarterPi);
+  add(r, "thirdPi", &Ops::thirdPi);
+  add(r, "halfPi", &Ops::halfPi);
+  add(r, "pi", &Ops::pi);
+  add(r, "twoPi", &Ops::twoPi);
+  add(r, "appWidth", &Ops::appWidth);
+  add(r, "appHeight", &Ops::appHeight);
+  add(r, "c", &Ops::c);
+
+  // Oscillators and shapes
+  add(r, "bipolarize", &Ops::bipolarize);
+  add(r, "rectify", &Ops::rectify);
+  add(r, "timePhasor", &Ops::timePhasor);
+  add(r, "tempoPhasor", &Ops::tempoPhasor);
+  add(r, "phasor", &Ops::phasor);
+  add(r, "saw", &Ops::saw);
+  for (const auto &[name, op, none, number] :
+       {std::make_tuple("tri", Method<F>(&Ops::tri), Method<>(&Ops::tri),
+                        Method<float>(&Ops::tri)),
+        std::make_tuple("sine", Method<F>(&Ops::sine), Method<>(&Ops::sine),
+                        Method<float>(&Ops::sine)),
+        std::make_tuple("cos", Method<F>(&Ops::cos), Method<>(&Ops::cos),
+                        Method<float>(&Ops::cos)),
+        std::make_tuple("tan", Method<F>(&Ops::tan), Method<>(&Ops::tan),
+                        Method<float>(&Ops::tan)),
+        std::make_tuple("easeIn", Method<F>(&Ops::easeIn),
+                        Method<>(&Ops::easeIn), Method<float>(&Ops::easeIn)),
+        std::make_tuple("easeOut", Method<F>(&Ops::easeOut),
+                        Method<>(&Ops::easeOut),
+                        Method<float>(&Ops::easeOut)),
+        std::make_tuple("easeInOut", Method<F>(&Ops::easeInOut),
+                        Method<>(&Ops::easeInOut),
+                        Method<float>(&Ops::easeInOut)),
+        std::make_tuple("easeOutIn", Method<F>(&Ops::easeOutIn),
+                        Method<>(&Ops::easeOutIn),
+                        Method<float>(&Ops::easeOutIn))}) {
+    add(r, name, op);
+    add(r, name, none);
+    add(r, name, number);
+  }
+  add(r, "sineFb", Method<F>(&Ops::sineFb));
+  add(r, "sineFb", Method<float>(&Ops::sineFb));
+  add(r, "asin", &Ops::asin);
+  add(r, "acos", &Ops::acos);
+
+  // Tables and envelopes; the op tables need one op to index
+  add(r, "lookup", Method<vector<float>>(&Ops::lookup));
+  add(r, "lookup", Method<Fs>(&Ops::lookup), 1);
+  add(r, "wt", Method<vector<float>>(&Ops::wt));
+  add(r, "wt", Method<Fs>(&Ops::wt), 1);
+  add(r, "wt", Method<vector<float>, F>(&Ops::wt));
+  add(r, "env", &Ops::env);
+  add(r, "timeseries", Method<vector<float>>(&Ops::timeseries));
+
+  // Random and noise
+  add(r, "gaussian", Method<F, F>(&Ops::gaussian));
+  add(r, "gaussian", Method<F>(&Ops::gaussian));
+  add(r, "gaussian", Method<>(&Ops::gaussian));
+  add(r, "random", Method<F, F, F>(&Ops::random));
+  add(r, "random", Method<>(&Ops::random));
+  add(r, "random", Method<F>(&Ops::random));
+  add(r, "random", Method<float>(&Ops::random));
+  add(r, "perlin", Method<F, F, F, F, F>(&Ops::perlin), 1);
+  add(r, "perlin", Method<F, F, F, float, int>(&Ops::perlin), 1);
+  add(r, "cachedPerlin", &Ops::cachedPerlin, 1);
+  add(r, "fuzz", &Ops::fuzz);
+
+  // Basic ops
+  add(r, "abs", &Ops::abs);
+  add(r, "diff", &Ops::diff);
+  add(r, "mult", &Ops::mult);
+  for (const auto &[name, op, number] :
+       {std::make_tuple("bias", Method<F, F>(&Ops::bias),
+                        Method<F, float>(&Ops::bias)),
+        std::make_tuple("phase", Method<F, F>(&Ops::phase),
+                        Method<F, float>(&Ops::phase)),
+        std::make_tuple("rate", Method<F, F>(&Ops::rate),
+                        Method<F, float>(&Ops::rate)),
+        std::make_tuple("fold", Method<F, F>(&Ops::fold),
+                        Method<F, float>(&Ops::fold)),
+        std::make_tuple("greater", Method<F, F>(&Ops::greater),
+                        Method<F, float>(&Ops::greater)),
+        std::make_tuple("less", Method<F, F>(&Ops::less),
+                        Method<F, float>(&Ops::less)),
+        std::make_tuple("equal", Method<F, F>(&Ops::equal),
+                        Method<F, float>(&Ops::equal)),
+        std::make_tuple("notEqual", Method<F, F>(&Ops::notEqual),
+                        Method<F, float>(&Ops::notEqual))}) {
+    add(r, name, op);
+    add(r, name, number);
+  }
+  add(r, "fold", Method<F>(&Ops::fold));
+  add(r, "ring", &Ops::ring);
+  add(r, "wrap", Method<F, float, float>(&Ops::wrap));
+  add(r, "wrap", Method<F, F, F>(&Ops::wrap));
+  add(r, "lpf", &Ops::lpf);
+  add(r, "lpFb", &Ops::lpFb);
+  add(r, "ampFb", &Ops::ampFb, 0);
+  add(r, "morph", Method<F, F, F>(&Ops::morph));
+  add(r, "morph", Method<Fs, F>(&Ops::morph), 2);
+
+  // Vector ops; those indexing into the vector need one op in it
+  add(r, "chain", &Ops::chain);
+  add(r, "choose", &Ops::choose, 1);
+  add(r, "mix", Method<Fs>(&Ops::mix));
+  add(r, "mix", Method<Fs, vector<float>>(&Ops::mix));
+  add(r, "sum", &Ops::sum);
+  add(r, "product", &Ops::product);
+  add(r, "min", &Ops::min);
+  add(r, "max", &Ops::max);
+  add(r, "mean", &Ops::mean);
+  add(r, "median", &Ops::median, 1);
+  add(r, "variance", &Ops::variance);
+  add(r, "stdDev", &Ops::stdDev);
+  add(r, "smooth", &Ops::smooth);
+  add(r, "smoother", &Ops::smoother);
+  add(r, "ema", Method<float>(&Ops::ema));
+  add(r, "ema", Method<F>(&Ops::ema));
+
+  // Digital ops
+  add(r, "pulse", Method<F>(&Ops::pulse), 0);
+  add(r, "pulse", Method<float>(&Ops::pulse));
+  add(r, "square", &Ops::square);
+  add(r, "crossed", &Ops::crossed);
+  add(r, "trendFlip", &Ops::trendFlip);
+  for (const auto &[name, op, number] :
+       {std::make_tuple("and", Method<F, F, F>(&Ops::and_),
+                        Method<F, F, float>(&Ops::and_)),
+        std::make_tuple("or", Method<F, F, F>(&Ops::or_),
+                        Method<F, F, float>(&Ops::or_)),
+        std::make_tuple("xor", Method<F, F, F>(&Ops::xor_),
+                        Method<F, F, float>(&Ops::xor_)),
+        std::make_tuple("nand", Method<F, F, F>(&Ops::nand),
+                        Method<F, F, float>(&Ops::nand)),
+        std::make_tuple("nor", Method<F, F, F>(&Ops::nor),
+                        Method<F, F, float>(&Ops::nor)),
+        std::make_tuple("xnor", Method<F, F, F>(&Ops::xnor),
+                        Method<F, F, float>(&Ops::xnor))}) {
+    add(r, name, op);
+    add(r, name, number);
+  }
+  add(r, "not", &Ops::not_);
+  add(r, "in", Method<F, float, float>(&Ops::in));
+  add(r, "in", Method<F, F, F>(&Ops::in));
+  add(r, "out", Method<F, float, float>(&Ops::out));
+  add(r, "out", Method<F, F, F>(&Ops::out));
+  return r;
+}
+
+Registry &registry() {
+  static Registry instance{{}, builtIns()};
+  return instance;
+}
+
+bool accepts(const int count, const int expected) {
+  return expected == OpRegistry::any || count == expected;
+}
+
+} // namespace
+
+void OpRegistry::add(const std::string &name, const int numChildren,
+                     const int numParams, OpFactory factory,
+                     const int minChildren) {
+  if (!factory)
+    throw std::invalid_argument("OpRegistry: null factory for " + name);
+  Registry &r = registry();
+  std::unique_lock<std::shared_mutex> lock(r.mutex);
+  vector<Overload> &list = r.overloads[name];
+  const Overload overload{numChildren, numParams,
+                          minChildren == any ? numChildren : minChildren,
+                          std::move(factory)};
+  for (Overload &existing : list) {
+    if (existing.numChildren == numChildren &&
+        existing.numParams == numParams) {
+      existing = overload;
+      return;
+    }
+  }
+  list.push_back(overload);
+}
+
+bool OpRegistry::contains(const std::string &name) {
+  Registry &r = registry();
+  std::shared_lock<std::shared_mutex> lock(r.mutex);
+  return r.overloads.count(name) > 0;
+}
+
+FloatOp OpRegistry::build(const Ops &ops, const std::string &name,
+                          const vector<FloatOp> &children,
+                          const vector<float> &params) {
+  OpFactory factory;
+  {
+    Registry &r = registry();
+    std::shared_lock<std::shared_mutex> lock(r.mutex);
+    const auto it = r.overloads.find(name);
+    if (it == r.overloads.end())
+      throw std::invalid_argument("OpRegistry: no op named " + name);
+    const int numChildren = static_cast<int>(children.size());
+    const int numParams = static_cast<int>(params.size());
+    // An exact match first, then one with trailing children left out
+    for (const bool exact : {true, false}) {
+      for (const Overload &overload : it->second) {
+        if (!accepts(numParams, overload.numParams))
+          continue;
+        // Never fewer than it needs, e.g. the op after a vector of them
+        if (numChildren < overload.minChildren)
+          continue;
+        const bool fits = exact ? accepts(numChildren, overload.numChildren)
+                                : overload.numChildren != any &&
+                                      numChildren < overload.numChildren;
+        if (fits) {
+          factory = overload.factory;
+          break;
+        }
+      }
+      if (factory)
+        break;
+    }
+    if (!factory)
+      throw std::invalid_argument(
+          "OpRegistry: " + name + " takes no " + std::to_string(numChildren) +
+          " children and " + std::to_string(numParams) + " params");
+  }
+  return factory(ops, children, params);
+}
+
+} // namespace ofxCrvs
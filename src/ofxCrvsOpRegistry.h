@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef OFXCRVSOPREGISTRY_H
+#define OFXCRVSOPREGISTRY_H
+
+#include <string>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsOps.h"
+
+namespace ofxCrvs {
+
+// Builds an op from its child ops and numeric parameters
+using OpFactory = std::function<FloatOp(const Ops &ops,
+                                        const vector<FloatOp> &children,
+                                        const vector<float> &params)>;
+
+/**
+ * Ops factories by name, so a Graph can save an op as its factory name,
+ * parameters and children and rebuild it on load. Every Ops factory whose
+ * arguments are FloatOps, numbers or vectors of them is registered under
+ * its method name: FloatOp arguments are taken from the children in order
+ * and number arguments from the params, and a vector takes whatever is
+ * left, at least one op where the factory indexes into it. Overloads are
+ * told apart by how many children and params they take; where two can't
+ * be, only the first is registered. Factories taking filters, streams,
+ * fields, breakpoints or nested tables aren't.
+ *
+ * Safe to use from several threads.
+ */
+class OpRegistry {
+public:
+  static constexpr int any = -1;
+
+  // Adds an overload of name taking numChildren children and numParams
+  // params, either of which may be any; replaces one taking the same
+  // counts. minChildren below numChildren lets trailing children be left
+  // out, and passes them as empty FloatOps; with numChildren any it is the
+  // fewest children the factory accepts.
+  static void add(const std::string &name, int numChildren, int numParams,
+                  OpFactory factory, int minChildren = any);
+  [[nodiscard]] static bool contains(const std::string &name);
+  // Throws std::invalid_argument for an unknown name, or if no overload
+  // takes that many children and params, fewer than minChildren included
+  [[nodiscard]] static FloatOp build(const Ops &ops, const std::string &name,
+                                     const vector<FloatOp> &children,
+                                     const vector<float> &params);
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSOPREGISTRY_H
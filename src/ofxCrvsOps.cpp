@@ -1,10 +1,34 @@
 
 #include "ofxCrvsOps.h"
 
+#include "ofxCrvsBreakpoints.h"
+#include "ofxCrvsClock.h"
+#include "ofxCrvsFilter.h"
+#include "ofxCrvsNoise.h"
+#include "ofxCrvsNoiseField.h"
+#include "ofxCrvsProfiler.h"
+#include "ofxCrvsStrm.h"
+#include "ofxCrvsRng.h"
+
 namespace ofxCrvs {
 
+std::uint32_t Ops::nextInstance() {
+  static std::atomic<std::uint32_t> instances{seededInstance + 1};
+  std::uint32_t id;
+  do {
+    id = instances.fetch_add(1, std::memory_order_relaxed);
+  } while (id == seededInstance);
+  return id;
+}
+
+std::uint32_t Ops::nextStream() const {
+  const std::uint32_t count =
+      streamCount.fetch_add(1, std::memory_order_relaxed);
+  return Rng::hash(count ^ Rng::hash(instance + 0x9e3779b9u));
+}
+
 float Ops::pos2Rad(const float pos) {
-  return ofDegToRad(ofClamp(pos, 0.f, 1.f) * 360.f);
+  return degToRad(clampValue(pos, 0.f, 1.f) * 360.f);
 }
 
 FloatOp Ops::bipolarize(const FloatOp unipolarOp) const {
@@ -23,12 +47,7 @@ FloatOp Ops::timePhasor(const double cycleDurationSeconds) const {
   if (cycleDurationSeconds <= 0.0) {
     throw std::invalid_argument("cycleDurationSeconds must be greater than 0");
   }
-  double cycleDurationMicros = cycleDurationSeconds * 1000000.0;
-  return [cycleDurationMicros](const float) {
-    return fmod(static_cast<double>(ofGetElapsedTimeMicros()),
-                cycleDurationMicros) /
-           cycleDurationMicros;
-  };
+  return clockPhasor(cycleDurationSeconds * 1000000.0);
 }
 
 FloatOp Ops::tempoPhasor(const double barsPerCycle, const double bpm) const {
@@ -49,12 +68,22 @@ FloatOp Ops::tempoPhasor(const double barsPerCycle, const double bpm) const {
   const double cycleDurationSecs = barDurationSecs * barsPerCycle;
 
   // Convert cycle duration from seconds to microseconds
-  const double cycleDurationMicros = cycleDurationSecs * 1000000.0;
+  return clockPhasor(cycleDurationSecs * 1000000.0);
+}
 
-  return [cycleDurationMicros](const float) {
-    return fmod(static_cast<double>(ofGetElapsedTimeMicros()),
-                cycleDurationMicros) /
-           cycleDurationMicros;
+FloatOp Ops::clockPhasor(const double cycleDurationMicros) const {
+  if (!clock) {
+    return [cycleDurationMicros](const float) {
+      return fmod(static_cast<double>(elapsedMicros()),
+                  cycleDurationMicros) /
+             cycleDurationMicros;
+    };
+  }
+  return [clock = clock, cycleDurationMicros](const float) {
+    // Manual and synced clocks can be set before zero
+    const double phase =
+        fmod(clock->micros(), cycleDurationMicros) / cycleDurationMicros;
+    return phase < 0.0 ? phase + 1.0 : phase;
   };
 }
 
@@ -280,26 +309,17 @@ FloatOp Ops::env(const float attackLength, const float attackLevel,
 }
 
 FloatOp Ops::breakpoints(const vector<vector<float>> points) const {
-  return [points](const float pos) {
-    for (int i = 0; i < points.size(); ++i) {
-      if (pos < points[i][0]) {
-        if (i == 0)
-          return points[i][1];
-        const float prevPos = points[i - 1][0];
-        const float prevVal = points[i - 1][1];
-        const float nextPos = points[i][0];
-        const float nextVal = points[i][1];
-        const float fraction = (pos - prevPos) / (nextPos - prevPos);
-        return prevVal + (fraction * (nextVal - prevVal));
-      }
-    }
-    return 0.f;
-  };
+  return breakpoints(Breakpoints(points));
+}
+
+FloatOp Ops::breakpoints(const Breakpoints &points) const {
+  return [table = std::make_shared<const Breakpoints>(points)](
+             const float pos) { return (*table)(pos); };
 }
 
 FloatOp Ops::gaussian(const FloatOp lo, const FloatOp hi) const {
-  return [lo, hi](const float pos) {
-    float g = ofRandomGaussian(0.f, 1.f);
+  return [lo, hi, stream = nextStream(), seed = seed](const float pos) {
+    float g = Rng::gaussian(Rng::key(pos), stream, seed);
     if (g < -1.f)
       g = fmod(g, -1.f);
     else if (g > 1.f)
@@ -313,29 +333,34 @@ FloatOp Ops::gaussian(const FloatOp lo, const FloatOp hi) const {
 
 FloatOp Ops::random(const FloatOp lo, const FloatOp hi,
                     const FloatOp mode) const {
-  return [lo, hi, mode, this](const float pos) {
+  return [lo, hi, mode, stream = nextStream(), seed = seed](const float pos) {
     const float loVal = lo ? lo(pos) : 0.f;
     const float hiVal = hi ? hi(pos) : 1.f;
-    float modeVal = mode ? mode(pos) : 0.5f;
+    const float rand = Rng::uniform(Rng::key(pos), stream, seed);
     if (mode) {
-      modeVal = mode(pos);
-      return triDist(loVal, hiVal, modeVal);
+      return triDist(loVal, hiVal, mode(pos), rand);
     } else {
-      return loVal + ofRandom(hiVal - loVal);
+      return loVal + rand * (hiVal - loVal);
     }
   };
 }
 
 FloatOp Ops::lookup(const std::vector<float> table) const {
   return [table](const float pos) {
-    const int t = static_cast<int>(ofMap(pos, 0.f, 1.f, 0.f, table.size()));
+    // pos == 1 maps one past the last entry
+    const int t =
+        std::clamp(static_cast<int>(mapValue(pos, 0.f, 1.f, 0.f, table.size())),
+                   0, static_cast<int>(table.size()) - 1);
     return table[t];
   };
 }
 
 FloatOp Ops::lookup(const std::vector<FloatOp> table) const {
   return [table](const float pos) {
-    const int t = static_cast<int>(ofMap(pos, 0.f, 1.f, 0.f, table.size()));
+    // pos == 1 maps one past the last entry
+    const int t =
+        std::clamp(static_cast<int>(mapValue(pos, 0.f, 1.f, 0.f, table.size())),
+                   0, static_cast<int>(table.size()) - 1);
     return table[t](pos);
   };
 }
@@ -343,7 +368,7 @@ FloatOp Ops::lookup(const std::vector<FloatOp> table) const {
 FloatOp Ops::wt(const std::vector<float> wTable) const {
   return [wTable](const float pos) {
     // Map pos to the range of the wavetable indices
-    float exactPos = ofMap(pos, 0.f, 1.f, 0.f, wTable.size());
+    float exactPos = mapValue(pos, 0.f, 1.f, 0.f, wTable.size());
 
     // Determine the indices of the surrounding samples
     int index1 = static_cast<int>(exactPos) % wTable.size();
@@ -351,15 +376,15 @@ FloatOp Ops::wt(const std::vector<float> wTable) const {
 
     // Calculate the fractional part of the position
     float fraction = exactPos - static_cast<float>(index1);
-    // Linearly interpolate between the two samples using ofLerp
-    return ofLerp(wTable[index1], wTable[index2], fraction);
+    // Linearly interpolate between the two samples using lerpValue
+    return lerpValue(wTable[index1], wTable[index2], fraction);
   };
 }
 
 FloatOp Ops::wt(const std::vector<FloatOp> wTable) const {
   return [wTable](const float pos) {
     // Map pos to the range of the wavetable indices
-    float exactPos = ofMap(pos, 0.f, 1.f, 0.f, wTable.size());
+    float exactPos = mapValue(pos, 0.f, 1.f, 0.f, wTable.size());
 
     // Determine the indices of the surrounding samples
     int index1 = static_cast<int>(exactPos) % wTable.size();
@@ -367,15 +392,15 @@ FloatOp Ops::wt(const std::vector<FloatOp> wTable) const {
 
     // Calculate the fractional part of the position
     float fraction = exactPos - static_cast<float>(index1);
-    // Linearly interpolate between the two samples using ofLerp
-    return ofLerp(wTable[index1](pos), wTable[index2](pos), fraction);
+    // Linearly interpolate between the two samples using lerpValue
+    return lerpValue(wTable[index1](pos), wTable[index2](pos), fraction);
   };
 }
 
 FloatOp Ops::wt(const std::vector<float> wTable, const FloatOp xOp) const {
   return [wTable, xOp](float pos) {
     // Map xOp to the range of the wavetable
-    float xPos = ofMap(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
+    float xPos = mapValue(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
 
     // Compute the lower index for the x axis
     std::size_t xIndex = static_cast<std::size_t>(xPos);
@@ -387,14 +412,14 @@ FloatOp Ops::wt(const std::vector<float> wTable, const FloatOp xOp) const {
     std::size_t xIndexNext = std::min(xIndex + 1, wTable.size() - 1);
 
     // Linear interpolation
-    return ofLerp(wTable[xIndex], wTable[xIndexNext], xFrac);
+    return lerpValue(wTable[xIndex], wTable[xIndexNext], xFrac);
   };
 }
 
 FloatOp Ops::wt(const std::vector<FloatOp> wTable, const FloatOp xOp) const {
   return [wTable, xOp](float pos) {
     // Map xOp to the range of the wavetable
-    float xPos = ofMap(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
+    float xPos = mapValue(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
 
     // Compute the lower index for the x axis
     std::size_t xIndex = static_cast<std::size_t>(xPos);
@@ -406,7 +431,7 @@ FloatOp Ops::wt(const std::vector<FloatOp> wTable, const FloatOp xOp) const {
     std::size_t xIndexNext = std::min(xIndex + 1, wTable.size() - 1);
 
     // Linear interpolation
-    return ofLerp(wTable[xIndex](pos), wTable[xIndexNext](pos), xFrac);
+    return lerpValue(wTable[xIndex](pos), wTable[xIndexNext](pos), xFrac);
   };
 }
 
@@ -414,8 +439,8 @@ FloatOp Ops::wt2d(const std::vector<std::vector<float>> wTable,
                   const FloatOp xOp, const FloatOp yOp) const {
   return [wTable, xOp, yOp](float pos) {
     // Map xOp and yOp to their respective ranges
-    float xPos = ofMap(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
-    float yPos = ofMap(yOp(pos), 0.f, 1.f, 0.f, wTable[0].size() - 1);
+    float xPos = mapValue(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
+    float yPos = mapValue(yOp(pos), 0.f, 1.f, 0.f, wTable[0].size() - 1);
 
     // Compute the lower indices for each axis
     std::size_t xIndex = static_cast<std::size_t>(xPos);
@@ -435,10 +460,10 @@ FloatOp Ops::wt2d(const std::vector<std::vector<float>> wTable,
     float v01 = wTable[xIndex][yIndexNext];
     float v11 = wTable[xIndexNext][yIndexNext];
 
-    float c0 = ofLerp(v00, v10, xFrac);
-    float c1 = ofLerp(v01, v11, xFrac);
+    float c0 = lerpValue(v00, v10, xFrac);
+    float c1 = lerpValue(v01, v11, xFrac);
 
-    return ofLerp(c0, c1, yFrac);
+    return lerpValue(c0, c1, yFrac);
   };
 }
 
@@ -446,8 +471,8 @@ FloatOp Ops::wt2d(const std::vector<std::vector<FloatOp>> wTable,
                   const FloatOp xOp, const FloatOp yOp) const {
   return [wTable, xOp, yOp](float pos) {
     // Map xOp and yOp to their respective ranges
-    float xPos = ofMap(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
-    float yPos = ofMap(yOp(pos), 0.f, 1.f, 0.f, wTable[0].size() - 1);
+    float xPos = mapValue(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
+    float yPos = mapValue(yOp(pos), 0.f, 1.f, 0.f, wTable[0].size() - 1);
 
     // Compute the lower indices for each axis
     std::size_t xIndex = static_cast<std::size_t>(xPos);
@@ -467,10 +492,10 @@ FloatOp Ops::wt2d(const std::vector<std::vector<FloatOp>> wTable,
     float v01 = wTable[xIndex][yIndexNext](pos);
     float v11 = wTable[xIndexNext][yIndexNext](pos);
 
-    float c0 = ofLerp(v00, v10, xFrac);
-    float c1 = ofLerp(v01, v11, xFrac);
+    float c0 = lerpValue(v00, v10, xFrac);
+    float c1 = lerpValue(v01, v11, xFrac);
 
-    return ofLerp(c0, c1, yFrac);
+    return lerpValue(c0, c1, yFrac);
   };
 }
 
@@ -479,9 +504,9 @@ FloatOp Ops::wt3d(const std::vector<std::vector<std::vector<float>>> wTable,
                   const FloatOp zOp) const {
   return [wTable, xOp, yOp, zOp](float pos) {
     // Get exact positions for each axis
-    float xPos = ofMap(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
-    float yPos = ofMap(yOp(pos), 0.f, 1.f, 0.f, wTable[0].size() - 1);
-    float zPos = ofMap(zOp(pos), 0.f, 1.f, 0.f, wTable[0][0].size() - 1);
+    float xPos = mapValue(xOp(pos), 0.f, 1.f, 0.f, wTable.size() - 1);
+    float yPos = mapValue(yOp(pos), 0.f, 1.f, 0.f, wTable[0].size() - 1);
+    float zPos = mapValue(zOp(pos), 0.f, 1.f, 0.f, wTable[0][0].size() - 1);
 
     // Compute the lower indices for each axis
     std::size_t xIndex = static_cast<std::size_t>(xPos);
@@ -508,15 +533,15 @@ FloatOp Ops::wt3d(const std::vector<std::vector<std::vector<float>>> wTable,
     float v110 = wTable[xIndexNext][yIndexNext][zIndex];
     float v111 = wTable[xIndexNext][yIndexNext][zIndexNext];
 
-    float c00 = ofLerp(v000, v100, xFrac);
-    float c01 = ofLerp(v001, v101, xFrac);
-    float c10 = ofLerp(v010, v110, xFrac);
-    float c11 = ofLerp(v011, v111, xFrac);
+    float c00 = lerpValue(v000, v100, xFrac);
+    float c01 = lerpValue(v001, v101, xFrac);
+    float c10 = lerpValue(v010, v110, xFrac);
+    float c11 = lerpValue(v011, v111, xFrac);
 
-    float c0 = ofLerp(c00, c10, yFrac);
-    float c1 = ofLerp(c01, c11, yFrac);
+    float c0 = lerpValue(c00, c10, yFrac);
+    float c1 = lerpValue(c01, c11, yFrac);
 
-    return ofLerp(c0, c1, zFrac);
+    return lerpValue(c0, c1, zFrac);
   };
 }
 
@@ -525,9 +550,9 @@ FloatOp Ops::wt3d(const std::vector<std::vector<std::vector<FloatOp>>> wOpTable,
                   const FloatOp zOp) const {
   return [wOpTable, xOp, yOp, zOp](float pos) {
     // Get exact positions for each axis
-    float xPos = ofMap(xOp(pos), 0.f, 1.f, 0.f, wOpTable.size() - 1);
-    float yPos = ofMap(yOp(pos), 0.f, 1.f, 0.f, wOpTable[0].size() - 1);
-    float zPos = ofMap(zOp(pos), 0.f, 1.f, 0.f, wOpTable[0][0].size() - 1);
+    float xPos = mapValue(xOp(pos), 0.f, 1.f, 0.f, wOpTable.size() - 1);
+    float yPos = mapValue(yOp(pos), 0.f, 1.f, 0.f, wOpTable[0].size() - 1);
+    float zPos = mapValue(zOp(pos), 0.f, 1.f, 0.f, wOpTable[0][0].size() - 1);
 
     // Compute the lower indices for each axis
     std::size_t xIndex = static_cast<std::size_t>(xPos);
@@ -555,21 +580,23 @@ FloatOp Ops::wt3d(const std::vector<std::vector<std::vector<FloatOp>>> wOpTable,
     float v111 = wOpTable[xIndexNext][yIndexNext][zIndexNext](pos);
 
     // Perform trilinear interpolation
-    float c00 = ofLerp(v000, v100, xFrac);
-    float c01 = ofLerp(v001, v101, xFrac);
-    float c10 = ofLerp(v010, v110, xFrac);
-    float c11 = ofLerp(v011, v111, xFrac);
+    float c00 = lerpValue(v000, v100, xFrac);
+    float c01 = lerpValue(v001, v101, xFrac);
+    float c10 = lerpValue(v010, v110, xFrac);
+    float c11 = lerpValue(v011, v111, xFrac);
 
-    float c0 = ofLerp(c00, c10, yFrac);
-    float c1 = ofLerp(c01, c11, yFrac);
+    float c0 = lerpValue(c00, c10, yFrac);
+    float c1 = lerpValue(c01, c11, yFrac);
 
-    return ofLerp(c0, c1, zFrac);
+    return lerpValue(c0, c1, zFrac);
   };
 }
 
 FloatOp Ops::perlin(const FloatOp x, const FloatOp y, const FloatOp z,
                     const FloatOp falloff, const FloatOp octaves) const {
-  return [x, y, z, falloff, octaves, this](const float pos) {
+  if (!falloff && !octaves)
+    return perlin(x, y, z, 1.f, 1);
+  return [x, y, z, falloff, octaves, seed = seed](const float pos) {
     int lod = 1;
     float fof = 1.f;
     if (falloff)
@@ -578,19 +605,53 @@ FloatOp Ops::perlin(const FloatOp x, const FloatOp y, const FloatOp z,
       lod = octaves(pos);
     const float xVal = x(pos);
     if (!y)
-      return pNoise(xVal, fof, lod);
+      return Noise::fbm(xVal, fof, lod, seed);
     const float yVal = y(pos);
     if (!z)
-      return pNoise(xVal, yVal, fof, lod);
+      return Noise::fbm(xVal, yVal, fof, lod, seed);
     const float zVal = z(pos);
-    return pNoise(xVal, yVal, zVal, fof, lod);
+    return Noise::fbm(xVal, yVal, zVal, fof, lod, seed);
+  };
+}
+
+FloatOp Ops::perlin(const FloatOp x, const FloatOp y, const FloatOp z,
+                    const float falloff, const int octaves) const {
+  return [x, y, z, fbm = Fbm(falloff, octaves, seed)](const float pos) {
+    const float xVal = x(pos);
+    if (!y)
+      return fbm(xVal);
+    const float yVal = y(pos);
+    if (!z)
+      return fbm(xVal, yVal);
+    return fbm(xVal, yVal, z(pos));
+  };
+}
+
+FloatOp Ops::perlin(const FloatOp x, const FloatOp y, const FloatOp z,
+                    const std::shared_ptr<const NoiseField> field) const {
+  if (!y)
+    return [x, field](const float pos) { return field->getFbm()(x(pos)); };
+  return [x, y, z, field](const float pos) {
+    const float xVal = x(pos);
+    const float yVal = y(pos);
+    if (!z)
+      return (*field)(xVal, yVal);
+    return (*field)(xVal, yVal, z(pos));
   };
 }
 
+FloatOp Ops::cachedPerlin(const FloatOp x, const FloatOp y, const FloatOp z,
+                          const float falloff, const int octaves,
+                          const float tolerance) const {
+  return perlin(x, y, z,
+                std::make_shared<const NoiseField>(falloff, octaves, seed,
+                                                   tolerance));
+}
+
 FloatOp Ops::fuzz(const float fuzzScale) const {
-  return [fuzzScale](const float pos) -> float {
+  return [fuzzScale, seed = seed](const float pos) -> float {
     // Generate Perlin noise and scale it by fuzzScale
-    float noise = ofNoise(pos) * fuzzScale;
+    float noise = Noise::noise(pos, seed) * fuzzScale;
 
     // Add the scaled noise to the input position
     return pos + noise;
@@ -734,6 +795,10 @@ FloatOp Ops::lpf(const FloatOp inputOp, const int windowSize) const {
   };
 }
 
+FloatOp Ops::filter(const std::shared_ptr<Filter> filter) const {
+  return [filter](const float input) { return (*filter)(input); };
+}
+
 FloatOp Ops::lpFb(float smoothing, float resonance) const {
   return [smoothing, resonance,
           lastOutput = 0.0f](const float input) mutable -> float {
@@ -786,7 +851,7 @@ FloatOp Ops::morph(const vector<FloatOp> ops, const FloatOp morphParam) const {
     blend = std::clamp(blend, 0.0f, 1.0f); // Ensure blend stays within [0, 1]
 
     // Map pos to the range of the op indices
-    float exactPos = ofMap(pos, 0.f, 1.f, 0.f, ops.size());
+    float exactPos = mapValue(pos, 0.f, 1.f, 0.f, ops.size());
 
     // Determine the indices of the surrounding ops
     int index1 = static_cast<int>(exactPos) % ops.size();
@@ -794,8 +859,8 @@ FloatOp Ops::morph(const vector<FloatOp> ops, const FloatOp morphParam) const {
 
     // Calculate the fractional part of the position
     float fraction = exactPos - static_cast<float>(index1);
-    // Linearly interpolate between the two ops using ofLerp
-    return ofLerp(ops[index1](pos), ops[index2](pos), fraction);
+    // Linearly interpolate between the two ops using lerpValue
+    return lerpValue(ops[index1](pos), ops[index2](pos), fraction);
   };
 }
 
@@ -882,26 +947,46 @@ FloatOp Ops::median(const vector<FloatOp> ops) const {
     for (const auto &op : ops) {
       values.push_back(op(pos));
     }
-    std::sort(values.begin(), values.end());
+    // Only the middle element needs to be in place
+    std::nth_element(values.begin(), values.begin() + values.size() / 2,
+                     values.end());
     return values[values.size() / 2];
   };
 }
 
+namespace {
+
+// Population variance of one evaluation of each op at pos
+float varianceAt(const vector<FloatOp> &ops, const float pos) {
+  float stackValues[16];
+  vector<float> heapValues;
+  float *values = stackValues;
+  if (ops.size() > 16) {
+    heapValues.resize(ops.size());
+    values = heapValues.data();
+  }
+  float sum = 0.f;
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    values[i] = ops[i](pos);
+    sum += values[i];
+  }
+  const float mn = sum / ops.size();
+  float variance = 0.f;
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    const float diff = values[i] - mn;
+    variance += diff * diff;
+  }
+  return variance / ops.size();
+}
+
+} // namespace
+
 FloatOp Ops::variance(const vector<FloatOp> ops) const {
-  return [ops, this](const float pos) {
-    const float mn = mean(ops)(pos);
-    float variance = 0.f;
-    for (const auto &op : ops) {
-      const float diff = op(pos) - mn;
-      variance += diff * diff;
-    }
-    variance /= ops.size();
-    return variance;
-  };
+  return [ops](const float pos) { return varianceAt(ops, pos); };
 }
 
 FloatOp Ops::stdDev(const vector<FloatOp> ops) const {
-  return [ops, this](const float pos) { return std::sqrt(variance(ops)(pos)); };
+  return [ops](const float pos) { return std::sqrt(varianceAt(ops, pos)); };
 }
 
 FloatOp Ops::smooth() const {
@@ -1230,6 +1315,18 @@ FloatOp Ops::out(const FloatOp op, const FloatOp lo, const float hi) const {
   };
 }
 
+FloatOp Ops::profiled([[maybe_unused]] const std::string &name,
+                      const FloatOp op) const {
+#ifdef OFXCRVS_PROFILE
+  return [name, op](const float pos) {
+    OFXCRVS_PROFILE_SCOPE("op", name);
+    return op(pos);
+  };
+#else
+  return op;
+#endif
+}
+
 FloatOp Ops::chain(const vector<FloatOp> ops) const {
   return [ops](const float pos) {
     float val = pos;
@@ -1241,18 +1338,26 @@ FloatOp Ops::chain(const vector<FloatOp> ops) const {
 }
 
 FloatOp Ops::choose(const vector<FloatOp> ops) const {
-  return [ops](const float pos) {
-    const int index = static_cast<int>(ofRandom(ops.size()));
+  return [ops, stream = nextStream(), seed = seed](const float pos) {
+    const float rand = Rng::uniform(Rng::key(pos), stream, seed);
+    const int index = std::min(static_cast<int>(rand * ops.size()),
+                               static_cast<int>(ops.size()) - 1);
     return ops[index](pos);
   };
 }
 
 vector<float> Ops::normalize(const vector<float> values) const {
+  if (values.empty())
+    return values;
   // Find min and max using structured bindings
   const auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
   const float min = *minIt;
   const float max = *maxIt;
 
+  // A flat series has no range to normalize by; center it
+  if (max <= min)
+    return vector<float>(values.size(), 0.5f);
+
   // Normalize the values
   std::vector<float> normValues;
   normValues.reserve(values.size());
@@ -1266,13 +1371,34 @@ vector<float> Ops::normalize(const vector<float> values) const {
 FloatOp Ops::timeseries(const vector<float> yValues) const {
   vector<float> normValues = normalize(yValues);
   return [normValues](const float pos) {
-    const int index = static_cast<int>(pos * (normValues.size() - 1));
-    const float fraction = pos * (normValues.size() - 1) - index;
+    if (normValues.size() < 2)
+      return normValues.empty() ? 0.f : normValues[0];
+    const float exactPos = clampValue(pos, 0.f, 1.f) * (normValues.size() - 1);
+    // Clamp so pos == 1 interpolates the last segment instead of reading
+    // past the end
+    const int index = std::min(static_cast<int>(exactPos),
+                               static_cast<int>(normValues.size()) - 2);
+    const float fraction = exactPos - index;
     return (normValues[index] * (1.f - fraction)) +
            (normValues[index + 1] * fraction);
   };
 }
 
+FloatOp Ops::timeseries(const std::shared_ptr<const Strm> stream) const {
+  return [stream](const float pos) { return stream->at(pos); };
+}
+
+vector<float> Ops::filterArray(const FloatOp inputOp, const int numSamples,
+                               Filter &filter) const {
+  vector<float> samples(std::max(numSamples, 0));
+  const float step = numSamples > 1 ? 1.f / (numSamples - 1) : 0.f;
+  for (int i = 0; i < numSamples; ++i) {
+    samples[i] = inputOp(i * step);
+  }
+  filter.process(samples.data(), samples.data(), samples.size());
+  return samples;
+}
+
 vector<float> Ops::floatArray(const FloatOp op, const int numSamples,
                               const FloatOp mapOp) const {
   const float step = 1.f / numSamples;
@@ -1299,7 +1425,7 @@ vector<glm::vec2> Ops::glv2Array(const FloatOp curve, const float start,
   for (int i = 0; i < numPoints; ++i) {
     const float x = start + (i * step);
     const float y = curve(x / modEnd);
-    points[i] = glm::vec2(x, ofGetHeight() - (y * yScale));
+    points[i] = glm::vec2(x, getViewHeight() - (y * yScale));
   }
   return points;
 }
@@ -1313,118 +1439,63 @@ vector<glm::vec3> Ops::glv3Array(const FloatOp curve, const float start,
   for (int i = 0; i < numPoints; ++i) {
     const float x = start + (i * step);
     const float y = curve(x / modEnd);
-    points[i] = glm::vec3(x, ofGetHeight() - (y * yScale), 0.f);
-  }
-  return points;
-}
-
-vector<ofVec2f> Ops::ofv2Array(const FloatOp curve, const float start,
-                               const float end, const int numPoints,
-                               const float yScale) const {
-  vector<ofVec2f> points(numPoints);
-  const float step = (end - start) / numPoints;
-  const float modEnd = end - (step - 1);
-  for (int i = 0; i < numPoints; ++i) {
-    const float x = start + (i * step);
-    const float y = curve(x / modEnd);
-    points[i] = ofVec2f(x, ofGetHeight() - (y * yScale));
+    points[i] = glm::vec3(x, getViewHeight() - (y * yScale), 0.f);
   }
   return points;
 }
 
-vector<ofVec3f> Ops::ofv3Array(const FloatOp curve, const float start,
-                               const float end, const int numPoints,
-                               const float yScale) const {
-  vector<ofVec3f> points(numPoints);
-  const float step = (end - start) / numPoints;
-  const float modEnd = end - (step - 1);
-  for (int i = 0; i < numPoints; ++i) {
-    const float x = start + (i * step);
-    const float y = curve(x / modEnd);
-    points[i] = ofVec3f(x, ofGetHeight() - (y * yScale), 0.f);
-  }
-  return points;
+float Ops::triDist(const float lo, const float hi, const float mode) const {
+  return triDist(lo, hi, mode, randomFloat(1.f));
 }
 
-float Ops::triDist(const float lo, const float hi, const float mode) const {
+float Ops::triDist(const float lo, const float hi, const float mode,
+                   const float rand) {
   const float F = (mode - lo) / (hi - lo);
-  if (const float rand = ofRandom(1.f); rand < F) {
+  if (rand < F) {
     return lo + std::sqrt(rand * (hi - lo) * (mode - lo));
   } else {
     return hi - std::sqrt((1.f - rand) * (hi - lo) * (hi - mode));
   }
 }
 
-float Ops::pNoise(const float x, const float y, const float z,
-                  const float falloff, const int octaves) const {
-  float amplitude = 1.0f;
-  float frequency = 1.0f;
-  float total = 0.0f;
-  float maxAmplitude = 0.0f; // Used for normalizing result to 0.0 - 1.0
-
-  for (int i = 0; i < octaves; i++) {
-    total += ofNoise(x * frequency, y * frequency, z * frequency) * amplitude;
-
-    maxAmplitude += amplitude;
-    amplitude *= falloff;
-    frequency *= 2.0f;
+namespace {
+
+// The Fbm pNoise() last ran with on this thread, so a run of calls with the
+// same settings builds it once, without locking or sharing between threads
+const Fbm &noiseFbm(const float falloff, const int octaves,
+                    const std::uint32_t seed) {
+  thread_local struct {
+    bool valid = false;
+    float falloff;
+    int octaves;
+    std::uint32_t seed;
+    Fbm fbm;
+  } cache;
+  if (!cache.valid || cache.falloff != falloff || cache.octaves != octaves ||
+      cache.seed != seed) {
+    cache.fbm = Fbm(falloff, octaves, seed);
+    cache.falloff = falloff;
+    cache.octaves = octaves;
+    cache.seed = seed;
+    cache.valid = true;
   }
+  return cache.fbm;
+}
 
-  return total / maxAmplitude;
+} // namespace
+
+float Ops::pNoise(const float x, const float y, const float z,
+                  const float falloff, const int octaves) const {
+  return noiseFbm(falloff, octaves, seed)(x, y, z);
 }
 
 float Ops::pNoise(const float x, const float y, const float falloff,
                   int octaves) const {
-  float amplitude = 1.0f;
-  float frequency = 1.0f;
-  float total = 0.0f;
-  float maxAmplitude = 0.0f; // Used for normalizing result to 0.0 - 1.0
-
-  for (int i = 0; i < octaves; i++) {
-    total += ofNoise(x * frequency, y * frequency) * amplitude;
-
-    maxAmplitude += amplitude;
-    amplitude *= falloff;
-    frequency *= 2.0f;
-  }
-
-  return total / maxAmplitude;
+  return noiseFbm(falloff, octaves, seed)(x, y);
 }
 
 float Ops::pNoise(const float x, const float falloff, const int octaves) const {
-  float amplitude = 1.0f;
-  float frequency = 1.0f;
-  float total = 0.0f;
-  float maxAmplitude = 0.0f; // Used for normalizing result to 0.0 - 1.0
-
-  for (int i = 0; i < octaves; i++) {
-    total += ofNoise(x * frequency) * amplitude;
-
-    maxAmplitude += amplitude;
-    amplitude *= falloff;
-    frequency *= 2.0f;
-  }
-
-  return total / maxAmplitude;
-}
-
-void Ops::plot(const FloatOp op, const float yScale, const ofColor color,
-               const bool fill) const {
-  ofPushStyle();
-  ofSetColor(color);
-  ofSetLineWidth(1);
-  if (fill)
-    ofFill();
-  else
-    ofNoFill();
-  const float width = ofGetWidth();
-  const vector<glm::vec2> points = glv2Array(op, 0.f, width, width, yScale);
-  ofBeginShape();
-  for (auto point : points) {
-    ofVertex(point);
-  }
-  ofEndShape();
-  ofPopStyle();
+  return noiseFbm(falloff, octaves, seed)(x);
 }
 
 } // namespace ofxCrvs
@@ -1,18 +1,66 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
+#include <memory>
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 
 namespace ofxCrvs {
 
 using FloatOp = std::function<float(const float)>;
 
+class Breakpoints;
+class Clock;
+class Filter;
+class NoiseField;
+class Strm;
+
 class Ops {
 public:
   static float pos2Rad(float pos);
 
+  // An unseeded Ops gets its own id, so ops from different instances, even
+  // temporaries like Ops().random(), never share a stream. A copy starts
+  // over with the same seed and clock, as a new instance if unseeded.
+  Ops() : instance(nextInstance()) {}
+  Ops(const Ops &other)
+      : seed(other.seed),
+        instance(other.instance == seededInstance ? seededInstance
+                                                  : nextInstance()),
+        clock(other.clock) {}
+  Ops &operator=(const Ops &other) {
+    seed = other.seed;
+    if (other.instance == seededInstance)
+      instance = seededInstance;
+    clock = other.clock;
+    streamCount.store(0, std::memory_order_relaxed);
+    return *this;
+  };
+
+  // Random and noise ops are pure functions of (pos, seed, stream). Each op
+  // takes the next stream of its Ops when it is created. After setSeed()
+  // the streams depend on the seed and that order alone, so a graph built
+  // in the same order with the same seed renders identically in any Ops,
+  // run or thread count.
+  void setSeed(std::uint32_t value) {
+    seed = value;
+    instance = seededInstance;
+    streamCount.store(0, std::memory_order_relaxed);
+  };
+  [[nodiscard]] std::uint32_t getSeed() const { return seed; };
+
+  // Clock read by timePhasor() and tempoPhasor() created from now on.
+  // Without one they read elapsedMicros() on every evaluation.
+  void setClock(std::shared_ptr<const Clock> value) {
+    clock = std::move(value);
+  };
+  [[nodiscard]] std::shared_ptr<const Clock> getClock() const {
+    return clock;
+  };
+
   [[nodiscard]] FloatOp zero() const {
     return [](const float) { return 0.0f; };
   };
@@ -53,16 +101,10 @@ public:
     return [](const float) { return glm::two_pi<float>(); };
   };
   [[nodiscard]] FloatOp appWidth() const {
-    return [](const float) { return static_cast<float>(ofGetWidth()); };
+    return [](const float) { return getViewWidth(); };
   };
   [[nodiscard]] FloatOp appHeight() const {
-    return [](const float) { return static_cast<float>(ofGetHeight()); };
-  };
-  [[nodiscard]] FloatOp mouseX() const {
-    return [](const float) { return static_cast<float>(ofGetMouseX()); };
-  };
-  [[nodiscard]] FloatOp mouseY() const {
-    return [](const float) { return static_cast<float>(ofGetMouseY()); };
+    return [](const float) { return getViewHeight(); };
   };
 
   [[nodiscard]] FloatOp bipolarize(const FloatOp unipolarOp) const;
@@ -127,7 +169,11 @@ public:
                             float decayLength, float sustainLength,
                             float sustainLevel, float releaseLength) const;
   [[nodiscard]] FloatOp breakpoints(const vector<vector<float>> points) const;
+  [[nodiscard]] FloatOp breakpoints(const Breakpoints &points) const;
   [[nodiscard]] FloatOp timeseries(const vector<float> yValues) const;
+  // Plays back the latest window of a live stream
+  [[nodiscard]] FloatOp
+  timeseries(const std::shared_ptr<const Strm> stream) const;
 
   [[nodiscard]] FloatOp gaussian(const FloatOp lo, const FloatOp hi) const;
   [[nodiscard]] FloatOp gaussian(const FloatOp hi) const {
@@ -151,6 +197,20 @@ public:
                                const FloatOp z = FloatOp(),
                                const FloatOp falloff = FloatOp(),
                                const FloatOp octaves = FloatOp()) const;
+  // Constant falloff and octaves: octave constants are computed once
+  [[nodiscard]] FloatOp perlin(const FloatOp x, const FloatOp y,
+                               const FloatOp z, float falloff,
+                               int octaves) const;
+  // Reads 2D/3D noise from a cached lattice instead of evaluating it, for
+  // inputs that revisit the same region. The field can be shared between
+  // ops; without y the op evaluates the field's 1D fBm directly.
+  [[nodiscard]] FloatOp perlin(const FloatOp x, const FloatOp y,
+                               const FloatOp z,
+                               std::shared_ptr<const NoiseField> field) const;
+  [[nodiscard]] FloatOp cachedPerlin(const FloatOp x, const FloatOp y,
+                                     const FloatOp z, float falloff = 1.f,
+                                     int octaves = 1,
+                                     float tolerance = 1e-3f) const;
   [[nodiscard]] FloatOp fuzz(const float fuzzScale) const;
 
   // Basic ops
@@ -171,7 +231,11 @@ public:
   [[nodiscard]] FloatOp wrap(const FloatOp op, float min, float max) const;
   [[nodiscard]] FloatOp wrap(const FloatOp op, const FloatOp minOp,
                              const FloatOp maxOp) const;
+  // Random access: evaluates inputOp windowSize times per call. To smooth a
+  // whole sweep, filterArray() with a Boxcar costs O(1) per sample.
   [[nodiscard]] FloatOp lpf(const FloatOp inputOp, int windowSize) const;
+  // Feeds each input value through a stateful filter, like lpFb
+  [[nodiscard]] FloatOp filter(const std::shared_ptr<Filter> filter) const;
   [[nodiscard]] FloatOp lpFb(float smoothing, float resonance) const;
   [[nodiscard]] FloatOp ampFb(float feedbackStrength, float damping,
                               const FloatOp inputOp = FloatOp()) const;
@@ -251,10 +315,19 @@ public:
                             const FloatOp hi) const;
   [[nodiscard]] FloatOp out(const FloatOp op, float lo, const FloatOp hi) const;
   [[nodiscard]] FloatOp out(const FloatOp op, const FloatOp lo, float hi) const;
+
+  // Times op as an "op:name" frame when built with OFXCRVS_PROFILE, and is
+  // op itself otherwise
+  [[nodiscard]] FloatOp profiled(const std::string &name,
+                                 const FloatOp op) const;
   // End Digital Ops
 
   [[nodiscard]] vector<float> normalize(const vector<float> values) const;
 
+  // Samples inputOp once at each of numSamples positions across [0, 1] and
+  // runs the block through filter.
+  [[nodiscard]] vector<float> filterArray(const FloatOp inputOp,
+                                          int numSamples, Filter &filter) const;
   [[nodiscard]] vector<float> floatArray(const FloatOp op, int numSamples,
                                          const FloatOp mapOp = FloatOp()) const;
 
@@ -264,14 +337,12 @@ public:
   [[nodiscard]] vector<glm::vec3> glv3Array(const FloatOp curve, float start,
                                             float end, int numPoints,
                                             float yScale = 1.0f) const;
-  [[nodiscard]] vector<ofVec2f> ofv2Array(const FloatOp curve, float start,
-                                          float end, int numPoints,
-                                          float yScale = 1.0f) const;
-  [[nodiscard]] vector<ofVec3f> ofv3Array(const FloatOp curve, float start,
-                                          float end, int numPoints,
-                                          float yScale = 1.0f) const;
 
   [[nodiscard]] float triDist(float lo, float hi, float mode) const;
+  [[nodiscard]] static float triDist(float lo, float hi, float mode,
+                                     float rand);
+  // Noise::fbm() with this Ops' seed, through an Fbm kept between calls
+  // while falloff and octaves stay the same
   [[nodiscard]] float pNoise(float x, float y, float z, float falloff = 1.f,
                              int octaves = 1) const;
   [[nodiscard]] float pNoise(float x, float y, float falloff = 1.f,
@@ -279,7 +350,20 @@ public:
   [[nodiscard]] float pNoise(float x, float falloff = 1.f,
                              int octaves = 1) const;
 
-  void plot(const FloatOp op, float yScale, ofColor color = ofColor::white,
-            bool fill = false) const;
+private:
+  // Shared by every seeded Ops
+  static constexpr std::uint32_t seededInstance = 0;
+  // Unique per process and never seededInstance, from a global atomic
+  // counter
+  [[nodiscard]] static std::uint32_t nextInstance();
+  // Safe to call from several threads building ops at once
+  [[nodiscard]] std::uint32_t nextStream() const;
+  // Position within a cycle of the given length on clock
+  [[nodiscard]] FloatOp clockPhasor(double cycleDurationMicros) const;
+
+  std::uint32_t seed = 0;
+  std::uint32_t instance;
+  mutable std::atomic<std::uint32_t> streamCount{0};
+  std::shared_ptr<const Clock> clock;
 };
 } // namespace ofxCrvs
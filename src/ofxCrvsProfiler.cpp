@@ -0,0 +1,214 @@
+#include "ofxCrvsProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace ofxCrvs {
+
+std::atomic<bool> Profiler::running{false};
+
+namespace {
+
+struct Registry {
+  std::mutex mutex;
+  // Trees outlive their threads so a report can include finished workers
+  vector<std::shared_ptr<Profiler::Tree>> trees;
+  // Tick/clock pairs at start() and stop(), to convert ticks to ns
+  std::uint64_t startTicks = 0;
+  std::chrono::steady_clock::time_point startTime;
+  std::uint64_t elapsedTicks = 0;
+  double elapsedNs = 0.0;
+};
+
+Registry &registry() {
+  static Registry r;
+  return r;
+}
+
+struct PathStats {
+  std::uint64_t calls = 0;
+  std::uint64_t ticks = 0;
+  std::uint64_t selfTicks = 0;
+};
+
+std::string label(const Profiler::Node &node) {
+  return node.name.empty() ? std::string(node.role)
+                           : std::string(node.role) + ":" + node.name;
+}
+
+// Merges every thread's tree by call path
+std::map<std::string, PathStats> collect() {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::map<std::string, PathStats> paths;
+  for (const auto &tree : r.trees) {
+    const vector<Profiler::Node> &nodes = tree->nodes;
+    vector<std::string> names(nodes.size());
+    for (std::size_t i = 1; i < nodes.size(); ++i) {
+      // Children are always created after their parent
+      const std::uint32_t parent = nodes[i].parent;
+      names[i] = parent ? names[parent] + ";" + label(nodes[i])
+                        : label(nodes[i]);
+      if (nodes[i].calls == 0)
+        continue;
+      std::uint64_t childTicks = 0;
+      for (const std::uint32_t child : nodes[i].children)
+        childTicks += nodes[child].ticks;
+      PathStats &stats = paths[names[i]];
+      stats.calls += nodes[i].calls;
+      stats.ticks += nodes[i].ticks;
+      stats.selfTicks +=
+          nodes[i].ticks > childTicks ? nodes[i].ticks - childTicks : 0;
+    }
+  }
+  return paths;
+}
+
+double nsPerTick() {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  std::uint64_t ticks = r.elapsedTicks;
+  double ns = r.elapsedNs;
+  if (Profiler::isRunning()) {
+    ticks += Profiler::ticks() - r.startTicks;
+    ns += std::chrono::duration<double, std::nano>(
+              std::chrono::steady_clock::now() - r.startTime)
+              .count();
+  }
+  return ticks > 0 ? ns / ticks : 1.0;
+}
+
+} // namespace
+
+double Profiler::tickPeriodNs() {
+  static const double period = [] {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point startTime = Clock::now();
+    const std::uint64_t startTicks = ticks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const std::uint64_t elapsed = ticks() - startTicks;
+    const double ns = std::chrono::duration<double, std::nano>(
+                          Clock::now() - startTime)
+                          .count();
+    return elapsed > 0 ? ns / elapsed : 1.0;
+  }();
+  return period;
+}
+
+std::uint32_t Profiler::Tree::enter(const char *role, const char *name) {
+  for (const std::uint32_t child : nodes[current].children) {
+    const Node &node = nodes[child];
+    if ((node.role == role || std::strcmp(node.role, role) == 0) &&
+        node.name == name)
+      return current = child;
+  }
+  const auto id = static_cast<std::uint32_t>(nodes.size());
+  nodes.emplace_back(role, name, current);
+  nodes[current].children.push_back(id);
+  return current = id;
+}
+
+Profiler::Tree &Profiler::tree() {
+  thread_local std::shared_ptr<Tree> local = [] {
+    auto tree = std::make_shared<Tree>();
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.trees.push_back(tree);
+    return tree;
+  }();
+  return *local;
+}
+
+void ProfileScope::enter(const char *role, const char *name) {
+  tree = &Profiler::tree();
+  node = tree->enter(role, name);
+  start = Profiler::ticks();
+}
+
+void ProfileScope::exit() { tree->exit(node, Profiler::ticks() - start); }
+
+void Profiler::start() {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (running.load())
+    return;
+  r.startTicks = ticks();
+  r.startTime = std::chrono::steady_clock::now();
+  running.store(true);
+}
+
+void Profiler::stop() {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  if (!running.load())
+    return;
+  running.store(false);
+  r.elapsedTicks += ticks() - r.startTicks;
+  r.elapsedNs += std::chrono::duration<double, std::nano>(
+                     std::chrono::steady_clock::now() - r.startTime)
+                     .count();
+}
+
+void Profiler::reset() {
+  Registry &r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (const auto &tree : r.trees) {
+    for (Node &node : tree->nodes) {
+      node.calls = 0;
+      node.ticks = 0;
+    }
+  }
+  r.elapsedTicks = 0;
+  r.elapsedNs = 0.0;
+  r.startTicks = ticks();
+  r.startTime = std::chrono::steady_clock::now();
+}
+
+std::string Profiler::folded() {
+  const double scale = nsPerTick();
+  std::ostringstream os;
+  for (const auto &[path, stats] : collect()) {
+    const auto selfNs = static_cast<std::uint64_t>(stats.selfTicks * scale);
+    if (selfNs > 0)
+      os << path << ' ' << selfNs << '\n';
+  }
+  return os.str();
+}
+
+std::string Profiler::report() {
+  const double scale = nsPerTick();
+  const std::map<std::string, PathStats> paths = collect();
+  vector<std::pair<std::string, PathStats>> rows(paths.begin(), paths.end());
+  std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) {
+    return a.second.selfTicks > b.second.selfTicks;
+  });
+  std::ostringstream os;
+  char line[96];
+  std::snprintf(line, sizeof(line), "%12s %12s %12s %10s  %s\n", "calls",
+                "total ms", "self ms", "mean ns", "path");
+  os << line;
+  for (const auto &[path, stats] : rows) {
+    std::snprintf(line, sizeof(line), "%12llu %12.3f %12.3f %10.1f  ",
+                  static_cast<unsigned long long>(stats.calls),
+                  stats.ticks * scale * 1e-6, stats.selfTicks * scale * 1e-6,
+                  stats.ticks * scale / stats.calls);
+    os << line << path << '\n';
+  }
+  return os.str();
+}
+
+void Profiler::save(const std::string &path) {
+  std::ofstream file(path);
+  if (!file)
+    throw std::runtime_error("Profiler: cannot write " + path);
+  file << folded();
+}
+
+} // namespace ofxCrvs
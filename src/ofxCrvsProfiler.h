@@ -0,0 +1,142 @@
+#pragma once
+
+#ifndef OFXCRVSPROFILER_H
+#define OFXCRVSPROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Opt-in evaluation profiler. Building with OFXCRVS_PROFILE puts scopes
+ * around every modulator (amp, rate, phase, bias), axis curve (x, y, z, w)
+ * and op a Crv evaluates, and lets Ops::profiled() mark individual op
+ * nodes. Without the flag OFXCRVS_PROFILE_SCOPE expands to nothing and
+ * Ops::profiled() returns its op unchanged, so the hot paths carry no cost.
+ *
+ * Scopes only record between start() and stop(). Each thread builds its own
+ * call tree keyed by the path of scopes, timed with the CPU's cycle counter
+ * and converted to nanoseconds when reporting. A frame shows as its role,
+ * followed by ":name" when the Crv or op it enters has a name.
+ *
+ * report(), folded() and reset() read every thread's tree and must not run
+ * while profiled evaluation is still in flight.
+ */
+class Profiler {
+public:
+  static void start();
+  static void stop();
+  static void reset();
+  [[nodiscard]] static bool isRunning() {
+    return running.load(std::memory_order_relaxed);
+  };
+
+  // One "frame;frame;frame <self ns>" line per call path, the folded-stack
+  // format flamegraph.pl and speedscope read
+  [[nodiscard]] static std::string folded();
+  // Calls, total and self time per call path, slowest self time first
+  [[nodiscard]] static std::string report();
+  static void save(const std::string &path);
+
+  [[nodiscard]] static std::uint64_t ticks() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    std::uint64_t t;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+    return t;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  };
+  // Nanoseconds per ticks() tick, measured against steady_clock over about
+  // a millisecond on the first call
+  [[nodiscard]] static double tickPeriodNs();
+
+  struct Node {
+    Node(const char *role, std::string name, std::uint32_t parent)
+        : role(role), name(std::move(name)), parent(parent) {}
+
+    const char *role;
+    std::string name;
+    std::uint32_t parent;
+    std::uint64_t calls = 0;
+    std::uint64_t ticks = 0;
+    vector<std::uint32_t> children;
+  };
+
+  // Per-thread call tree; node 0 is the root
+  struct Tree {
+    vector<Node> nodes;
+    std::uint32_t current = 0;
+
+    Tree() { nodes.emplace_back("", std::string(), 0); };
+    std::uint32_t enter(const char *role, const char *name);
+    void exit(std::uint32_t node, std::uint64_t elapsed) {
+      nodes[node].calls++;
+      nodes[node].ticks += elapsed;
+      current = nodes[node].parent;
+    };
+  };
+
+  [[nodiscard]] static Tree &tree();
+
+private:
+  static std::atomic<bool> running;
+};
+
+/** Times the enclosing block as a child of the current scope. */
+class ProfileScope {
+public:
+  explicit ProfileScope(const char *role, const char *name = "") {
+    if (Profiler::isRunning())
+      enter(role, name);
+  };
+  ProfileScope(const char *role, const std::string &name)
+      : ProfileScope(role, name.c_str()) {}
+  ~ProfileScope() {
+    if (tree)
+      exit();
+  };
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  // Out of line so a stopped profiler costs callers one load and branch
+  void enter(const char *role, const char *name);
+  void exit();
+
+  Profiler::Tree *tree = nullptr;
+  std::uint32_t node = 0;
+  std::uint64_t start = 0;
+};
+
+} // namespace ofxCrvs
+
+#define OFXCRVS_PROFILE_CAT_(a, b) a##b
+#define OFXCRVS_PROFILE_CAT(a, b) OFXCRVS_PROFILE_CAT_(a, b)
+
+#ifdef OFXCRVS_PROFILE
+#define OFXCRVS_PROFILE_SCOPE(...)                                             \
+  ::ofxCrvs::ProfileScope OFXCRVS_PROFILE_CAT(ofxCrvsProfileScope,             \
+                                              __LINE__)(__VA_ARGS__)
+#else
+#define OFXCRVS_PROFILE_SCOPE(...)
+#endif
+
+#endif // OFXCRVSPROFILER_H
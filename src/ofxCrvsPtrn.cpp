@@ -4,6 +4,8 @@
 
 #include "ofxCrvsPtrn.h"
 
+#include "ofxCrvsProfiler.h"
+
 namespace ofxCrvs {
 
 std::vector<float> Ptrn::trigs(const int numStepsOverride,
@@ -391,6 +393,76 @@ void Ptrn::resetValueY() { currentValueYIndex.store(0); }
 void Ptrn::resetValueZ() { currentValueZIndex.store(0); }
 void Ptrn::resetVec() { currentVecIndex.store(0); }
 
+void Ptrn::setMetrics(const std::string &name, Metrics &metrics) {
+  const std::string prefix = "ptrn." + name + ".";
+  instruments.reset(new Instruments{
+      metrics.counter(prefix + "steps"),
+      metrics.counter(prefix + "late_steps"),
+      metrics.counter(prefix + "missed_steps"),
+      metrics.histogram(prefix + "step_interval_ns"),
+      metrics.counter(prefix + "rebuilds"),
+      metrics.histogram(prefix + "rebuild_ns"),
+      metrics.gauge(prefix + "cache_entries"),
+      metrics.counter(prefix + "cache.swaps"),
+      metrics.counter(prefix + "cache.contended_swaps")});
+  for (auto *cache : {&trigXCache, &trigYCache, &trigZCache, &valueXCache,
+                      &valueYCache, &valueZCache})
+    cache->setMetrics(&instruments->swaps, &instruments->contendedSwaps);
+  vecCache.setMetrics(&instruments->swaps, &instruments->contendedSwaps);
+  tickPeriodNs = Profiler::tickPeriodNs();
+  lastStepTicks.store(0);
+}
+
+void Ptrn::setStepInterval(const std::chrono::nanoseconds interval) {
+  stepIntervalNs.store(interval.count());
+}
+
+template <typename T, typename Build>
+void Ptrn::rebuild(BufferedContainer<T> &cache, Build build) {
+  if (!instruments) {
+    cache.set(build());
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  cache.set(build());
+  instruments->rebuildNs.record(std::chrono::steady_clock::now() - start);
+  instruments->rebuilds.add();
+  instruments->cacheEntries.set(
+      static_cast<double>(trigXCache.size() + trigYCache.size() +
+                          trigZCache.size() + valueXCache.size() +
+                          valueYCache.size() + valueZCache.size() +
+                          vecCache.size()));
+}
+
+void Ptrn::recordStep() {
+  // The cycle counter costs a fraction of a steady_clock read, which would
+  // double the cost of next()
+  const std::uint64_t now = Profiler::ticks();
+  instruments->steps.add();
+  // next() is driven from one thread at a time, so plain relaxed accesses
+  // do; a read-modify-write would cost as much as the counter read saves
+  const std::uint64_t last = lastStepTicks.load(std::memory_order_relaxed);
+  lastStepTicks.store(now, std::memory_order_relaxed);
+  // A counter read on another core can trail the last one slightly
+  if (last == 0 || now < last)
+    return;
+  const auto interval =
+      static_cast<std::int64_t>(static_cast<double>(now - last) *
+                                tickPeriodNs);
+  instruments->stepIntervalNs.record(static_cast<std::uint64_t>(interval));
+  const std::int64_t expected =
+      stepIntervalNs.load(std::memory_order_relaxed);
+  if (expected <= 0)
+    return;
+  // Late once more than half a step behind; every whole step that fits in
+  // the gap beyond the expected one was missed
+  if (interval - expected > expected / 2)
+    instruments->lateSteps.add();
+  const std::int64_t missed = (interval + expected / 2) / expected - 1;
+  if (missed > 0)
+    instruments->missedSteps.add(static_cast<std::uint64_t>(missed));
+}
+
 void Ptrn::updateCache() {
   updateTrigXCache();
   updateTrigYCache();
@@ -401,19 +473,33 @@ void Ptrn::updateCache() {
   updateVecCache();
 }
 
-void Ptrn::updateTrigXCache() { trigXCache.set(trigsX()); }
+void Ptrn::updateTrigXCache() {
+  rebuild(trigXCache, [this] { return trigsX(); });
+}
 
-void Ptrn::updateTrigYCache() { trigYCache.set(trigsY()); }
+void Ptrn::updateTrigYCache() {
+  rebuild(trigYCache, [this] { return trigsY(); });
+}
 
-void Ptrn::updateTrigZCache() { trigZCache.set(trigsZ()); }
+void Ptrn::updateTrigZCache() {
+  rebuild(trigZCache, [this] { return trigsZ(); });
+}
 
-void Ptrn::updateValueXCache() { valueXCache.set(valuesX()); }
+void Ptrn::updateValueXCache() {
+  rebuild(valueXCache, [this] { return valuesX(); });
+}
 
-void Ptrn::updateValueYCache() { valueYCache.set(valuesY()); }
+void Ptrn::updateValueYCache() {
+  rebuild(valueYCache, [this] { return valuesY(); });
+}
 
-void Ptrn::updateValueZCache() { valueZCache.set(valuesZ()); }
+void Ptrn::updateValueZCache() {
+  rebuild(valueZCache, [this] { return valuesZ(); });
+}
 
-void Ptrn::updateVecCache() { vecCache.set(vecs()); }
+void Ptrn::updateVecCache() {
+  rebuild(vecCache, [this] { return vecs(); });
+}
 
 float Ptrn::nextTrig(const Component component) {
   switch (component) {
@@ -543,6 +629,8 @@ glm::vec3 Ptrn::nextVec() {
 }
 
 std::array<std::array<float, 2>, 3> Ptrn::next() {
+  if (instruments)
+    recordStep();
   int idx = currentNextIndex.load();
   if (idx >= numNextSteps.load()) {
     if (syncNext.load())
@@ -7,9 +7,10 @@
 #ifndef OFXCRVSPTRN_H
 #define OFXCRVSPTRN_H
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 #include "ofxCrvsBufferedContainer.h"
 #include "ofxCrvsCrv.h"
+#include "ofxCrvsMetrics.h"
 
 namespace ofxCrvs {
 
@@ -172,6 +173,14 @@ public:
   void updateValueZCache();
   void updateVecCache();
 
+  // Reports cache rebuilds and swaps, and next() timing, into metrics under
+  // "ptrn.<name>."; call before the Ptrn is shared between threads
+  void setMetrics(const std::string &name,
+                  Metrics &metrics = Metrics::global());
+  // Expected time between next() calls, used to count late and missed
+  // steps; zero only records the intervals
+  void setStepInterval(std::chrono::nanoseconds interval);
+
 private:
   std::atomic<bool> syncNext{true};
 
@@ -234,6 +243,27 @@ private:
   BufferedContainer<std::vector<float>> valueZCache;
   BufferedContainer<std::vector<glm::vec3>> vecCache;
 
+  struct Instruments {
+    Counter &steps;
+    Counter &lateSteps;
+    Counter &missedSteps;
+    Histogram &stepIntervalNs;
+    Counter &rebuilds;
+    Histogram &rebuildNs;
+    Gauge &cacheEntries;
+    Counter &swaps;
+    Counter &contendedSwaps;
+  };
+  std::unique_ptr<Instruments> instruments;
+  std::atomic<std::int64_t> stepIntervalNs{0};
+  // Profiler::ticks() of the last step, and the ns per tick to convert
+  std::atomic<std::uint64_t> lastStepTicks{0};
+  double tickPeriodNs = 1.0;
+
+  template <typename T, typename Build>
+  void rebuild(BufferedContainer<T> &cache, Build build);
+  void recordStep();
+
   static float quantize(float y, int quantization);
 };
 
@@ -0,0 +1,59 @@
+#pragma once
+
+#ifndef OFXCRVSRNG_H
+#define OFXCRVSRNG_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Stateless counter-based random numbers: every value is a pure hash of
+ * (key, stream, seed), so results don't depend on call order or threads.
+ */
+class Rng {
+public:
+  // lowbias32 integer finalizer (Chris Wellons)
+  static std::uint32_t hash(std::uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+  }
+
+  static std::uint32_t hash(std::uint32_t key, std::uint32_t stream,
+                            std::uint32_t seed) {
+    return hash(key ^ hash(stream ^ hash(seed + 0x9e3779b9u)));
+  }
+
+  // Bit pattern of a position, so each sample position gets its own counter.
+  static std::uint32_t key(float pos) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &pos, sizeof(bits));
+    return bits;
+  }
+
+  // Uniform in [0, 1)
+  static float uniform(std::uint32_t key, std::uint32_t stream,
+                       std::uint32_t seed) {
+    return (hash(key, stream, seed) >> 8) * (1.f / 16777216.f);
+  }
+
+  // Standard normal via Box–Muller, drawing two uniforms from the same key.
+  static float gaussian(std::uint32_t key, std::uint32_t stream,
+                        std::uint32_t seed) {
+    const float u1 = uniform(key, stream, seed);
+    const float u2 = uniform(key, stream ^ 0x68e31da4u, seed);
+    const float r = std::sqrt(-2.f * std::log(1.f - u1));
+    return r * std::cos(glm::two_pi<float>() * u2);
+  }
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSRNG_H
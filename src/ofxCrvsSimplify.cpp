@@ -0,0 +1,211 @@
+#include "ofxCrvsSimplify.h"
+
+#include <queue>
+
+namespace ofxCrvs {
+
+namespace {
+
+float distanceToSegmentSq(const glm::vec3 &p, const glm::vec3 &a,
+                          const glm::vec3 &b) {
+  const glm::vec3 ab = b - a;
+  const float lengthSq = glm::dot(ab, ab);
+  float t = 0.f;
+  if (lengthSq > 0.f)
+    t = clampValue(glm::dot(p - a, ab) / lengthSq, 0.f, 1.f);
+  const glm::vec3 d = p - (a + ab * t);
+  return glm::dot(d, d);
+}
+
+float triangleArea(const glm::vec3 &a, const glm::vec3 &b,
+                   const glm::vec3 &c) {
+  return 0.5f * glm::length(glm::cross(b - a, c - a));
+}
+
+} // namespace
+
+std::vector<glm::vec3>
+Simplify::gather(const std::vector<glm::vec3> &points,
+                 const std::vector<std::size_t> &indices) {
+  std::vector<glm::vec3> result(indices.size());
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    result[i] = points[indices[i]];
+  }
+  return result;
+}
+
+std::vector<std::size_t>
+Simplify::rdpIndices(const std::vector<glm::vec3> &points, float tolerance,
+                     int maxVertices) {
+  const std::size_t n = points.size();
+  std::vector<std::size_t> indices;
+  if (n <= 2) {
+    for (std::size_t i = 0; i < n; ++i)
+      indices.push_back(i);
+    return indices;
+  }
+
+  struct Segment {
+    std::size_t lo, hi, farthest;
+    float distSq;
+    bool operator<(const Segment &other) const {
+      return distSq < other.distSq;
+    }
+  };
+  auto makeSegment = [&points](std::size_t lo, std::size_t hi) {
+    Segment s{lo, hi, lo, -1.f};
+    for (std::size_t i = lo + 1; i < hi; ++i) {
+      const float d = distanceToSegmentSq(points[i], points[lo], points[hi]);
+      if (d > s.distSq) {
+        s.distSq = d;
+        s.farthest = i;
+      }
+    }
+    return s;
+  };
+
+  std::vector<bool> keep(n, false);
+  keep.front() = keep.back() = true;
+  std::size_t numKept = 2;
+  const float toleranceSq = tolerance * tolerance;
+  std::priority_queue<Segment> segments;
+  segments.push(makeSegment(0, n - 1));
+  while (!segments.empty()) {
+    const Segment s = segments.top();
+    if (s.distSq <= toleranceSq || s.hi - s.lo < 2)
+      break;
+    if (maxVertices > 0 && numKept >= static_cast<std::size_t>(maxVertices))
+      break;
+    segments.pop();
+    keep[s.farthest] = true;
+    ++numKept;
+    segments.push(makeSegment(s.lo, s.farthest));
+    segments.push(makeSegment(s.farthest, s.hi));
+  }
+
+  indices.reserve(numKept);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (keep[i])
+      indices.push_back(i);
+  }
+  return indices;
+}
+
+std::vector<glm::vec3> Simplify::rdp(const std::vector<glm::vec3> &points,
+                                     float tolerance, int maxVertices) {
+  return gather(points, rdpIndices(points, tolerance, maxVertices));
+}
+
+std::vector<std::size_t>
+Simplify::visvalingamIndices(const std::vector<glm::vec3> &points,
+                             float minArea, int maxVertices) {
+  const std::size_t n = points.size();
+  std::vector<std::size_t> indices;
+  if (n <= 2) {
+    for (std::size_t i = 0; i < n; ++i)
+      indices.push_back(i);
+    return indices;
+  }
+
+  // Linked list over the surviving points plus an indexed 4-ary min-heap of
+  // their effective areas. Keys are updated in place, so the heap only
+  // shrinks and never holds stale entries.
+  std::vector<std::size_t> prev(n), next(n);
+  std::vector<float> area(n);
+  std::vector<std::size_t> heap;
+  std::vector<std::size_t> heapPos(n);
+  heap.reserve(n - 2);
+  for (std::size_t i = 0; i < n; ++i) {
+    prev[i] = i - 1;
+    next[i] = i + 1;
+  }
+  for (std::size_t i = 1; i + 1 < n; ++i) {
+    area[i] = triangleArea(points[i - 1], points[i], points[i + 1]);
+    heapPos[i] = heap.size();
+    heap.push_back(i);
+  }
+
+  // Ties go to the earlier point so results don't depend on heap layout.
+  auto before = [&area](std::size_t a, std::size_t b) {
+    return area[a] < area[b] || (area[a] == area[b] && a < b);
+  };
+  auto place = [&](std::size_t slot, std::size_t point) {
+    heap[slot] = point;
+    heapPos[point] = slot;
+  };
+  auto siftDown = [&](std::size_t slot) {
+    const std::size_t point = heap[slot];
+    for (;;) {
+      const std::size_t first = slot * 4 + 1;
+      if (first >= heap.size())
+        break;
+      const std::size_t last = std::min(first + 4, heap.size());
+      std::size_t best = first;
+      for (std::size_t c = first + 1; c < last; ++c) {
+        if (before(heap[c], heap[best]))
+          best = c;
+      }
+      if (!before(heap[best], point))
+        break;
+      place(slot, heap[best]);
+      slot = best;
+    }
+    place(slot, point);
+  };
+  auto update = [&](std::size_t point) {
+    std::size_t slot = heapPos[point];
+    while (slot > 0 && before(point, heap[(slot - 1) / 4])) {
+      place(slot, heap[(slot - 1) / 4]);
+      slot = (slot - 1) / 4;
+    }
+    place(slot, point);
+    siftDown(slot);
+  };
+  for (std::size_t slot = heap.size(); slot-- > 0;) {
+    siftDown(slot);
+  }
+
+  std::size_t remaining = n;
+  const std::size_t budget =
+      maxVertices > 0 ? std::max<std::size_t>(maxVertices, 2) : n;
+  while (!heap.empty()) {
+    const std::size_t i = heap.front();
+    const float a = area[i];
+    if (a >= minArea && remaining <= budget)
+      break;
+    place(0, heap.back());
+    heap.pop_back();
+    if (!heap.empty())
+      siftDown(0);
+    --remaining;
+
+    const std::size_t p = prev[i];
+    const std::size_t q = next[i];
+    next[p] = q;
+    prev[q] = p;
+    // Neighbours never drop below the area just removed, so the removal
+    // order stays monotonic.
+    if (p > 0) {
+      area[p] = std::max(a, triangleArea(points[prev[p]], points[p], points[q]));
+      update(p);
+    }
+    if (q < n - 1) {
+      area[q] = std::max(a, triangleArea(points[p], points[q], points[next[q]]));
+      update(q);
+    }
+  }
+
+  indices.reserve(remaining);
+  for (std::size_t i = 0; i < n; i = next[i]) {
+    indices.push_back(i);
+  }
+  return indices;
+}
+
+std::vector<glm::vec3>
+Simplify::visvalingam(const std::vector<glm::vec3> &points, float minArea,
+                      int maxVertices) {
+  return gather(points, visvalingamIndices(points, minArea, maxVertices));
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef OFXCRVSSIMPLIFY_H
+#define OFXCRVSSIMPLIFY_H
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Polyline decimation for output devices with limited vertex throughput.
+ * Both methods keep the endpoints and take either a tolerance, a vertex
+ * budget (maxVertices > 0), or both.
+ */
+class Simplify {
+public:
+  // Ramer–Douglas–Peucker, splitting the worst segment first: stops once
+  // every dropped point is within tolerance or maxVertices are kept.
+  static std::vector<glm::vec3> rdp(const std::vector<glm::vec3> &points,
+                                    float tolerance, int maxVertices = 0);
+  static std::vector<std::size_t>
+  rdpIndices(const std::vector<glm::vec3> &points, float tolerance,
+             int maxVertices = 0);
+
+  // Visvalingam–Whyatt: repeatedly drops the point spanning the smallest
+  // triangle while that area is below minArea or more than maxVertices
+  // remain.
+  static std::vector<glm::vec3>
+  visvalingam(const std::vector<glm::vec3> &points, float minArea,
+              int maxVertices = 0);
+  static std::vector<std::size_t>
+  visvalingamIndices(const std::vector<glm::vec3> &points, float minArea,
+                     int maxVertices = 0);
+
+private:
+  static std::vector<glm::vec3>
+  gather(const std::vector<glm::vec3> &points,
+         const std::vector<std::size_t> &indices);
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSSIMPLIFY_H
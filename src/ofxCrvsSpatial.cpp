@@ -0,0 +1,290 @@
+#include "ofxCrvsSpatial.h"
+
+
+#include "ofxCrvsUtils.hpp"
+
+namespace ofxCrvs {
+
+glm::ivec3 HashGrid::cellOf(const glm::vec3 &p) const {
+  return {static_cast<int>(std::floor(p.x * invCellSize)),
+          static_cast<int>(std::floor(p.y * invCellSize)),
+          static_cast<int>(std::floor(p.z * invCellSize))};
+}
+
+std::uint32_t HashGrid::bucketOf(const glm::ivec3 &cell) const {
+  const std::uint32_t h = (static_cast<std::uint32_t>(cell.x) * 73856093u) ^
+                          (static_cast<std::uint32_t>(cell.y) * 19349663u) ^
+                          (static_cast<std::uint32_t>(cell.z) * 83492791u);
+  return h & tableMask;
+}
+
+void HashGrid::build(const glm::vec3 *points, std::size_t count,
+                     float cellSize, int numThreads) {
+  this->cellSize = cellSize > 0.f ? cellSize : 1.f;
+  invCellSize = 1.f / this->cellSize;
+
+  // A power-of-two table at least the point count keeps buckets short.
+  std::uint32_t tableSize = 1;
+  while (tableSize < count)
+    tableSize <<= 1;
+  tableMask = tableSize - 1;
+
+  pointCells.resize(count);
+  Utils::parallelFor(
+      count, 16384,
+      [this, points](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          pointCells[i] = bucketOf(cellOf(points[i]));
+        }
+      },
+      numThreads);
+
+  // Counting sort by bucket; buffers are reused across rebuilds.
+  cellStart.assign(tableSize + 1, 0);
+  for (std::size_t i = 0; i < count; ++i) {
+    cellStart[pointCells[i] + 1]++;
+  }
+  for (std::uint32_t b = 0; b < tableSize; ++b) {
+    cellStart[b + 1] += cellStart[b];
+  }
+  cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+  sortedIndices.resize(count);
+  sortedPoints.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::uint32_t slot = cellCursor[pointCells[i]]++;
+    sortedIndices[slot] = i;
+    sortedPoints[slot] = points[i];
+  }
+}
+
+void HashGrid::build(const std::vector<glm::vec3> &points, float cellSize,
+                     int numThreads) {
+  build(points.data(), points.size(), cellSize, numThreads);
+}
+
+template <typename Fn>
+void HashGrid::visitRadius(const glm::vec3 &center, float radius,
+                           Fn &&fn) const {
+  if (sortedPoints.empty())
+    return;
+  const float radiusSq = radius * radius;
+  const glm::ivec3 lo = cellOf(center - glm::vec3(radius));
+  const glm::ivec3 hi = cellOf(center + glm::vec3(radius));
+  const double numCells = (double(hi.x) - lo.x + 1) * (double(hi.y) - lo.y + 1) *
+                          (double(hi.z) - lo.z + 1);
+
+  auto visitBucket = [&](std::uint32_t b) {
+    for (std::uint32_t s = cellStart[b]; s < cellStart[b + 1]; ++s) {
+      const glm::vec3 d = sortedPoints[s] - center;
+      if (glm::dot(d, d) <= radiusSq)
+        fn(sortedIndices[s]);
+    }
+  };
+
+  if (numCells > tableMask) {
+    for (std::uint32_t b = 0; b <= tableMask; ++b)
+      visitBucket(b);
+    return;
+  }
+
+  // Distinct cells can hash to the same bucket, so dedupe before visiting.
+  thread_local std::vector<std::uint32_t> buckets;
+  buckets.clear();
+  for (int z = lo.z; z <= hi.z; ++z) {
+    for (int y = lo.y; y <= hi.y; ++y) {
+      for (int x = lo.x; x <= hi.x; ++x) {
+        buckets.push_back(bucketOf(glm::ivec3(x, y, z)));
+      }
+    }
+  }
+  std::sort(buckets.begin(), buckets.end());
+  buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+  for (const std::uint32_t b : buckets)
+    visitBucket(b);
+}
+
+void HashGrid::radius(const glm::vec3 &center, float radius,
+                      std::vector<std::size_t> &indices) const {
+  indices.clear();
+  visitRadius(center, radius, [&indices](std::size_t i) { indices.push_back(i); });
+}
+
+std::vector<std::size_t> HashGrid::radius(const glm::vec3 &center,
+                                          float radius) const {
+  std::vector<std::size_t> indices;
+  this->radius(center, radius, indices);
+  return indices;
+}
+
+void HashGrid::forEachInRadius(
+    const glm::vec3 &center, float radius,
+    const std::function<void(std::size_t)> &fn) const {
+  visitRadius(center, radius, fn);
+}
+
+void KdTree::build(const glm::vec3 *points, std::size_t count,
+                   int numThreads) {
+  // Partition points and their original indices together so the median
+  // selection compares contiguous data instead of chasing indices.
+  std::vector<Entry> entries(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    entries[i] = {points[i], i};
+  }
+  splitAxis.assign(count, 0);
+
+  if (numThreads <= 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  int parallelDepth = 0;
+  while ((1 << parallelDepth) < numThreads)
+    ++parallelDepth;
+  buildRange(entries, 0, count, parallelDepth);
+
+  this->points.resize(count);
+  indices.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    this->points[i] = entries[i].point;
+    indices[i] = entries[i].index;
+  }
+}
+
+void KdTree::build(const std::vector<glm::vec3> &points, int numThreads) {
+  build(points.data(), points.size(), numThreads);
+}
+
+void KdTree::buildRange(std::vector<Entry> &entries, std::size_t lo,
+                        std::size_t hi, int parallelDepth) {
+  if (hi - lo <= leafSize)
+    return;
+
+  // Split on the axis of largest extent; curve samples are often flat in z.
+  glm::vec3 mn(std::numeric_limits<float>::max());
+  glm::vec3 mx(std::numeric_limits<float>::lowest());
+  for (std::size_t i = lo; i < hi; ++i) {
+    mn = glm::min(mn, entries[i].point);
+    mx = glm::max(mx, entries[i].point);
+  }
+  const glm::vec3 extent = mx - mn;
+  std::uint8_t axis = 0;
+  if (extent.y > extent[axis])
+    axis = 1;
+  if (extent.z > extent[axis])
+    axis = 2;
+
+  const std::size_t mid = lo + (hi - lo) / 2;
+  std::nth_element(entries.begin() + lo, entries.begin() + mid,
+                   entries.begin() + hi,
+                   [axis](const Entry &a, const Entry &b) {
+                     return a.point[axis] < b.point[axis];
+                   });
+  splitAxis[mid] = axis;
+
+  if (parallelDepth > 0) {
+    std::thread left([this, &entries, lo, mid, parallelDepth]() {
+      buildRange(entries, lo, mid, parallelDepth - 1);
+    });
+    buildRange(entries, mid + 1, hi, parallelDepth - 1);
+    left.join();
+  } else {
+    buildRange(entries, lo, mid, 0);
+    buildRange(entries, mid + 1, hi, 0);
+  }
+}
+
+void KdTree::nearestRange(
+    std::size_t lo, std::size_t hi, const glm::vec3 &query, std::size_t k,
+    std::vector<std::pair<float, std::size_t>> &heap) const {
+  auto consider = [&](std::size_t i) {
+    const glm::vec3 d = points[i] - query;
+    const float distSq = glm::dot(d, d);
+    if (heap.size() < k) {
+      heap.emplace_back(distSq, i);
+      std::push_heap(heap.begin(), heap.end());
+    } else if (distSq < heap.front().first) {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.back() = {distSq, i};
+      std::push_heap(heap.begin(), heap.end());
+    }
+  };
+
+  if (hi - lo <= leafSize) {
+    for (std::size_t i = lo; i < hi; ++i)
+      consider(i);
+    return;
+  }
+
+  const std::size_t mid = lo + (hi - lo) / 2;
+  const int axis = splitAxis[mid];
+  consider(mid);
+  const float diff = query[axis] - points[mid][axis];
+  if (diff < 0.f) {
+    nearestRange(lo, mid, query, k, heap);
+    if (heap.size() < k || diff * diff < heap.front().first)
+      nearestRange(mid + 1, hi, query, k, heap);
+  } else {
+    nearestRange(mid + 1, hi, query, k, heap);
+    if (heap.size() < k || diff * diff < heap.front().first)
+      nearestRange(lo, mid, query, k, heap);
+  }
+}
+
+void KdTree::nearest(const glm::vec3 &query, std::size_t k,
+                     std::vector<std::size_t> &indices) const {
+  indices.clear();
+  if (k == 0 || points.empty())
+    return;
+  std::vector<std::pair<float, std::size_t>> heap;
+  heap.reserve(k);
+  nearestRange(0, points.size(), query, k, heap);
+  std::sort_heap(heap.begin(), heap.end());
+  indices.reserve(heap.size());
+  for (const auto &entry : heap) {
+    indices.push_back(this->indices[entry.second]);
+  }
+}
+
+std::vector<std::size_t> KdTree::nearest(const glm::vec3 &query,
+                                         std::size_t k) const {
+  std::vector<std::size_t> indices;
+  nearest(query, k, indices);
+  return indices;
+}
+
+void KdTree::radiusRange(std::size_t lo, std::size_t hi,
+                         const glm::vec3 &center, float radiusSq,
+                         std::vector<std::size_t> &indices) const {
+  auto consider = [&](std::size_t i) {
+    const glm::vec3 d = points[i] - center;
+    if (glm::dot(d, d) <= radiusSq)
+      indices.push_back(this->indices[i]);
+  };
+
+  if (hi - lo <= leafSize) {
+    for (std::size_t i = lo; i < hi; ++i)
+      consider(i);
+    return;
+  }
+
+  const std::size_t mid = lo + (hi - lo) / 2;
+  const int axis = splitAxis[mid];
+  consider(mid);
+  const float diff = center[axis] - points[mid][axis];
+  if (diff <= 0.f || diff * diff <= radiusSq)
+    radiusRange(lo, mid, center, radiusSq, indices);
+  if (diff >= 0.f || diff * diff <= radiusSq)
+    radiusRange(mid + 1, hi, center, radiusSq, indices);
+}
+
+void KdTree::radius(const glm::vec3 &center, float radius,
+                    std::vector<std::size_t> &indices) const {
+  indices.clear();
+  radiusRange(0, points.size(), center, radius * radius, indices);
+}
+
+std::vector<std::size_t> KdTree::radius(const glm::vec3 &center,
+                                        float radius) const {
+  std::vector<std::size_t> indices;
+  this->radius(center, radius, indices);
+  return indices;
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef OFXCRVSSPATIAL_H
+#define OFXCRVSSPATIAL_H
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Uniform hash grid for fixed-radius queries over clouds that change every
+ * frame. build() is a counting sort of the points by cell, O(n) per rebuild.
+ */
+class HashGrid {
+public:
+  HashGrid() = default;
+  HashGrid(const std::vector<glm::vec3> &points, float cellSize) {
+    build(points, cellSize);
+  }
+
+  void build(const glm::vec3 *points, std::size_t count, float cellSize,
+             int numThreads = 0);
+  void build(const std::vector<glm::vec3> &points, float cellSize,
+             int numThreads = 0);
+
+  void radius(const glm::vec3 &center, float radius,
+              std::vector<std::size_t> &indices) const;
+  std::vector<std::size_t> radius(const glm::vec3 &center, float radius) const;
+  void forEachInRadius(const glm::vec3 &center, float radius,
+                       const std::function<void(std::size_t)> &fn) const;
+
+  std::size_t size() const { return sortedPoints.size(); }
+  float getCellSize() const { return cellSize; }
+
+private:
+  float cellSize = 1.f;
+  float invCellSize = 1.f;
+  std::uint32_t tableMask = 0;
+  std::vector<std::uint32_t> cellStart;
+  std::vector<std::uint32_t> cellCursor;
+  std::vector<std::uint32_t> pointCells;
+  std::vector<std::size_t> sortedIndices;
+  std::vector<glm::vec3> sortedPoints;
+
+  glm::ivec3 cellOf(const glm::vec3 &p) const;
+  std::uint32_t bucketOf(const glm::ivec3 &cell) const;
+  template <typename Fn>
+  void visitRadius(const glm::vec3 &center, float radius, Fn &&fn) const;
+};
+
+/**
+ * Static k-d tree for k-nearest and radius queries. The tree is implicit in
+ * a median-partitioned copy of the points, so no nodes are allocated.
+ */
+class KdTree {
+public:
+  static constexpr std::size_t leafSize = 8;
+
+  KdTree() = default;
+  explicit KdTree(const std::vector<glm::vec3> &points) { build(points); }
+
+  void build(const glm::vec3 *points, std::size_t count, int numThreads = 0);
+  void build(const std::vector<glm::vec3> &points, int numThreads = 0);
+
+  void nearest(const glm::vec3 &query, std::size_t k,
+               std::vector<std::size_t> &indices) const;
+  std::vector<std::size_t> nearest(const glm::vec3 &query,
+                                   std::size_t k) const;
+  void radius(const glm::vec3 &center, float radius,
+              std::vector<std::size_t> &indices) const;
+  std::vector<std::size_t> radius(const glm::vec3 &center, float radius) const;
+
+  std::size_t size() const { return points.size(); }
+
+private:
+  std::vector<glm::vec3> points;
+  std::vector<std::size_t> indices;
+  std::vector<std::uint8_t> splitAxis;
+
+  struct Entry {
+    glm::vec3 point;
+    std::size_t index;
+  };
+
+  void buildRange(std::vector<Entry> &entries, std::size_t lo, std::size_t hi,
+                  int parallelDepth);
+  void nearestRange(std::size_t lo, std::size_t hi, const glm::vec3 &query,
+                    std::size_t k,
+                    std::vector<std::pair<float, std::size_t>> &heap) const;
+  void radiusRange(std::size_t lo, std::size_t hi, const glm::vec3 &center,
+                   float radiusSq, std::vector<std::size_t> &indices) const;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSSPATIAL_H
@@ -0,0 +1,157 @@
+#include "ofxCrvsSrfc.h"
+
+#include <stdexcept>
+
+#include "ofxCrvsConstants.h"
+
+namespace ofxCrvs {
+
+Srfc::Srfc(Box box, std::shared_ptr<Crv> uCrv, std::shared_ptr<Crv> vCrv)
+    : box(std::move(box)), uCrv(std::move(uCrv)), vCrv(std::move(vCrv)) {
+  if (!this->uCrv || !this->vCrv)
+    throw std::invalid_argument("Srfc: null Crv");
+}
+
+Srfc::Srfc(Box box, SrfcOp op) : box(std::move(box)), op(std::move(op)) {
+  if (!this->op)
+    throw std::invalid_argument("Srfc: empty SrfcOp");
+}
+
+void Srfc::allocate(int numU, int numV) {
+  this->numU = std::max(numU, 2);
+  this->numV = std::max(numV, 2);
+  uPoints.resize(this->numU);
+  uTangents.resize(this->numU);
+  vPoints.resize(this->numV);
+  vTangents.resize(this->numV);
+  vertices.resize(this->numU * this->numV);
+
+  // Texcoords and indices depend only on the grid size, so they are built here
+  // once and left untouched by update().
+  for (int j = 0; j < this->numV; ++j) {
+    const float v = static_cast<float>(j) / (this->numV - 1);
+    for (int i = 0; i < this->numU; ++i) {
+      const float u = static_cast<float>(i) / (this->numU - 1);
+      vertices[j * this->numU + i].texCoord = glm::vec2(u, v);
+    }
+  }
+
+  indices.clear();
+  indices.reserve((this->numU - 1) * (this->numV - 1) * 6);
+  for (int j = 0; j < this->numV - 1; ++j) {
+    for (int i = 0; i < this->numU - 1; ++i) {
+      const IndexType a = j * this->numU + i;
+      const IndexType b = a + 1;
+      const IndexType c = a + this->numU;
+      const IndexType d = c + 1;
+      indices.insert(indices.end(), {a, b, c, b, d, c});
+    }
+  }
+}
+
+void Srfc::sample(const Crv &crv, std::vector<glm::vec3> &points,
+                  bool transformed) {
+  const int numPoints = static_cast<int>(points.size());
+  for (int i = 0; i < numPoints; ++i) {
+    const float pos = static_cast<float>(i) / (numPoints - 1);
+    points[i] = crv.uVector(pos, transformed);
+  }
+}
+
+void Srfc::tangents(const std::vector<glm::vec3> &points,
+                    std::vector<glm::vec3> &tangents) {
+  const int last = static_cast<int>(points.size()) - 1;
+  tangents[0] = points[1] - points[0];
+  for (int i = 1; i < last; ++i) {
+    tangents[i] = (points[i + 1] - points[i - 1]) * 0.5f;
+  }
+  tangents[last] = points[last] - points[last - 1];
+}
+
+void Srfc::update(bool boxed, bool transformed) {
+  if (numU < 2 || numV < 2)
+    return;
+  if (op) {
+    updateGrid(boxed);
+  } else {
+    // The curves are public, so they can have been reset since construction
+    if (!uCrv || !vCrv)
+      throw std::runtime_error("Srfc: needs a uCrv and a vCrv, or a SrfcOp");
+    updateTranslational(boxed, transformed);
+  }
+}
+
+void Srfc::updateTranslational(bool boxed, bool transformed) {
+  sample(*uCrv, uPoints, transformed);
+  sample(*vCrv, vPoints, transformed);
+
+  // The box is affine, so boxing both curves and the center is the same as
+  // boxing every vertex of their sum.
+  glm::vec3 center = UCENTER;
+  if (boxed) {
+    for (auto &p : uPoints)
+      box.apply(p);
+    for (auto &p : vPoints)
+      box.apply(p);
+    box.apply(center);
+  }
+
+  tangents(uPoints, uTangents);
+  tangents(vPoints, vTangents);
+
+  for (int j = 0; j < numV; ++j) {
+    const glm::vec3 offset = vPoints[j] - center;
+    const glm::vec3 &vTangent = vTangents[j];
+    Vertex *row = &vertices[j * numU];
+    for (int i = 0; i < numU; ++i) {
+      row[i].position = uPoints[i] + offset;
+      const glm::vec3 n = glm::cross(uTangents[i], vTangent);
+      const float len = glm::length(n);
+      row[i].normal = len > 0.f ? n / len : Z_AXIS;
+    }
+  }
+}
+
+void Srfc::updateGrid(bool boxed) {
+  for (int j = 0; j < numV; ++j) {
+    const float v = static_cast<float>(j) / (numV - 1);
+    Vertex *row = &vertices[j * numU];
+    for (int i = 0; i < numU; ++i) {
+      row[i].position = op(static_cast<float>(i) / (numU - 1), v);
+      if (boxed)
+        box.apply(row[i].position);
+    }
+  }
+
+  // Central differences inside the grid, one-sided along its edges
+  for (int j = 0; j < numV; ++j) {
+    const int below = std::max(j - 1, 0);
+    const int above = std::min(j + 1, numV - 1);
+    for (int i = 0; i < numU; ++i) {
+      const int left = std::max(i - 1, 0);
+      const int right = std::min(i + 1, numU - 1);
+      const glm::vec3 du = vertices[j * numU + right].position -
+                           vertices[j * numU + left].position;
+      const glm::vec3 dv = vertices[above * numU + i].position -
+                           vertices[below * numU + i].position;
+      const glm::vec3 n = glm::cross(du, dv);
+      const float len = glm::length(n);
+      vertices[j * numU + i].normal = len > 0.f ? n / len : Z_AXIS;
+    }
+  }
+}
+
+// Before allocate() there are no vertices to point at
+const float *Srfc::getPositionData() const {
+  return vertices.empty() ? nullptr : &vertices.data()->position.x;
+}
+
+const float *Srfc::getNormalData() const {
+  return vertices.empty() ? nullptr : &vertices.data()->normal.x;
+}
+
+const float *Srfc::getTexCoordData() const {
+  return vertices.empty() ? nullptr : &vertices.data()->texCoord.x;
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef OFXCRVSSRFC_H
+#define OFXCRVSSRFC_H
+
+#include <functional>
+#include <utility>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsBox.hpp"
+#include "ofxCrvsCrv.h"
+
+namespace ofxCrvs {
+
+// A surface as a point for each (u, v) in [0, 1]², in the same unit space
+// as Crv::uVector()
+using SrfcOp = std::function<glm::vec3(float u, float v)>;
+
+/**
+ * A u×v surface laid out as interleaved position/normal/texcoord vertices
+ * ready for ofVbo upload, re-evaluated into the same buffers each update.
+ *
+ * Built from a SrfcOp, every update evaluates the full numU × numV grid,
+ * so any surface works, tori and spheres included; normals come from the
+ * grid's neighbouring vertices.
+ *
+ * Built from two curves (typically Msh), the surface is translational:
+ * P(u, v) = U(u) + V(v) - UCENTER. Each update then only evaluates
+ * numU + numV curve points regardless of grid size, but its cross-section
+ * can't change along v; use a SrfcOp for anything else.
+ */
+class Srfc {
+public:
+  struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+  };
+
+  static constexpr int stride = sizeof(Vertex);
+
+  Box box;
+  std::shared_ptr<Crv> uCrv;
+  std::shared_ptr<Crv> vCrv;
+  SrfcOp op;
+
+  static std::shared_ptr<Srfc> create(const std::shared_ptr<Crv> &uCrv,
+                                      const std::shared_ptr<Crv> &vCrv) {
+    return std::make_shared<Srfc>(uCrv, vCrv);
+  }
+  static std::shared_ptr<Srfc> create(SrfcOp op) {
+    return std::make_shared<Srfc>(std::move(op));
+  }
+
+  Srfc(std::shared_ptr<Crv> uCrv, std::shared_ptr<Crv> vCrv)
+      : Srfc(Box(getViewWidth(), getViewHeight(), getViewHeight()),
+             std::move(uCrv), std::move(vCrv)) {}
+
+  Srfc(Box box, std::shared_ptr<Crv> uCrv, std::shared_ptr<Crv> vCrv);
+
+  explicit Srfc(SrfcOp op)
+      : Srfc(Box(getViewWidth(), getViewHeight(), getViewHeight()),
+             std::move(op)) {}
+
+  Srfc(Box box, SrfcOp op);
+
+  void allocate(int numU, int numV);
+  // transformed applies the curves' transforms and is ignored for a
+  // SrfcOp, whose points are used as they are
+  void update(bool boxed, bool transformed);
+
+  int getNumU() const { return numU; }
+  int getNumV() const { return numV; }
+  int getNumVertices() const { return numU * numV; }
+  int getNumIndices() const { return static_cast<int>(indices.size()); }
+
+  const std::vector<Vertex> &getVertices() const { return vertices; }
+  const std::vector<IndexType> &getIndices() const { return indices; }
+  const float *getPositionData() const;
+  const float *getNormalData() const;
+  const float *getTexCoordData() const;
+
+private:
+  int numU = 0;
+  int numV = 0;
+  std::vector<glm::vec3> uPoints;
+  std::vector<glm::vec3> vPoints;
+  std::vector<glm::vec3> uTangents;
+  std::vector<glm::vec3> vTangents;
+  std::vector<Vertex> vertices;
+  std::vector<IndexType> indices;
+
+  static void sample(const Crv &crv, std::vector<glm::vec3> &points,
+                     bool transformed);
+  static void tangents(const std::vector<glm::vec3> &points,
+                       std::vector<glm::vec3> &tangents);
+  void updateTranslational(bool boxed, bool transformed);
+  void updateGrid(bool boxed);
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSSRFC_H
@@ -0,0 +1,129 @@
+#include "ofxCrvsStrm.h"
+
+namespace ofxCrvs {
+
+namespace {
+
+std::size_t nextPowerOfTwo(std::size_t n) {
+  std::size_t p = 1;
+  while (p < n)
+    p <<= 1;
+  return p;
+}
+
+} // namespace
+
+Strm::Strm(const std::size_t window, const bool normalized)
+    : window(std::max<std::size_t>(window, 1)), normalized(normalized),
+      mask(nextPowerOfTwo(this->window * 2) - 1),
+      ring(new std::atomic<float>[mask + 1]) {
+  for (std::size_t i = 0; i <= mask; ++i) {
+    ring[i].store(0.f, std::memory_order_relaxed);
+  }
+  minQueue.indices.resize(nextPowerOfTwo(this->window + 1));
+  maxQueue.indices.resize(nextPowerOfTwo(this->window + 1));
+}
+
+float Strm::valueAt(const std::uint64_t index) const {
+  return ring[index & mask].load(std::memory_order_relaxed);
+}
+
+template <typename Compare>
+void Strm::slide(MonotonicQueue &queue, const std::uint64_t index,
+                 const float value, Compare keep) {
+  const std::size_t queueMask = queue.indices.size() - 1;
+  // Drop samples that left the window, then those the new one dominates
+  while (queue.front != queue.back &&
+         queue.indices[queue.front & queueMask] + window <= index) {
+    ++queue.front;
+  }
+  while (queue.front != queue.back &&
+         !keep(valueAt(queue.indices[(queue.back - 1) & queueMask]), value)) {
+    --queue.back;
+  }
+  queue.indices[queue.back & queueMask] = index;
+  ++queue.back;
+}
+
+void Strm::push(const float value) {
+  ring[count & mask].store(value, std::memory_order_relaxed);
+  slide(minQueue, count, value, std::less<float>());
+  slide(maxQueue, count, value, std::greater<float>());
+  ++count;
+  publish();
+}
+
+void Strm::push(const float *values, const std::size_t numValues) {
+  for (std::size_t i = 0; i < numValues; ++i) {
+    ring[count & mask].store(values[i], std::memory_order_relaxed);
+    slide(minQueue, count, values[i], std::less<float>());
+    slide(maxQueue, count, values[i], std::greater<float>());
+    ++count;
+  }
+  publish();
+}
+
+void Strm::publish() {
+  const std::size_t minMask = minQueue.indices.size() - 1;
+  const std::size_t maxMask = maxQueue.indices.size() - 1;
+  const std::uint32_t seq = sequence.load(std::memory_order_relaxed);
+  sequence.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  publishedHead.store(count, std::memory_order_relaxed);
+  publishedMin.store(valueAt(minQueue.indices[minQueue.front & minMask]),
+                     std::memory_order_relaxed);
+  publishedMax.store(valueAt(maxQueue.indices[maxQueue.front & maxMask]),
+                     std::memory_order_relaxed);
+  sequence.store(seq + 2, std::memory_order_release);
+}
+
+Strm::View Strm::view() const {
+  View snapshot;
+  std::uint32_t before;
+  std::uint32_t after;
+  do {
+    before = sequence.load(std::memory_order_acquire);
+    snapshot.head = publishedHead.load(std::memory_order_relaxed);
+    snapshot.min = publishedMin.load(std::memory_order_relaxed);
+    snapshot.max = publishedMax.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    after = sequence.load(std::memory_order_relaxed);
+  } while ((before & 1) != 0 || before != after);
+  return snapshot;
+}
+
+std::size_t Strm::size() const {
+  return static_cast<std::size_t>(
+      std::min<std::uint64_t>(view().head, window));
+}
+
+float Strm::at(const View &snapshot, const float pos) const {
+  const std::uint64_t available =
+      std::min<std::uint64_t>(snapshot.head, window);
+  if (available == 0)
+    return 0.f;
+  const std::uint64_t first = snapshot.head - available;
+  float value;
+  if (available == 1) {
+    value = valueAt(first);
+  } else {
+    const float exact = clampValue(pos, 0.f, 1.f) * (available - 1);
+    const std::uint64_t index =
+        std::min(static_cast<std::uint64_t>(exact), available - 2);
+    const float fraction = exact - index;
+    value = lerpValue(valueAt(first + index), valueAt(first + index + 1),
+                      fraction);
+  }
+  if (!normalized)
+    return value;
+  const float range = snapshot.max - snapshot.min;
+  if (range <= 0.f)
+    return 0.5f;
+  return clampValue((value - snapshot.min) / range, 0.f, 1.f);
+}
+
+FloatOp Strm::op() const {
+  return [this](const float pos) { return at(pos); };
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,89 @@
+#pragma once
+
+#ifndef OFXCRVSSTRM_H
+#define OFXCRVSSTRM_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsOps.h"
+
+namespace ofxCrvs {
+
+/**
+ * Streaming timeseries for live feeds. One producer thread push()es samples
+ * into a fixed ring buffer; any number of consumers play back the latest
+ * window of samples as a FloatOp, normalized by the window's min and max.
+ * The min and max are kept incrementally with monotonic queues, so a push
+ * is O(1) amortized and nothing is copied or reallocated after
+ * construction.
+ *
+ * Readers never block the producer. The ring holds twice the window, so a
+ * reader that is a whole window of pushes behind can see newer samples in
+ * place of the oldest ones.
+ */
+class Strm {
+public:
+  // What a reader sees: the newest sample index (one past it) and the
+  // window's range at that moment.
+  struct View {
+    std::uint64_t head = 0;
+    float min = 0.f;
+    float max = 0.f;
+  };
+
+  explicit Strm(std::size_t window, bool normalized = true);
+
+  // Producer side; only one thread may push.
+  void push(float value);
+  void push(const float *values, std::size_t count);
+
+  // Consistent snapshot of the newest window
+  [[nodiscard]] View view() const;
+
+  // Value at pos in [0, 1] across the window, oldest to newest
+  [[nodiscard]] float at(const View &snapshot, float pos) const;
+  [[nodiscard]] float at(float pos) const { return at(view(), pos); };
+
+  // Reads the live window on every call; capture a View and use at() to pin
+  // one frame instead. The Strm must outlive the op; Ops::timeseries() takes
+  // a shared_ptr when it may not.
+  [[nodiscard]] FloatOp op() const;
+
+  [[nodiscard]] std::size_t getWindow() const { return window; };
+  [[nodiscard]] std::size_t size() const;
+
+private:
+  // Fixed-capacity index queue for the sliding min/max; producer only
+  struct MonotonicQueue {
+    vector<std::uint64_t> indices;
+    std::size_t front = 0;
+    std::size_t back = 0;
+  };
+
+  template <typename Compare>
+  void slide(MonotonicQueue &queue, std::uint64_t index, float value,
+             Compare keep);
+  float valueAt(std::uint64_t index) const;
+  void publish();
+
+  std::size_t window;
+  bool normalized;
+  std::size_t mask;
+  std::unique_ptr<std::atomic<float>[]> ring;
+
+  MonotonicQueue minQueue;
+  MonotonicQueue maxQueue;
+  std::uint64_t count = 0;
+
+  // Seqlock around the published View: odd while the producer writes
+  mutable std::atomic<std::uint32_t> sequence{0};
+  std::atomic<std::uint64_t> publishedHead{0};
+  std::atomic<float> publishedMin{0.f};
+  std::atomic<float> publishedMax{0.f};
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSSTRM_H
@@ -0,0 +1,597 @@
+#include "ofxCrvsTable.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ofxCrvs {
+
+namespace {
+
+// Samples or words buffered per write while streaming a channel
+constexpr std::size_t chunkSize = 4096;
+
+enum Flags : std::uint8_t {
+  BOXED = 1 << 0,
+  TRANSFORMED = 1 << 1,
+  REVERSED = 1 << 2,
+};
+
+bool littleEndian() {
+  const std::uint32_t one = 1;
+  std::uint8_t first;
+  std::memcpy(&first, &one, 1);
+  return first == 1;
+}
+
+std::uint64_t dataSize(const TableChannel::Type type,
+                       const std::uint64_t size) {
+  return type == TableChannel::Type::FLOATS ? size * sizeof(float)
+                                            : (size + 63) / 64 * 8;
+}
+
+class Bytes {
+public:
+  void u8(std::uint8_t v) { bytes.push_back(v); }
+  void u32(std::uint32_t v) { raw(&v, sizeof(v)); }
+  void u64(std::uint64_t v) { raw(&v, sizeof(v)); }
+  void f32(float v) { raw(&v, sizeof(v)); }
+  void str(const std::string &s) {
+    u32(static_cast<std::uint32_t>(s.size()));
+    raw(s.data(), s.size());
+  }
+  void raw(const void *data, std::size_t size) {
+    const auto *p = static_cast<const std::uint8_t *>(data);
+    bytes.insert(bytes.end(), p, p + size);
+  }
+  vector<std::uint8_t> bytes;
+};
+
+class Cursor {
+public:
+  Cursor(const std::uint8_t *data, std::size_t size, const std::string &path)
+      : data(data), size(size), path(path) {}
+  std::uint8_t u8() { return get<std::uint8_t>(); }
+  std::uint32_t u32() { return get<std::uint32_t>(); }
+  std::uint64_t u64() { return get<std::uint64_t>(); }
+  float f32() { return get<float>(); }
+  std::string str() {
+    const std::uint32_t n = u32();
+    need(n);
+    std::string s(reinterpret_cast<const char *>(data + offset), n);
+    offset += n;
+    return s;
+  }
+
+private:
+  template <typename T> T get() {
+    need(sizeof(T));
+    T v;
+    std::memcpy(&v, data + offset, sizeof(T));
+    offset += sizeof(T);
+    return v;
+  }
+  void need(std::size_t n) const {
+    if (n > size - offset)
+      throw std::runtime_error("TableFile: truncated directory in " + path);
+  }
+  const std::uint8_t *data;
+  std::size_t size;
+  std::size_t offset = 0;
+  const std::string &path;
+};
+
+// Ptrn's tables are X, Y and Z; anything else reads Y, as in Ptrn
+int axisOf(const Component component) {
+  switch (component) {
+  case Component::X:
+    return 0;
+  case Component::Z:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+// Ptrn's indexing, fmod(reversed ? 1 - pos : pos, 1) * size, with negative
+// positions wrapped too; size must be positive
+std::size_t indexAt(const float pos, const std::size_t size,
+                    const bool reversed) {
+  float from = std::fmod(reversed ? 1.f - pos : pos, 1.f);
+  if (from < 0.f)
+    from += 1.f;
+  return std::min(static_cast<std::size_t>(from * size), size - 1);
+}
+
+// Throws std::out_of_range unless 0 <= index < size
+std::size_t checkedIndex(const int index, const std::size_t size) {
+  if (index < 0 || static_cast<std::size_t>(index) >= size)
+    throw std::out_of_range("TablePtrn: no step " + std::to_string(index) +
+                            " of " + std::to_string(size));
+  return static_cast<std::size_t>(index);
+}
+
+} // namespace
+
+float TableFloats::at(const float pos) const {
+  if (size < 2)
+    return size == 0 ? 0.f : data[0];
+  // Double, so long renders interpolate between their own samples
+  const double exactPos =
+      std::clamp(static_cast<double>(pos), 0.0, 1.0) * (size - 1);
+  const std::size_t index =
+      std::min(static_cast<std::size_t>(exactPos), size - 2);
+  const float fraction = static_cast<float>(exactPos - index);
+  return data[index] * (1.f - fraction) + data[index + 1] * fraction;
+}
+
+std::size_t TableBits::count() const {
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < (size + 63) / 64; ++i)
+    total += std::bitset<64>(words[i]).count();
+  return total;
+}
+
+float TablePtrn::trigAt(const float pos, const Component component) const {
+  const int axis = axisOf(component);
+  const TableBits &bits = trigs[axis];
+  if (bits.size == 0)
+    return 0.f;
+  return bits[indexAt(pos, bits.size, trigsReversed[axis])] ? 1.f : 0.f;
+}
+
+float TablePtrn::trigAt(const int index, const Component component) const {
+  const TableBits &bits = trigs[axisOf(component)];
+  return bits[checkedIndex(index, bits.size)] ? 1.f : 0.f;
+}
+
+float TablePtrn::valueAt(const float pos, const Component component) const {
+  const int axis = axisOf(component);
+  const TableFloats &table = values[axis];
+  if (table.size == 0)
+    return 0.f;
+  return table[indexAt(pos, table.size, valuesReversed[axis])];
+}
+
+float TablePtrn::valueAt(const int index, const Component component) const {
+  const TableFloats &table = values[axisOf(component)];
+  return table[checkedIndex(index, table.size)];
+}
+
+int TablePtrn::numTrigSteps(const Component component) const {
+  return static_cast<int>(trigs[axisOf(component)].size);
+}
+
+int TablePtrn::numValueSteps(const Component component) const {
+  return static_cast<int>(values[axisOf(component)].size);
+}
+
+TableWriter::TableWriter(const std::string &path) : path(path) {
+  if (!littleEndian())
+    throw std::runtime_error("TableWriter: tables are little-endian only");
+  out.open(path, std::ios::binary | std::ios::trunc);
+  if (!out)
+    throw std::runtime_error("TableWriter: can't write " + path);
+  const std::uint8_t header[headerSize] = {};
+  write(header, headerSize);
+}
+
+TableWriter::~TableWriter() {
+  try {
+    finish();
+  } catch (...) {
+  }
+}
+
+void TableWriter::setMetadata(const std::string &key,
+                              const std::string &value) {
+  metadata[key] = value;
+}
+
+void TableWriter::write(const void *bytes, const std::size_t size) {
+  out.write(static_cast<const char *>(bytes),
+            static_cast<std::streamsize>(size));
+  if (!out)
+    throw std::runtime_error("TableWriter: can't write " + path);
+  offset += size;
+}
+
+void TableWriter::begin(const TableChannel &info,
+                        const TableChannel::Type type) {
+  if (finished)
+    throw std::runtime_error("TableWriter: " + path + " is finished");
+  for (const TableChannel &channel : channels) {
+    if (channel.name == info.name)
+      throw std::invalid_argument("TableWriter: duplicate channel " +
+                                  info.name);
+  }
+  const std::uint8_t padding[alignment] = {};
+  write(padding, (alignment - offset % alignment) % alignment);
+  TableChannel channel = info;
+  channel.type = type;
+  channel.size = 0;
+  channel.data = nullptr;
+  channels.push_back(std::move(channel));
+  offsets.push_back(offset);
+}
+
+void TableWriter::end(const std::uint64_t size) { channels.back().size = size; }
+
+void TableWriter::addFloats(const TableChannel &info, const float *values,
+                            const std::size_t count) {
+  begin(info, TableChannel::Type::FLOATS);
+  write(values, count * sizeof(float));
+  end(count);
+}
+
+void TableWriter::addBits(const TableChannel &info, const float *trigs,
+                          const std::size_t count) {
+  begin(info, TableChannel::Type::BITS);
+  std::uint64_t words[chunkSize];
+  std::size_t numWords = 0;
+  for (std::size_t i = 0; i < count; i += 64) {
+    std::uint64_t word = 0;
+    const std::size_t n = std::min<std::size_t>(64, count - i);
+    for (std::size_t bit = 0; bit < n; ++bit) {
+      if (trigs[i + bit] != 0.f)
+        word |= std::uint64_t{1} << bit;
+    }
+    words[numWords++] = word;
+    if (numWords == chunkSize) {
+      write(words, sizeof(words));
+      numWords = 0;
+    }
+  }
+  write(words, numWords * sizeof(std::uint64_t));
+  end(count);
+}
+
+template <typename Sample>
+void TableWriter::addSampled(const TableChannel &info,
+                             const std::size_t numSamples, Sample &&sample) {
+  begin(info, TableChannel::Type::FLOATS);
+  float samples[chunkSize];
+  const double step = numSamples > 1 ? 1.0 / (numSamples - 1) : 0.0;
+  for (std::size_t start = 0; start < numSamples; start += chunkSize) {
+    const std::size_t n = std::min(chunkSize, numSamples - start);
+    for (std::size_t i = 0; i < n; ++i)
+      samples[i] = sample(static_cast<float>((start + i) * step));
+    write(samples, n * sizeof(float));
+  }
+  end(numSamples);
+}
+
+void TableWriter::addOp(const std::string &name, const FloatOp &op,
+                        const std::size_t numSamples) {
+  TableChannel info;
+  info.name = name;
+  info.resolution = static_cast<std::uint32_t>(numSamples);
+  addSampled(info, numSamples, op);
+}
+
+void TableWriter::addComponent(const std::string &name, const Crv &crv,
+                               const std::size_t numSamples,
+                               const Component component) {
+  float (Crv::*at)(float) const = &Crv::yAt;
+  switch (component) {
+  case Component::X:
+    at = &Crv::xAt;
+    break;
+  case Component::Z:
+    at = &Crv::zAt;
+    break;
+  case Component::W:
+    at = &Crv::wAt;
+    break;
+  default:
+    break;
+  }
+  TableChannel info;
+  info.name = name;
+  info.component = component;
+  info.resolution = static_cast<std::uint32_t>(numSamples);
+  addSampled(info, numSamples,
+             [&crv, at](const float pos) { return (crv.*at)(pos); });
+}
+
+void TableWriter::addPoints(const std::string &name, const Crv &crv,
+                            const std::size_t numPoints, const bool boxed,
+                            const bool transformed) {
+  TableChannel info;
+  info.resolution = static_cast<std::uint32_t>(numPoints);
+  info.boxed = boxed;
+  info.transformed = transformed;
+  info.boxPosition = crv.box.getPosition();
+  info.boxSize = {crv.box.getWidth(), crv.box.getHeight(), crv.box.getDepth()};
+  // Channels are written one after another, so each samples the curve
+  // again rather than holding the whole render
+  const char *suffixes[] = {".x", ".y", ".z"};
+  for (int c = 0; c < 3; ++c) {
+    info.name = name + suffixes[c];
+    info.component = static_cast<Component>(c);
+    addSampled(info, numPoints, [&](const float pos) {
+      return (boxed ? crv.wVector(pos, transformed)
+                    : crv.uVector(pos, transformed))[c];
+    });
+  }
+}
+
+void TableWriter::addPtrn(const std::string &name, const Ptrn &ptrn) {
+  const std::array<vector<float>, 3> trigs = {ptrn.trigsX(), ptrn.trigsY(),
+                                              ptrn.trigsZ()};
+  const std::array<vector<float>, 3> values = {
+      ptrn.valuesX(), ptrn.valuesY(), ptrn.valuesZ()};
+  const std::array<bool, 3> trigsTransformed = {ptrn.getTrigXTransformed(),
+                                                ptrn.getTrigYTransformed(),
+                                                ptrn.getTrigZTransformed()};
+  const std::array<bool, 3> trigsReversed = {ptrn.getTrigXReversed(),
+                                             ptrn.getTrigYReversed(),
+                                             ptrn.getTrigZReversed()};
+  const std::array<bool, 3> valuesTransformed = {
+      ptrn.getValueXTransformed(), ptrn.getValueYTransformed(),
+      ptrn.getValueZTransformed()};
+  const std::array<bool, 3> valuesReversed = {ptrn.getValueXReversed(),
+                                              ptrn.getValueYReversed(),
+                                              ptrn.getValueZReversed()};
+  const char *axes[] = {"X", "Y", "Z"};
+  for (int c = 0; c < 3; ++c) {
+    TableChannel info;
+    info.component = static_cast<Component>(c);
+    info.name = name + ".trig" + axes[c];
+    info.resolution = static_cast<std::uint32_t>(trigs[c].size());
+    info.transformed = trigsTransformed[c];
+    info.reversed = trigsReversed[c];
+    addBits(info, trigs[c].data(), trigs[c].size());
+    info.name = name + ".value" + axes[c];
+    info.resolution = static_cast<std::uint32_t>(values[c].size());
+    info.transformed = valuesTransformed[c];
+    info.reversed = valuesReversed[c];
+    addFloats(info, values[c].data(), values[c].size());
+  }
+}
+
+void TableWriter::finish() {
+  if (finished)
+    return;
+  const std::uint64_t directoryOffset = offset;
+  Bytes directory;
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    const TableChannel &channel = channels[i];
+    directory.u8(static_cast<std::uint8_t>(channel.type));
+    directory.u8(static_cast<std::uint8_t>(channel.component));
+    directory.u8((channel.boxed ? BOXED : 0) |
+                 (channel.transformed ? TRANSFORMED : 0) |
+                 (channel.reversed ? REVERSED : 0));
+    directory.u8(0);
+    directory.u32(channel.resolution);
+    for (int c = 0; c < 3; ++c)
+      directory.f32(channel.boxPosition[c]);
+    for (int c = 0; c < 3; ++c)
+      directory.f32(channel.boxSize[c]);
+    directory.u64(offsets[i]);
+    directory.u64(channel.size);
+    directory.str(channel.name);
+  }
+  directory.u32(static_cast<std::uint32_t>(metadata.size()));
+  for (const auto &[key, value] : metadata) {
+    directory.str(key);
+    directory.str(value);
+  }
+  write(directory.bytes.data(), directory.bytes.size());
+
+  Bytes header;
+  header.u32(magic);
+  header.u32(formatVersion);
+  header.u32(static_cast<std::uint32_t>(channels.size()));
+  header.u32(0);
+  header.u64(directoryOffset);
+  header.u64(directory.bytes.size());
+  header.bytes.resize(headerSize, 0);
+  out.seekp(0);
+  write(header.bytes.data(), header.bytes.size());
+  out.close();
+  if (!out)
+    throw std::runtime_error("TableWriter: can't write " + path);
+  finished = true;
+}
+
+std::shared_ptr<const TableFile> TableFile::open(const std::string &path) {
+  // The constructor is private, so no make_shared
+  std::shared_ptr<TableFile> file(new TableFile());
+  file->map(path);
+  file->readDirectory(path);
+  return file;
+}
+
+#ifdef _WIN32
+void TableFile::map(const std::string &path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("TableFile: can't read " + path);
+  fileHandle = file;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size))
+    throw std::runtime_error("TableFile: can't read " + path);
+  length = static_cast<std::size_t>(size.QuadPart);
+  if (length < TableWriter::headerSize)
+    throw std::runtime_error("TableFile: " + path + " is not a table");
+  mappingHandle =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mappingHandle)
+    throw std::runtime_error("TableFile: can't map " + path);
+  base = static_cast<const std::uint8_t *>(
+      MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!base)
+    throw std::runtime_error("TableFile: can't map " + path);
+}
+
+TableFile::~TableFile() {
+  if (base)
+    UnmapViewOfFile(base);
+  if (mappingHandle)
+    CloseHandle(mappingHandle);
+  if (fileHandle)
+    CloseHandle(fileHandle);
+}
+#else
+void TableFile::map(const std::string &path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("TableFile: can't read " + path);
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw std::runtime_error("TableFile: can't read " + path);
+  }
+  if (static_cast<std::size_t>(info.st_size) < TableWriter::headerSize) {
+    ::close(fd);
+    throw std::runtime_error("TableFile: " + path + " is not a table");
+  }
+  void *data = mmap(nullptr, static_cast<std::size_t>(info.st_size),
+                    PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps the file alive on its own
+  ::close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("TableFile: can't map " + path);
+  base = static_cast<const std::uint8_t *>(data);
+  length = static_cast<std::size_t>(info.st_size);
+}
+
+TableFile::~TableFile() {
+  if (base)
+    munmap(const_cast<std::uint8_t *>(base), length);
+}
+#endif
+
+void TableFile::readDirectory(const std::string &path) {
+  Cursor header(base, TableWriter::headerSize, path);
+  if (header.u32() != TableWriter::magic)
+    throw std::runtime_error("TableFile: " + path + " is not a table");
+  version = header.u32();
+  if (version > TableWriter::formatVersion)
+    throw std::runtime_error("TableFile: " + path + " has version " +
+                             std::to_string(version) + ", newer than " +
+                             std::to_string(TableWriter::formatVersion));
+  const std::uint32_t numChannels = header.u32();
+  header.u32();
+  const std::uint64_t directoryOffset = header.u64();
+  const std::uint64_t directorySize = header.u64();
+  if (directoryOffset < TableWriter::headerSize ||
+      directoryOffset > length || directorySize > length - directoryOffset)
+    throw std::runtime_error("TableFile: truncated directory in " + path);
+
+  Cursor directory(base + directoryOffset, directorySize, path);
+  channels.reserve(numChannels);
+  for (std::uint32_t i = 0; i < numChannels; ++i) {
+    TableChannel channel;
+    const std::uint8_t type = directory.u8();
+    const std::uint8_t component = directory.u8();
+    const std::uint8_t flags = directory.u8();
+    directory.u8();
+    if (type > static_cast<std::uint8_t>(TableChannel::Type::BITS) ||
+        component > static_cast<std::uint8_t>(Component::W))
+      throw std::runtime_error("TableFile: bad channel in " + path);
+    channel.type = static_cast<TableChannel::Type>(type);
+    channel.component = static_cast<Component>(component);
+    channel.boxed = flags & BOXED;
+    channel.transformed = flags & TRANSFORMED;
+    channel.reversed = flags & REVERSED;
+    channel.resolution = directory.u32();
+    for (int c = 0; c < 3; ++c)
+      channel.boxPosition[c] = directory.f32();
+    for (int c = 0; c < 3; ++c)
+      channel.boxSize[c] = directory.f32();
+    const std::uint64_t offset = directory.u64();
+    channel.size = directory.u64();
+    channel.name = directory.str();
+    // Sizes are checked against the file before they can overflow
+    if (offset % TableWriter::alignment != 0 || offset > directoryOffset ||
+        channel.size > directoryOffset ||
+        dataSize(channel.type, channel.size) > directoryOffset - offset)
+      throw std::runtime_error("TableFile: channel " + channel.name +
+                               " lies outside " + path);
+    channel.data = base + offset;
+    channelIndex[channel.name] = channels.size();
+    channels.push_back(std::move(channel));
+  }
+  const std::uint32_t numMetadata = directory.u32();
+  for (std::uint32_t i = 0; i < numMetadata; ++i) {
+    std::string key = directory.str();
+    metadata[key] = directory.str();
+  }
+}
+
+const TableChannel *TableFile::find(const std::string &name) const {
+  const auto it = channelIndex.find(name);
+  return it == channelIndex.end() ? nullptr : &channels[it->second];
+}
+
+const TableChannel &TableFile::channel(const std::string &name) const {
+  const TableChannel *found = find(name);
+  if (!found)
+    throw std::out_of_range("TableFile: no channel " + name);
+  return *found;
+}
+
+std::string TableFile::getMetadata(const std::string &key) const {
+  const auto it = metadata.find(key);
+  return it == metadata.end() ? std::string() : it->second;
+}
+
+TableFloats TableFile::floats(const std::string &name) const {
+  const TableChannel &found = channel(name);
+  if (found.type != TableChannel::Type::FLOATS)
+    throw std::invalid_argument("TableFile: " + name + " is not floats");
+  return {static_cast<const float *>(found.data),
+          static_cast<std::size_t>(found.size)};
+}
+
+TableBits TableFile::bits(const std::string &name) const {
+  const TableChannel &found = channel(name);
+  if (found.type != TableChannel::Type::BITS)
+    throw std::invalid_argument("TableFile: " + name + " is not bits");
+  return {static_cast<const std::uint64_t *>(found.data),
+          static_cast<std::size_t>(found.size)};
+}
+
+FloatOp TableFile::op(const std::string &name) const {
+  const TableFloats table = floats(name);
+  return [file = shared_from_this(), table](const float pos) {
+    return table.at(pos);
+  };
+}
+
+std::shared_ptr<Crv> TableFile::crv(const std::string &name) const {
+  return Crv::create(op(name));
+}
+
+TablePtrn TableFile::ptrn(const std::string &name) const {
+  TablePtrn table;
+  table.file = shared_from_this();
+  const char *axes[] = {"X", "Y", "Z"};
+  for (int c = 0; c < 3; ++c) {
+    table.trigs[c] = bits(name + ".trig" + axes[c]);
+    table.values[c] = floats(name + ".value" + axes[c]);
+    table.trigsReversed[c] = channel(name + ".trig" + axes[c]).reversed;
+    table.valuesReversed[c] = channel(name + ".value" + axes[c]).reversed;
+  }
+  return table;
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,233 @@
+#pragma once
+
+#ifndef OFXCRVSTABLE_H
+#define OFXCRVSTABLE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsPtrn.h"
+
+namespace ofxCrvs {
+
+/**
+ * One named array in a table file: float samples or a bitset of triggers,
+ * with how it was rendered. data points into the mapping when the channel
+ * comes from a TableFile.
+ */
+struct TableChannel {
+  enum class Type : std::uint8_t { FLOATS, BITS };
+
+  std::string name;
+  Type type = Type::FLOATS;
+  Component component = Component::Y;
+  // Samples or bits
+  std::uint64_t size = 0;
+  // Samples across positions 0 to 1 it was rendered at
+  std::uint32_t resolution = 0;
+  bool boxed = false;
+  bool transformed = false;
+  // Ptrn tables read back to front at float positions
+  bool reversed = false;
+  glm::vec3 boxPosition{0.f};
+  glm::vec3 boxSize{0.f};
+  const void *data = nullptr;
+};
+
+// Float channel of a TableFile, read in place
+struct TableFloats {
+  const float *data = nullptr;
+  std::size_t size = 0;
+
+  [[nodiscard]] float operator[](std::size_t i) const { return data[i]; };
+  [[nodiscard]] const float *begin() const { return data; };
+  [[nodiscard]] const float *end() const { return data + size; };
+  // Linear interpolation at pos in [0, 1], like Ops::timeseries() without
+  // the normalization
+  [[nodiscard]] float at(float pos) const;
+};
+
+// Trigger channel of a TableFile, 64 triggers per word, read in place
+struct TableBits {
+  const std::uint64_t *words = nullptr;
+  std::size_t size = 0;
+
+  [[nodiscard]] bool operator[](std::size_t i) const {
+    return (words[i >> 6] >> (i & 63)) & 1u;
+  };
+  // Number of set triggers
+  [[nodiscard]] std::size_t count() const;
+};
+
+class TableFile;
+
+/**
+ * A Ptrn's trigger and value tables as written by TableWriter::addPtrn(),
+ * read in place. The accessors match Ptrn's: trigs are 0 or 1, and a
+ * float pos picks the same step Ptrn would, including under reversal.
+ * Unlike Ptrn's, a float pos of an empty table reads 0, and an int index
+ * outside the table throws std::out_of_range. Holds the file open.
+ */
+struct TablePtrn {
+  std::shared_ptr<const TableFile> file;
+  std::array<TableBits, 3> trigs;
+  std::array<TableFloats, 3> values;
+  std::array<bool, 3> trigsReversed{};
+  std::array<bool, 3> valuesReversed{};
+
+  [[nodiscard]] float trigAt(float pos,
+                             Component component = Component::Y) const;
+  [[nodiscard]] float trigAt(int index,
+                             Component component = Component::Y) const;
+  [[nodiscard]] float valueAt(float pos,
+                              Component component = Component::Y) const;
+  [[nodiscard]] float valueAt(int index,
+                              Component component = Component::Y) const;
+  [[nodiscard]] int numTrigSteps(Component component = Component::Y) const;
+  [[nodiscard]] int numValueSteps(Component component = Component::Y) const;
+};
+
+/**
+ * Writes pre-rendered curves and patterns to a table file, for playback
+ * through TableFile instead of parsing text at startup.
+ *
+ * The file is a 64-byte header, each channel's data in turn, and a
+ * directory of channels and string metadata at the end. Channel data
+ * starts on a 64-byte boundary and is stored as-is in little-endian
+ * order, so a reader can use it straight from a memory map. Channels are
+ * streamed to disk as they are added, in chunks, so a render of any
+ * length needs only a small buffer. The header is written last by
+ * finish(); a file left unfinished never opens.
+ */
+class TableWriter {
+public:
+  static constexpr std::uint32_t magic = 0x54565243; // "CRVT"
+  static constexpr std::uint32_t formatVersion = 1;
+  static constexpr std::size_t headerSize = 64;
+  static constexpr std::size_t alignment = 64;
+
+  explicit TableWriter(const std::string &path);
+  // Calls finish() if it hasn't been; errors are lost then
+  ~TableWriter();
+
+  TableWriter(const TableWriter &) = delete;
+  TableWriter &operator=(const TableWriter &) = delete;
+
+  void setMetadata(const std::string &key, const std::string &value);
+
+  // Channels from arrays; info gives the name and how they were rendered,
+  // its type, size and data are ignored. addBits() sets the nonzero trigs.
+  void addFloats(const TableChannel &info, const float *values,
+                 std::size_t count);
+  void addBits(const TableChannel &info, const float *trigs,
+               std::size_t count);
+
+  // op at numSamples positions from 0 to 1 inclusive; TableFile::op() and
+  // TableFile::crv() play it back
+  void addOp(const std::string &name, const FloatOp &op,
+             std::size_t numSamples);
+  // One component of crv, as xAt(), yAt() etc. give it
+  void addComponent(const std::string &name, const Crv &crv,
+                    std::size_t numSamples,
+                    Component component = Component::Y);
+  // crv's points, as sampleInto() gives them, in three float channels
+  // name.x, name.y and name.z
+  void addPoints(const std::string &name, const Crv &crv,
+                 std::size_t numPoints, bool boxed = false,
+                 bool transformed = true);
+  // ptrn's tables at its current settings: bitsets name.trigX, name.trigY
+  // and name.trigZ, and float channels name.valueX, name.valueY and
+  // name.valueZ. TableFile::ptrn() reads them back.
+  void addPtrn(const std::string &name, const Ptrn &ptrn);
+
+  // Writes the directory and header and closes the file
+  void finish();
+
+private:
+  // Pads to the next channel boundary and starts a channel there
+  void begin(const TableChannel &info, TableChannel::Type type);
+  void write(const void *bytes, std::size_t size);
+  void end(std::uint64_t size);
+  template <typename Sample>
+  void addSampled(const TableChannel &info, std::size_t numSamples,
+                  Sample &&sample);
+
+  std::string path;
+  std::ofstream out;
+  std::uint64_t offset = 0;
+  bool finished = false;
+  vector<TableChannel> channels;
+  vector<std::uint64_t> offsets;
+  std::map<std::string, std::string> metadata;
+};
+
+/**
+ * A table file mapped read-only into memory. open() reads only the header
+ * and directory, so it takes the same time for a 1 GB render as for a
+ * small one; samples are paged in by the OS as they are first read, and
+ * several processes opening the same file share its pages.
+ *
+ * Everything handed out points into the mapping. op(), crv() and ptrn()
+ * share ownership of the TableFile, so the mapping lives as long as they
+ * do; floats() and bits() views are only valid while it lives.
+ */
+class TableFile : public std::enable_shared_from_this<TableFile> {
+public:
+  [[nodiscard]] static std::shared_ptr<const TableFile>
+  open(const std::string &path);
+  ~TableFile();
+
+  TableFile(const TableFile &) = delete;
+  TableFile &operator=(const TableFile &) = delete;
+
+  [[nodiscard]] const vector<TableChannel> &getChannels() const {
+    return channels;
+  };
+  // nullptr if there is no such channel
+  [[nodiscard]] const TableChannel *find(const std::string &name) const;
+  [[nodiscard]] const TableChannel &channel(const std::string &name) const;
+  [[nodiscard]] const std::map<std::string, std::string> &
+  getMetadata() const {
+    return metadata;
+  };
+  // Empty if key isn't set
+  [[nodiscard]] std::string getMetadata(const std::string &key) const;
+  [[nodiscard]] std::uint32_t getVersion() const { return version; };
+  [[nodiscard]] std::size_t getFileSize() const { return length; };
+
+  [[nodiscard]] TableFloats floats(const std::string &name) const;
+  [[nodiscard]] TableBits bits(const std::string &name) const;
+
+  // Interpolates a float channel over [0, 1] without copying it
+  [[nodiscard]] FloatOp op(const std::string &name) const;
+  // A Crv with op(name) as its op
+  [[nodiscard]] std::shared_ptr<Crv> crv(const std::string &name) const;
+  [[nodiscard]] TablePtrn ptrn(const std::string &name) const;
+
+private:
+  TableFile() = default;
+  void map(const std::string &path);
+  void readDirectory(const std::string &path);
+
+  const std::uint8_t *base = nullptr;
+  std::size_t length = 0;
+#ifdef _WIN32
+  void *fileHandle = nullptr;
+  void *mappingHandle = nullptr;
+#endif
+  std::uint32_t version = 0;
+  vector<TableChannel> channels;
+  std::map<std::string, std::size_t> channelIndex;
+  std::map<std::string, std::string> metadata;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSTABLE_H
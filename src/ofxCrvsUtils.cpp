@@ -8,6 +8,8 @@
 #include "ofxCrvsUtils.hpp"
 
 #include <algorithm>
+#include <exception>
+#include <thread>
 
 namespace ofxCrvs {
 
@@ -62,7 +64,7 @@ void Utils::rotateVector(glm::vec3& vec, float angleDegrees) {
   vec = glm::rotate(vec, angleRadians, rotationAxis);
 }
 
-void Utils::clipped(glm::vec3& point, const ofBoxPrimitive& box) {
+void Utils::clipped(glm::vec3& point, const BoxPrimitive& box) {
   glm::vec3 boxCenter = box.getPosition();
   float halfWidth = box.getWidth() * 0.5f;
   float halfHeight = box.getHeight() * 0.5f;
@@ -71,9 +73,50 @@ void Utils::clipped(glm::vec3& point, const ofBoxPrimitive& box) {
   glm::vec3 minBound = boxCenter - glm::vec3(halfWidth, halfHeight, halfDepth);
   glm::vec3 maxBound = boxCenter + glm::vec3(halfWidth, halfHeight, halfDepth);
 
-  point.x = ofClamp(point.x, minBound.x, maxBound.x);
-  point.y = ofClamp(point.y, minBound.y, maxBound.y);
-  point.z = ofClamp(point.z, minBound.z, maxBound.z);
+  point.x = clampValue(point.x, minBound.x, maxBound.x);
+  point.y = clampValue(point.y, minBound.y, maxBound.y);
+  point.z = clampValue(point.z, minBound.z, maxBound.z);
+}
+
+void Utils::parallelFor(
+    std::size_t count, std::size_t grainSize,
+    const std::function<void(std::size_t, std::size_t)>& fn, int numThreads) {
+  if (count == 0) return;
+  grainSize = std::max<std::size_t>(grainSize, 1);
+  const std::size_t numChunks = (count + grainSize - 1) / grainSize;
+  if (numThreads <= 0)
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  numThreads = static_cast<int>(
+      std::min<std::size_t>(static_cast<std::size_t>(numThreads), numChunks));
+
+  std::atomic<std::size_t> nextChunk{0};
+  // One slot per worker, so a throw never unwinds past a joinable thread
+  std::vector<std::exception_ptr> errors(numThreads);
+  auto worker = [&](const int index) {
+    try {
+      for (std::size_t chunk = nextChunk.fetch_add(1); chunk < numChunks;
+           chunk = nextChunk.fetch_add(1)) {
+        const std::size_t begin = chunk * grainSize;
+        fn(begin, std::min(begin + grainSize, count));
+      }
+    } catch (...) {
+      errors[index] = std::current_exception();
+      // Hand out no more chunks
+      nextChunk.store(numChunks);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (int i = 1; i < numThreads; ++i) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) std::rethrow_exception(error);
+  }
 }
 
 }  // namespace ofxCrvs
@@ -10,7 +10,7 @@
 #ifndef ofxCrvsUtils_hpp
 #define ofxCrvsUtils_hpp
 
-#include "ofMain.h"
+#include "ofxCrvsCore.h"
 #include "ofxCrvsConstants.h"
 
 namespace ofxCrvs {
@@ -28,9 +28,18 @@ public:
                         const glm::vec3 &rotationAxis = glm::vec3(0.f, 0.f,
                                                                   1.f));
 
-  static void clipped(glm::vec3 &point, const ofBoxPrimitive &box);
+  static void clipped(glm::vec3 &point, const BoxPrimitive &box);
 
   static void rotateVector(glm::vec3 &vec, float angleDegrees);
+
+  // Splits [0, count) into grainSize chunks handed out to numThreads workers
+  // (0 = hardware concurrency). fn(begin, end) must be safe to call
+  // concurrently on disjoint ranges. If fn throws, no further chunks are
+  // started, every worker is joined and the first error is rethrown.
+  static void
+  parallelFor(std::size_t count, std::size_t grainSize,
+              const std::function<void(std::size_t, std::size_t)> &fn,
+              int numThreads = 0);
 };
 
 } // namespace ofxCrvs
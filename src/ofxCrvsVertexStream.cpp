@@ -0,0 +1,32 @@
+#include "ofxCrvsVertexStream.h"
+
+#include <stdexcept>
+
+namespace ofxCrvs {
+
+glm::vec3 *MemoryVertexTarget::map(const std::size_t capacity) {
+  if (external) {
+    if (capacity > externalCapacity)
+      throw std::invalid_argument(
+          "MemoryVertexTarget: frame needs " + std::to_string(capacity) +
+          " vertices, buffer holds " + std::to_string(externalCapacity));
+    return external;
+  }
+  if (storage.size() < capacity)
+    storage.resize(capacity);
+  return storage.data();
+}
+
+VertexStream::VertexStream(std::unique_ptr<VertexTarget> first,
+                           std::unique_ptr<VertexTarget> second)
+    : targets{std::move(first), std::move(second)} {
+  if (!targets[0] || !targets[1])
+    throw std::invalid_argument("VertexStream: null target");
+}
+
+VertexStream VertexStream::inMemory() {
+  return VertexStream(std::make_unique<MemoryVertexTarget>(),
+                      std::make_unique<MemoryVertexTarget>());
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,103 @@
+#pragma once
+
+#ifndef OFXCRVSVERTEXSTREAM_H
+#define OFXCRVSVERTEXSTREAM_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "ofxCrvsCore.h"
+
+namespace ofxCrvs {
+
+/**
+ * Somewhere to write vertices directly, such as a mapped GPU buffer. A
+ * frame is map(), writing up to capacity vertices through the pointer, then
+ * commit() with the number actually written.
+ */
+class VertexTarget {
+public:
+  virtual ~VertexTarget() = default;
+
+  // Room for capacity vertices; the pointer is valid until commit()
+  [[nodiscard]] virtual glm::vec3 *map(std::size_t capacity) = 0;
+  virtual void commit(std::size_t count) = 0;
+  // Vertices in the last commit()
+  [[nodiscard]] virtual std::size_t size() const = 0;
+};
+
+/**
+ * Plain memory target, for headless use and tests, or for a caller's own
+ * buffer. The owning form grows its storage on demand and never shrinks
+ * it; the borrowing form writes into data and throws if a frame needs more
+ * than its capacity.
+ */
+class MemoryVertexTarget : public VertexTarget {
+public:
+  MemoryVertexTarget() = default;
+  MemoryVertexTarget(glm::vec3 *data, std::size_t capacity)
+      : external(data), externalCapacity(capacity) {}
+
+  [[nodiscard]] glm::vec3 *map(std::size_t capacity) override;
+  void commit(std::size_t count) override { committed = count; };
+  [[nodiscard]] std::size_t size() const override { return committed; };
+
+  [[nodiscard]] const glm::vec3 *data() const {
+    return external ? external : storage.data();
+  };
+
+private:
+  vector<glm::vec3> storage;
+  glm::vec3 *external = nullptr;
+  std::size_t externalCapacity = 0;
+  std::size_t committed = 0;
+};
+
+/**
+ * Two targets used in turns: the CPU fills back() for frame N+1 while the
+ * GPU reads front() from frame N. Samplers write straight into the mapped
+ * back buffer, with no intermediate vector or ofPolyline. The GPU targets,
+ * VboVertexTarget and gpuVertexStream(), are in ofxCrvsOf.h:
+ *
+ *   stream.fill(numPoints, [&](glm::vec3 *out) {
+ *     crv->sampleInto(out, numPoints, true, true);
+ *     return numPoints;
+ *   });
+ *   stream.front<VboVertexTarget>().draw(GL_LINE_STRIP);
+ */
+class VertexStream {
+public:
+  VertexStream(std::unique_ptr<VertexTarget> first,
+               std::unique_ptr<VertexTarget> second);
+
+  // A pair of MemoryVertexTargets
+  [[nodiscard]] static VertexStream inMemory();
+
+  [[nodiscard]] VertexTarget &back() { return *targets[1 - frontIndex]; };
+  [[nodiscard]] VertexTarget &front() { return *targets[frontIndex]; };
+  template <typename Target> [[nodiscard]] Target &front() {
+    return static_cast<Target &>(front());
+  };
+  void swap() { frontIndex = 1 - frontIndex; };
+
+  // Maps back() for capacity vertices, calls write(out), which returns how
+  // many it wrote, commits them and swaps. Returns the count.
+  template <typename Write>
+  std::size_t fill(std::size_t capacity, Write &&write) {
+    VertexTarget &target = back();
+    glm::vec3 *out = target.map(capacity);
+    const std::size_t count = std::min<std::size_t>(write(out), capacity);
+    target.commit(count);
+    swap();
+    return count;
+  };
+
+private:
+  std::array<std::unique_ptr<VertexTarget>, 2> targets;
+  int frontIndex = 0;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSVERTEXSTREAM_H
@@ -0,0 +1,224 @@
+#include "ofxCrvsVoicePool.h"
+
+#include <stdexcept>
+#include <typeinfo>
+
+namespace ofxCrvs {
+
+VoicePool::VoicePool(std::shared_ptr<const Crv> crv, const int maxVoices,
+                     const float sampleRate, const State state)
+    : crv(std::move(crv)), maxVoices(maxVoices), sampleRate(sampleRate),
+      state(state) {
+  if (!this->crv)
+    throw std::invalid_argument("VoicePool: null Crv");
+  if (maxVoices <= 0)
+    throw std::invalid_argument("VoicePool: needs at least one voice");
+  if (sampleRate <= 0.f)
+    throw std::invalid_argument("VoicePool: sample rate must be positive");
+  if (state == State::PER_VOICE) {
+    if (typeid(*this->crv) != typeid(Crv))
+      throw std::invalid_argument("VoicePool: PER_VOICE state needs a plain "
+                                  "Crv, not a subclass");
+    voiceCrvs.reserve(maxVoices);
+    for (int i = 0; i < maxVoices; ++i)
+      voiceCrvs.push_back(this->crv->deepCopy());
+  }
+  positions.assign(maxVoices, 0.0);
+  rates.assign(maxVoices, 0.0);
+  sustainPositions.assign(maxVoices, -1.f);
+  releaseRates.assign(maxVoices, 0.0);
+  gains.assign(maxVoices, 0.f);
+  stages.assign(maxVoices, Stage::IDLE);
+  generations.assign(maxVoices, 0);
+  startOrder.assign(maxVoices, 0);
+  active.assign(maxVoices, -1);
+  activeIndex.assign(maxVoices, -1);
+  setTiming(1.f);
+}
+
+void VoicePool::setTiming(const float duration, const float sustainPos,
+                          const float releaseDuration) {
+  if (duration <= 0.f)
+    throw std::invalid_argument("VoicePool: duration must be positive");
+  if (sustainPos >= 1.f)
+    throw std::invalid_argument("VoicePool: sustainPos must be below 1");
+  rate = 1.0 / (static_cast<double>(duration) * sampleRate);
+  this->sustainPos = sustainPos;
+  releaseRate =
+      releaseDuration > 0.f
+          ? (1.0 - std::max(sustainPos, 0.f)) /
+                (static_cast<double>(releaseDuration) * sampleRate)
+          : rate;
+}
+
+int VoicePool::findSlot() const {
+  if (numActive < maxVoices) {
+    for (int slot = 0; slot < maxVoices; ++slot) {
+      if (stages[slot] == Stage::IDLE)
+        return slot;
+    }
+  }
+  int oldest = -1;
+  int oldestReleased = -1;
+  for (int i = 0; i < numActive; ++i) {
+    const int slot = active[i];
+    if (oldest < 0 || startOrder[slot] < startOrder[oldest])
+      oldest = slot;
+    if (stages[slot] == Stage::RELEASED &&
+        (oldestReleased < 0 ||
+         startOrder[slot] < startOrder[oldestReleased]))
+      oldestReleased = slot;
+  }
+  return oldestReleased >= 0 ? oldestReleased : oldest;
+}
+
+void VoicePool::start(const int slot, const float gain) {
+  if (stages[slot] == Stage::IDLE) {
+    active[numActive] = slot;
+    activeIndex[slot] = numActive++;
+  }
+  // Invalidates the id of a stolen voice
+  generations[slot]++;
+  positions[slot] = 0.0;
+  rates[slot] = rate;
+  sustainPositions[slot] = sustainPos;
+  releaseRates[slot] = releaseRate;
+  gains[slot] = gain;
+  stages[slot] = Stage::GATED;
+  startOrder[slot] = numStarted++;
+}
+
+void VoicePool::deactivate(const int index) {
+  const int slot = active[index];
+  stages[slot] = Stage::IDLE;
+  generations[slot]++;
+  activeIndex[slot] = -1;
+  const int last = active[--numActive];
+  if (index != numActive) {
+    active[index] = last;
+    activeIndex[last] = index;
+  }
+  active[numActive] = -1;
+}
+
+VoicePool::VoiceId VoicePool::trigger(const float gain) {
+  const int slot = findSlot();
+  start(slot, gain);
+  return static_cast<VoiceId>(generations[slot]) << 32 |
+         static_cast<VoiceId>(slot);
+}
+
+bool VoicePool::isActive(const VoiceId voice) const {
+  const int slot = slotOf(voice);
+  return voice != kNoVoice && slot < maxVoices &&
+         generations[slot] == static_cast<std::uint32_t>(voice >> 32) &&
+         stages[slot] != Stage::IDLE;
+}
+
+void VoicePool::release(const VoiceId voice) {
+  if (!isActive(voice))
+    return;
+  const int slot = slotOf(voice);
+  // One-shot voices play to the end regardless
+  if (stages[slot] == Stage::GATED && sustainPositions[slot] >= 0.f)
+    stages[slot] = Stage::RELEASED;
+}
+
+void VoicePool::releaseAll() {
+  for (int i = 0; i < numActive; ++i) {
+    const int slot = active[i];
+    if (stages[slot] == Stage::GATED && sustainPositions[slot] >= 0.f)
+      stages[slot] = Stage::RELEASED;
+  }
+}
+
+void VoicePool::stopAll() {
+  while (numActive > 0)
+    deactivate(numActive - 1);
+}
+
+bool VoicePool::renderBlock(const int slot, float *out,
+                            const std::size_t numFrames,
+                            const bool accumulate) {
+  const Stage stage = stages[slot];
+  const float gain = gains[slot];
+  const Crv &voiceCrv =
+      state == State::PER_VOICE ? *voiceCrvs[slot] : *this->crv;
+  // A gated voice stops at its sustain position; 2 is never reached
+  const double hold = stage == Stage::GATED && sustainPositions[slot] >= 0.f
+                          ? sustainPositions[slot]
+                          : 2.0;
+  double pos = positions[slot];
+
+  // Holding a pure curve: one evaluation covers the block
+  if (state == State::SHARED && pos >= hold) {
+    const float value = gain * voiceCrv.yAt(static_cast<float>(hold));
+    if (accumulate) {
+      for (std::size_t i = 0; i < numFrames; ++i)
+        out[i] += value;
+    } else {
+      std::fill(out, out + numFrames, value);
+    }
+    return true;
+  }
+
+  // Advance every position for the block first, then evaluate them in one
+  // loop
+  const double step =
+      stage == Stage::RELEASED ? releaseRates[slot] : rates[slot];
+  float blockPositions[blockSize];
+  std::size_t numValid = numFrames;
+  for (std::size_t i = 0; i < numFrames; ++i) {
+    if (pos >= 1.0) {
+      numValid = i;
+      break;
+    }
+    blockPositions[i] = static_cast<float>(pos);
+    pos = std::min(pos + step, hold);
+  }
+  positions[slot] = pos;
+
+  if (accumulate) {
+    for (std::size_t i = 0; i < numValid; ++i)
+      out[i] += gain * voiceCrv.yAt(blockPositions[i]);
+  } else {
+    for (std::size_t i = 0; i < numValid; ++i)
+      out[i] = gain * voiceCrv.yAt(blockPositions[i]);
+    std::fill(out + numValid, out + numFrames, 0.f);
+  }
+  return pos < 1.0;
+}
+
+void VoicePool::process(float *out, const std::size_t numFrames) {
+  std::fill(out, out + numFrames, 0.f);
+  for (std::size_t offset = 0; offset < numFrames; offset += blockSize) {
+    const std::size_t count = std::min(blockSize, numFrames - offset);
+    // Backwards, so deactivate() only moves voices already rendered
+    for (int i = numActive - 1; i >= 0; --i) {
+      if (!renderBlock(active[i], out + offset, count, true))
+        deactivate(i);
+    }
+  }
+}
+
+void VoicePool::processVoices(float *out, const std::size_t numFrames) {
+  for (int slot = 0; slot < maxVoices; ++slot) {
+    if (stages[slot] == Stage::IDLE)
+      std::fill(out + slot * numFrames, out + (slot + 1) * numFrames, 0.f);
+  }
+  for (int i = numActive - 1; i >= 0; --i) {
+    float *row = out + active[i] * numFrames;
+    bool playing = true;
+    for (std::size_t offset = 0; offset < numFrames; offset += blockSize) {
+      const std::size_t count = std::min(blockSize, numFrames - offset);
+      if (playing)
+        playing = renderBlock(active[i], row + offset, count, false);
+      else
+        std::fill(row + offset, row + offset + count, 0.f);
+    }
+    if (!playing)
+      deactivate(i);
+  }
+}
+
+} // namespace ofxCrvs
@@ -0,0 +1,122 @@
+#pragma once
+
+#ifndef OFXCRVSVOICEPOOL_H
+#define OFXCRVSVOICEPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "ofxCrvsCore.h"
+#include "ofxCrvsCrv.h"
+
+namespace ofxCrvs {
+
+/**
+ * Polyphonic player for one Crv, typically an envelope built from
+ * Ops::env() or Ops::breakpoints(). Each voice sweeps the curve's position
+ * from 0 to 1 in real time: it runs up to the sustain position and holds
+ * there while its gate is open, then plays the rest at the release rate
+ * once released. A voice that reaches position 1 ends.
+ *
+ * Voice state lives in parallel arrays, and process() works in fixed
+ * blocks. For each playing voice it first advances all positions for the
+ * block, then evaluates the curve over them in one tight loop. With SHARED
+ * state, a voice holding at its sustain position is evaluated once per
+ * block instead of once per sample. Most voices in a large chord are
+ * sustaining, so they cost close to nothing.
+ *
+ * Everything is allocated in the constructor; trigger(), release() and
+ * process() neither allocate nor lock. They must all be called from the
+ * same thread, usually the audio callback. Gates change at block
+ * boundaries.
+ */
+class VoicePool {
+public:
+  // SHARED evaluates one curve for every voice and suits pure curves.
+  // PER_VOICE gives each voice a deepCopy() of the curve so stateful ops
+  // keep separate state per voice; that state carries over when a voice is
+  // retriggered.
+  enum class State { SHARED, PER_VOICE };
+
+  // Identifies one note; stays invalid after its voice is stolen or ends
+  using VoiceId = std::uint64_t;
+  static constexpr VoiceId kNoVoice = ~VoiceId{0};
+
+  VoicePool(std::shared_ptr<const Crv> crv, int maxVoices, float sampleRate,
+            State state = State::SHARED);
+
+  /**
+   * Timing for voices triggered from now on. duration is the time in
+   * seconds to sweep the whole curve without holding. sustainPos in [0, 1)
+   * is where a gated voice holds; a negative sustainPos plays one-shot,
+   * ignoring release(). releaseDuration is the time in seconds from the
+   * sustain position to the end, or 0 to keep the gated rate.
+   */
+  void setTiming(float duration, float sustainPos = -1.f,
+                 float releaseDuration = 0.f);
+
+  // Starts a voice scaled by gain. When every voice is busy, the oldest
+  // released voice is stolen, or the oldest voice if none is released.
+  VoiceId trigger(float gain = 1.f);
+  void release(VoiceId voice);
+  void releaseAll();
+  // Silences every voice at once
+  void stopAll();
+
+  // Sums every voice into out, overwriting it
+  void process(float *out, std::size_t numFrames);
+  // Writes each voice slot to its own row of out, voice-major:
+  // out[slot * numFrames + frame]. Idle slots are zeroed.
+  void processVoices(float *out, std::size_t numFrames);
+
+  [[nodiscard]] bool isActive(VoiceId voice) const;
+  [[nodiscard]] int getNumActive() const { return numActive; };
+  [[nodiscard]] int getMaxVoices() const { return maxVoices; };
+  [[nodiscard]] int slotOf(VoiceId voice) const {
+    return static_cast<int>(voice & 0xffffffffu);
+  };
+
+  static constexpr std::size_t blockSize = 64;
+
+private:
+  enum class Stage : std::uint8_t { IDLE, GATED, RELEASED };
+
+  // Renders up to blockSize frames of slot, adding into out if accumulate,
+  // and returns false once the voice has ended
+  bool renderBlock(int slot, float *out, std::size_t numFrames,
+                   bool accumulate);
+  void start(int slot, float gain);
+  void deactivate(int index);
+  int findSlot() const;
+
+  std::shared_ptr<const Crv> crv;
+  int maxVoices;
+  float sampleRate;
+  State state;
+
+  // Position steps per sample; double so long envelopes keep their length
+  double rate = 0.0;
+  float sustainPos = -1.f;
+  double releaseRate = 0.0;
+
+  // Per-slot state
+  vector<std::shared_ptr<Crv>> voiceCrvs;
+  vector<double> positions;
+  vector<double> rates;
+  vector<float> sustainPositions;
+  vector<double> releaseRates;
+  vector<float> gains;
+  vector<Stage> stages;
+  vector<std::uint32_t> generations;
+  vector<std::uint64_t> startOrder;
+  // Slots of the playing voices, in no particular order
+  vector<int> active;
+  vector<int> activeIndex;
+  int numActive = 0;
+  std::uint64_t numStarted = 0;
+};
+
+} // namespace ofxCrvs
+
+#endif // OFXCRVSVOICEPOOL_H
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include "ofxCrvsBreakpoints.h"
+
+using namespace ofxCrvs;
+
+TEST(Breakpoints, EmptyIsZero) {
+  const Breakpoints empty;
+  EXPECT_EQ(empty.size(), 0u);
+  EXPECT_EQ(empty(0.5f), 0.f);
+}
+
+TEST(Breakpoints, InterpolatesLinearSegments) {
+  const Breakpoints env({{0.f, 0.f}, {0.5f, 1.f}, {1.f, 0.f}});
+  EXPECT_EQ(env.size(), 3u);
+  EXPECT_FLOAT_EQ(env(0.f), 0.f);
+  EXPECT_FLOAT_EQ(env(0.25f), 0.5f);
+  EXPECT_FLOAT_EQ(env(0.5f), 1.f);
+  EXPECT_FLOAT_EQ(env(0.75f), 0.5f);
+}
+
+TEST(Breakpoints, HoldsFirstValueAndEndsAtZero) {
+  Breakpoints env;
+  env.add(0.2f, 0.8f);
+  env.add(0.6f, 0.4f);
+  EXPECT_FLOAT_EQ(env(0.f), 0.8f);
+  EXPECT_FLOAT_EQ(env(0.6f), 0.f);
+  EXPECT_FLOAT_EQ(env(1.f), 0.f);
+}
+
+TEST(Breakpoints, Shapes) {
+  Breakpoints hold;
+  hold.add(0.f, 0.3f, Shape::HOLD);
+  hold.add(1.f, 1.f);
+  EXPECT_FLOAT_EQ(hold(0.9f), 0.3f);
+
+  Breakpoints sine;
+  sine.add(0.f, 0.f, Shape::SINE);
+  sine.add(1.f, 1.f);
+  EXPECT_NEAR(sine(0.5f), 0.5f, 1e-6f);
+  EXPECT_LT(sine(0.25f), 0.25f);
+
+  // Positive curvature eases in: below the straight line early on
+  const Breakpoints curve({{0.f, 0.f, 4.f}, {1.f, 1.f}});
+  EXPECT_LT(curve(0.25f), 0.25f);
+}
+
+TEST(Breakpoints, UnevenSpacingAndCopies) {
+  Breakpoints env({{0.f, 0.f}, {0.1f, 1.f}, {0.9f, 0.f}, {1.f, 0.5f}});
+  const Breakpoints copy = env;
+  for (int i = 0; i <= 100; ++i) {
+    const float pos = i / 100.f;
+    EXPECT_EQ(env(pos), copy(pos));
+  }
+  // Descending sweeps after ascending ones still find the right segment
+  EXPECT_FLOAT_EQ(env(0.05f), 0.5f);
+  EXPECT_FLOAT_EQ(env(0.5f), 0.5f);
+  EXPECT_FLOAT_EQ(env(0.05f), 0.5f);
+}
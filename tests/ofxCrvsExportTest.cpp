@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsExport.h"
+#include "ofxCrvsOps.h"
+
+using namespace ofxCrvs;
+
+namespace {
+
+// Keeps every chunk it is given
+class CollectingSink : public ExportSink {
+public:
+  void write(const ExportChunk &chunk) override {
+    points.insert(points.end(), chunk.points.begin(), chunk.points.end());
+    firsts.push_back(chunk.first);
+    lastSeen = chunk.last;
+  };
+  void finish() override { finished = true; };
+
+  std::vector<glm::vec3> points;
+  std::vector<std::uint64_t> firsts;
+  bool lastSeen = false;
+  bool finished = false;
+};
+
+class FailingSink : public ExportSink {
+public:
+  void write(const ExportChunk &) override {
+    throw std::runtime_error("FailingSink: full");
+  };
+};
+
+std::shared_ptr<Crv> sineCrv() { return Crv::create(Ops().sine()); }
+
+} // namespace
+
+TEST(Export, ChunkedRenderMatchesOneShot) {
+  const auto crv = sineCrv();
+  const std::uint64_t numPoints = 1000;
+  CollectingSink sink;
+  const ExportStats stats =
+      ExportPipeline(crv, numPoints, false, true, 128).run(sink);
+  EXPECT_TRUE(sink.finished);
+  EXPECT_TRUE(sink.lastSeen);
+  EXPECT_EQ(stats.pointsSampled, numPoints);
+  EXPECT_EQ(stats.pointsWritten, numPoints);
+  EXPECT_EQ(stats.chunks, 8u);
+  EXPECT_EQ(sink.firsts.front(), 0u);
+  EXPECT_EQ(sink.firsts.back(), 896u);
+
+  const std::vector<glm::vec3> whole =
+      crv->glv3Array(static_cast<int>(numPoints), false, true);
+  ASSERT_EQ(sink.points.size(), whole.size());
+  for (std::size_t i = 0; i < whole.size(); ++i) {
+    EXPECT_NEAR(sink.points[i].x, whole[i].x, 1e-4f);
+    EXPECT_NEAR(sink.points[i].y, whole[i].y, 1e-4f);
+  }
+}
+
+TEST(Export, StagesRunInOrder) {
+  CollectingSink sink;
+  ExportPipeline(sineCrv(), 500, false, true, 64)
+      .add(std::make_unique<BoundingStage>(Bounding::CLIPPING,
+                                           glm::vec3(0.f), glm::vec3(1.f)))
+      .add(std::make_unique<SimplifyStage>(0.5f))
+      .run(sink);
+  EXPECT_LT(sink.points.size(), 500u);
+  for (const glm::vec3 &p : sink.points) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_GE(p[c], 0.f);
+      EXPECT_LE(p[c], 1.f);
+    }
+  }
+}
+
+TEST(Export, SinkErrorsAreRethrown) {
+  FailingSink sink;
+  EXPECT_THROW(ExportPipeline(sineCrv(), 1000, false, true, 100).run(sink),
+               std::runtime_error);
+}
+
+TEST(Export, CsvFileHasOneLinePerPoint) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "ofxCrvsExportTest.csv")
+          .string();
+  {
+    const auto sink = FileSink::toFile(path);
+    ExportPipeline(sineCrv(), 300, false, true, 64).run(*sink);
+  }
+  std::ifstream in(path);
+  std::string line;
+  int lines = 0;
+  while (std::getline(in, line)) {
+    ++lines;
+    EXPECT_EQ(std::count(line.begin(), line.end(), ','), 2);
+  }
+  EXPECT_EQ(lines, 300);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,410 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "ofxCrvsGraph.h"
+#include "ofxCrvsOpRegistry.h"
+#include "ofxCrvsOps.h"
+
+using namespace ofxCrvs;
+
+namespace {
+
+FloatOp wobble() {
+  return [](const float x) { return x * x - 0.25f; };
+}
+
+OpResolver resolver() {
+  return [](const std::string &name) {
+    return name == "wobble" ? wobble() : FloatOp();
+  };
+}
+
+// A show mixing CALL nodes, random streams included, with arithmetic and a
+// named EXTERNAL node
+Graph show() {
+  Graph graph;
+  graph.setSeed(1234);
+  const NodeId lfo = graph.call("rate", {graph.call("sine")}, {0.25f});
+  const NodeId noise = graph.call("random");
+  const NodeId mixed = graph.call("mix", {lfo, noise, graph.call("saw")});
+  const NodeId shaped = graph.op("wobble", wobble(), mixed);
+  graph.setOutput("lfo", lfo);
+  graph.setOutput("out",
+                  graph.add(graph.mult(shaped, graph.c(0.5f)), graph.pos()));
+  graph.setOutput("morph", graph.call("morph", {lfo, noise, graph.pos()}));
+  return graph;
+}
+
+// Compiled outputs agree bit for bit at every sampled position
+void expectSameOutputs(const Graph &a, const Graph &b) {
+  ASSERT_EQ(a.getOutputs(), b.getOutputs());
+  for (const auto &[name, id] : a.getOutputs()) {
+    const FloatOp left = a.compile(id);
+    const FloatOp right = b.compile(b.getOutput(name));
+    for (int i = 0; i <= 256; ++i) {
+      const float pos = i / 256.f;
+      const float l = left(pos);
+      const float r = right(pos);
+      EXPECT_EQ(std::memcmp(&l, &r, sizeof(float)), 0)
+          << name << " at " << pos;
+    }
+  }
+}
+
+// Version 1 binary layout: no seed, no params
+class V1Writer {
+public:
+  void u8(std::uint8_t v) { bytes.push_back(v); }
+  void u32(std::uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+      bytes.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+  }
+  void f32(float v) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    u32(bits);
+  }
+  void node(NodeKind kind, float value, const vector<NodeId> &args,
+            const std::string &name = "") {
+    u8(static_cast<std::uint8_t>(kind));
+    f32(value);
+    u32(static_cast<std::uint32_t>(args.size()));
+    for (const NodeId arg : args)
+      u32(arg);
+    u32(static_cast<std::uint32_t>(name.size()));
+    bytes.insert(bytes.end(), name.begin(), name.end());
+  }
+  vector<std::uint8_t> bytes;
+};
+
+} // namespace
+
+TEST(GraphFormat, JsonRoundTripIsExact) {
+  const Graph graph = show();
+  const std::string json = graph.toJson();
+  const Graph loaded = Graph::fromJson(json, resolver());
+  EXPECT_EQ(loaded.getSeed(), 1234u);
+  EXPECT_EQ(loaded.size(), graph.size());
+  expectSameOutputs(graph, loaded);
+  EXPECT_EQ(loaded.toJson(), json);
+}
+
+TEST(GraphFormat, BinaryRoundTripIsExact) {
+  const Graph graph = show();
+  const vector<std::uint8_t> bytes = graph.toBinary();
+  const Graph loaded = Graph::fromBinary(bytes, resolver());
+  EXPECT_EQ(loaded.getSeed(), 1234u);
+  expectSameOutputs(graph, loaded);
+  EXPECT_EQ(loaded.toBinary(), bytes);
+  // And across formats
+  expectSameOutputs(Graph::fromJson(graph.toJson(), resolver()), loaded);
+}
+
+TEST(GraphFormat, SaveAndLoadFollowTheExtension) {
+  const Graph graph = show();
+  for (const char *name :
+       {"ofxCrvsGraphTest.json", "ofxCrvsGraphTest.crvg"}) {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / name).string();
+    graph.save(path);
+    expectSameOutputs(graph, Graph::load(path, resolver()));
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(GraphFormat, LoadedGraphsKeepHashConsing) {
+  Graph loaded = Graph::fromJson(show().toJson(), resolver());
+  const std::size_t size = loaded.size();
+  const NodeId half = loaded.c(0.5f);
+  EXPECT_EQ(loaded.size(), size);
+  EXPECT_EQ(loaded.mult(loaded.c(0.5f), half), loaded.c(0.25f));
+}
+
+TEST(GraphFormat, Version1JsonStillLoads) {
+  const std::string json = R"({
+    "version": 1,
+    "nodes": [
+      {"kind": "POS"},
+      {"kind": "CONST", "value": 2},
+      {"kind": "MULT", "args": [0, 1]},
+      {"kind": "EXTERNAL", "name": "wobble", "args": [2]}
+    ],
+    "outputs": {"out": 3}
+  })";
+  const Graph graph = Graph::fromJson(json, resolver());
+  EXPECT_FLOAT_EQ(graph.evaluate(graph.getOutput("out"), 0.25f),
+                  wobble()(0.5f));
+}
+
+TEST(GraphFormat, Version1BinaryStillLoads) {
+  V1Writer out;
+  out.u32(0x47565243);
+  out.u32(1);
+  out.u32(4);
+  out.node(NodeKind::POS, 0.f, {});
+  out.node(NodeKind::CONST, 2.f, {});
+  out.node(NodeKind::MULT, 0.f, {0, 1});
+  out.node(NodeKind::EXTERNAL, 0.f, {2}, "wobble");
+  out.u32(1);
+  out.u32(3);
+  out.bytes.insert(out.bytes.end(), {'o', 'u', 't'});
+  out.u32(3);
+  const Graph graph = Graph::fromBinary(out.bytes, resolver());
+  EXPECT_FLOAT_EQ(graph.evaluate(graph.getOutput("out"), 0.25f),
+                  wobble()(0.5f));
+}
+
+TEST(GraphFormat, RejectsMalformedJson) {
+  const auto load = [](const std::string &nodes,
+                       const std::string &outputs = "{}") {
+    return Graph::fromJson(R"({"version": 2, "nodes": [)" + nodes +
+                               R"(], "outputs": )" + outputs + "}",
+                           resolver());
+  };
+  // Wrong arity
+  EXPECT_THROW(load(R"({"kind": "POS"}, {"kind": "ADD", "args": [0]})"),
+               std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "MEAN"})"), std::runtime_error);
+  // Forward and self references
+  EXPECT_THROW(load(R"({"kind": "NEG", "args": [1]}, {"kind": "POS"})"),
+               std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "NEG", "args": [0]})"), std::runtime_error);
+  // Unknown kinds, names and overloads
+  EXPECT_THROW(load(R"({"kind": "SPLINE"})"), std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "POS"},
+                       {"kind": "EXTERNAL", "name": "gone", "args": [0]})"),
+               std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "CALL", "name": "nope"})"),
+               std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "CALL", "name": "rate", "params": [1, 2]})"),
+               std::runtime_error);
+  // A vector factory with none of the ops it needs
+  EXPECT_THROW(load(R"({"kind": "CALL", "name": "morph"})"),
+               std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "POS"}, {"kind": "CALL", "name": "morph",
+                       "args": [0]})"),
+               std::runtime_error);
+  EXPECT_THROW(load(R"({"kind": "POS"})", R"({"out": 1})"),
+               std::runtime_error);
+  EXPECT_THROW(Graph::fromJson(R"({"version": 3, "nodes": []})"),
+               std::runtime_error);
+  EXPECT_THROW(Graph::fromJson(R"({"version": 2, "nodes": [)"),
+               std::runtime_error);
+}
+
+TEST(GraphFormat, RejectsMalformedBinary) {
+  const vector<std::uint8_t> bytes = show().toBinary();
+  for (const std::size_t size : {std::size_t(0), std::size_t(7),
+                                 bytes.size() / 2, bytes.size() - 1}) {
+    EXPECT_THROW(Graph::fromBinary(vector<std::uint8_t>(
+                                       bytes.begin(), bytes.begin() + size),
+                                   resolver()),
+                 std::runtime_error);
+  }
+  vector<std::uint8_t> wrongMagic = bytes;
+  wrongMagic[0] ^= 0xff;
+  EXPECT_THROW(Graph::fromBinary(wrongMagic, resolver()), std::runtime_error);
+  // Saved EXTERNAL nodes need a resolver
+  EXPECT_THROW(Graph::fromBinary(bytes), std::runtime_error);
+}
+
+TEST(GraphFormat, UnnamedOpsCantBeSaved) {
+  Graph graph;
+  graph.setOutput("out", graph.op(wobble()));
+  EXPECT_THROW(static_cast<void>(graph.toJson()), std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(graph.toBinary()), std::invalid_argument);
+}
+
+TEST(OpRegistry, MatchesOverloadsByCount) {
+  Ops ops;
+  ops.setSeed(0);
+  const FloatOp sine = ops.sine();
+  const FloatOp half = ops.c(0.5f);
+  // Number or op argument
+  EXPECT_EQ(OpRegistry::build(ops, "rate", {sine}, {2.f})(0.3f),
+            ops.rate(sine, 2.f)(0.3f));
+  EXPECT_EQ(OpRegistry::build(ops, "rate", {sine, half}, {})(0.3f),
+            ops.rate(sine, half)(0.3f));
+  // Fixed three ops, or a vector then one op
+  EXPECT_EQ(OpRegistry::build(ops, "morph", {sine, half, half}, {})(0.3f),
+            ops.morph(sine, half, half)(0.3f));
+  EXPECT_EQ(OpRegistry::build(ops, "morph", {sine, half}, {})(0.3f),
+            ops.morph(vector<FloatOp>{sine}, half)(0.3f));
+  // Trailing children left out
+  EXPECT_NO_THROW(static_cast<void>(
+      OpRegistry::build(ops, "perlin", {ops.phasor()}, {})(0.3f)));
+  EXPECT_EQ(OpRegistry::build(ops, "sum", {}, {})(0.3f), 0.f);
+}
+
+TEST(OpRegistry, RejectsTooFewChildren) {
+  const Ops ops;
+  EXPECT_THROW(static_cast<void>(OpRegistry::build(ops, "morph", {}, {})),
+               std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(
+                   OpRegistry::build(ops, "morph", {ops.sine()}, {})),
+               std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(OpRegistry::build(ops, "choose", {}, {})),
+               std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(OpRegistry::build(ops, "nope", {}, {})),
+               std::invalid_argument);
+  Graph graph;
+  EXPECT_THROW(static_cast<void>(graph.call("morph")), std::invalid_argument);
+  EXPECT_THROW(static_cast<void>(graph.call("rate", {7})), std::out_of_range);
+}
+
+TEST(OpRegistry, AddedFactoriesHonorMinChildren) {
+  OpRegistry::add(
+      "ofxCrvsGraphTest.firstOf", OpRegistry::any, 0,
+      [](const Ops &, const vector<FloatOp> &children, const vector<float> &) {
+        return children.front();
+      },
+      1);
+  EXPECT_TRUE(OpRegistry::contains("ofxCrvsGraphTest.firstOf"));
+  const Ops ops;
+  EXPECT_EQ(OpRegistry::build(ops, "ofxCrvsGraphTest.firstOf", {ops.c(0.7f)},
+                              {})(0.f),
+            0.7f);
+  EXPECT_THROW(static_cast<void>(OpRegistry::build(
+                   ops, "ofxCrvsGraphTest.firstOf", {}, {})),
+               std::invalid_argument);
+}
+
+TEST(GraphFolding, SameSubtreeIsOneNode) {
+  Graph graph;
+  const NodeId x = graph.pos();
+  const NodeId first = graph.sin(graph.mult(x, graph.c(3.f)));
+  const std::size_t size = graph.size();
+  EXPECT_EQ(graph.sin(graph.mult(graph.pos(), graph.c(3.f))), first);
+  EXPECT_EQ(graph.size(), size);
+  EXPECT_EQ(graph.c(0.5f), graph.c(0.5f));
+  EXPECT_NE(graph.cos(graph.mult(x, graph.c(3.f))), first);
+}
+
+TEST(GraphFolding, CommutativeArgumentsAreSorted) {
+  Graph graph;
+  const NodeId a = graph.pos();
+  const NodeId b = graph.sin(a);
+  EXPECT_EQ(graph.add(a, b), graph.add(b, a));
+  EXPECT_EQ(graph.mult(a, b), graph.mult(b, a));
+  EXPECT_EQ(graph.min(a, b), graph.min(b, a));
+  EXPECT_EQ(graph.max(a, b), graph.max(b, a));
+  EXPECT_NE(graph.sub(a, b), graph.sub(b, a));
+  EXPECT_NE(graph.div(a, b), graph.div(b, a));
+  EXPECT_NE(graph.pow(a, b), graph.pow(b, a));
+  EXPECT_FLOAT_EQ(graph.evaluate(graph.sub(b, a), 0.5f),
+                  std::sin(0.5f) - 0.5f);
+}
+
+TEST(GraphFolding, Identities) {
+  Graph graph;
+  const NodeId x = graph.sin(graph.pos());
+  const NodeId y = graph.cos(graph.pos());
+  const NodeId zero = graph.c(0.f);
+  const NodeId one = graph.c(1.f);
+  EXPECT_EQ(graph.add(x, zero), x);
+  EXPECT_EQ(graph.add(zero, x), x);
+  EXPECT_EQ(graph.sub(x, zero), x);
+  EXPECT_EQ(graph.sub(x, x), zero);
+  EXPECT_EQ(graph.mult(x, one), x);
+  EXPECT_EQ(graph.mult(one, x), x);
+  EXPECT_EQ(graph.mult(x, zero), zero);
+  EXPECT_EQ(graph.mult(zero, x), zero);
+  EXPECT_EQ(graph.div(x, one), x);
+  EXPECT_EQ(graph.pow(x, one), x);
+  EXPECT_EQ(graph.pow(x, zero), one);
+  EXPECT_EQ(graph.min(x, x), x);
+  EXPECT_EQ(graph.max(x, x), x);
+  EXPECT_EQ(graph.neg(graph.neg(x)), x);
+  EXPECT_EQ(graph.mix(x, x, graph.pos()), x);
+  EXPECT_EQ(graph.mix(x, y, zero), x);
+  EXPECT_EQ(graph.mix(x, y, one), y);
+}
+
+TEST(GraphFolding, ConstantArgumentsFold) {
+  Graph graph;
+  const NodeId sum = graph.add(graph.c(2.f), graph.c(3.f));
+  ASSERT_TRUE(graph.isConst(sum));
+  EXPECT_EQ(sum, graph.c(5.f));
+  // Through whole subtrees, with the same arithmetic the program uses
+  const NodeId folded =
+      graph.sqrt(graph.mult(graph.sin(graph.c(0.7f)), graph.c(2.f)));
+  ASSERT_TRUE(graph.isConst(folded));
+  EXPECT_EQ(graph.node(folded).value, std::sqrt(std::sin(0.7f) * 2.f));
+  EXPECT_TRUE(graph.isConst(
+      graph.clamp(graph.c(4.f), graph.c(0.f), graph.c(1.f))));
+  EXPECT_FALSE(graph.isConst(graph.add(graph.c(2.f), graph.pos())));
+}
+
+TEST(GraphFolding, OpNodesAreNeverMergedOrFolded) {
+  Graph graph;
+  EXPECT_NE(graph.op(wobble()), graph.op(wobble()));
+  EXPECT_FALSE(graph.isConst(graph.op(wobble(), graph.c(0.5f))));
+  EXPECT_NE(graph.call("random"), graph.call("random"));
+}
+
+TEST(GraphFolding, SharedNodesRunOncePerSample) {
+  Graph graph;
+  auto calls = std::make_shared<int>(0);
+  const NodeId x = graph.op([calls](const float pos) {
+    ++*calls;
+    return pos;
+  });
+  const NodeId root = graph.add(graph.mult(x, x), graph.sin(x));
+  const FloatOp op = graph.compile(root);
+  EXPECT_FLOAT_EQ(op(0.5f), 0.25f + std::sin(0.5f));
+  EXPECT_EQ(*calls, 1);
+}
+
+TEST(GraphFolding, LongProgramsMatch) {
+  // Past the slots a program keeps on the stack
+  Graph graph;
+  NodeId root = graph.pos();
+  for (int i = 1; i <= 200; ++i)
+    root = graph.add(graph.mult(root, graph.c(0.5f)), graph.c(i / 200.f));
+  const FloatOp op = graph.compile(root);
+  float expected = 0.3f;
+  for (int i = 1; i <= 200; ++i)
+    expected = expected * 0.5f + i / 200.f;
+  EXPECT_FLOAT_EQ(op(0.3f), expected);
+}
+
+TEST(GraphStatistics, MatchOps) {
+  Ops ops;
+  const vector<FloatOp> five = {ops.sine(), ops.saw(), ops.tri(),
+                                ops.c(0.2f), ops.phasor()};
+  for (const std::size_t count : {std::size_t(2), std::size_t(4),
+                                  std::size_t(5)}) {
+    const vector<FloatOp> inputs(five.begin(), five.begin() + count);
+    Graph graph;
+    vector<NodeId> nodes;
+    for (const FloatOp &input : inputs)
+      nodes.push_back(graph.op(input));
+    const FloatOp mean = graph.compile(graph.mean(nodes));
+    const FloatOp variance = graph.compile(graph.variance(nodes));
+    const FloatOp stdDev = graph.compile(graph.stdDev(nodes));
+    const FloatOp median = graph.compile(graph.median(nodes));
+    for (int i = 0; i <= 64; ++i) {
+      const float pos = i / 64.f;
+      EXPECT_NEAR(mean(pos), ops.mean(inputs)(pos), 1e-6f);
+      EXPECT_NEAR(variance(pos), ops.variance(inputs)(pos), 1e-6f);
+      EXPECT_NEAR(stdDev(pos), ops.stdDev(inputs)(pos), 1e-6f);
+      EXPECT_EQ(median(pos), ops.median(inputs)(pos));
+    }
+  }
+}
+
+TEST(GraphStatistics, FoldOverConstants) {
+  Graph graph;
+  const vector<NodeId> xs = {graph.c(1.f), graph.c(2.f), graph.c(6.f)};
+  EXPECT_EQ(graph.mean(xs), graph.c(3.f));
+  EXPECT_EQ(graph.median(xs), graph.c(2.f));
+  EXPECT_EQ(graph.variance(xs), graph.c(14.f / 3.f));
+  EXPECT_EQ(graph.mean({graph.pos()}), graph.pos());
+  EXPECT_EQ(graph.variance({}), graph.c(0.f));
+}
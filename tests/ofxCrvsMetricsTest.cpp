@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ofxCrvsMetrics.h"
+
+using namespace ofxCrvs;
+
+TEST(MetricsWriter, ConcurrentWritesLeaveWholeSnapshots) {
+  Metrics metrics;
+  for (int i = 0; i < 200; ++i)
+    metrics.counter("ofxCrvsMetricsTest.counter" + std::to_string(i)).add(i);
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "ofxCrvsMetricsTest.txt")
+          .string();
+  const std::string expected = metrics.format(Metrics::Format::TEXT);
+  {
+    MetricsWriter writer(path, std::chrono::milliseconds(1),
+                         Metrics::Format::TEXT, metrics);
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&] {
+        for (int i = 0; i < 100; ++i) {
+          try {
+            writer.write();
+          } catch (const std::runtime_error &) {
+            ++failures;
+          }
+        }
+      });
+    }
+    for (std::thread &thread : threads)
+      thread.join();
+    EXPECT_EQ(failures.load(), 0);
+  }
+  std::ifstream in(path);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  EXPECT_EQ(contents.str(), expected);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "ofxCrvsNoise.h"
+#include "ofxCrvsOps.h"
+#include "ofxCrvsRng.h"
+
+using namespace ofxCrvs;
+
+TEST(Rng, SameInputsGiveSameDraws) {
+  for (std::uint32_t key = 0; key < 64; ++key) {
+    EXPECT_EQ(Rng::hash(key, 3, 7), Rng::hash(key, 3, 7));
+    EXPECT_EQ(Rng::uniform(key, 3, 7), Rng::uniform(key, 3, 7));
+    EXPECT_EQ(Rng::gaussian(key, 3, 7), Rng::gaussian(key, 3, 7));
+  }
+}
+
+TEST(Rng, UniformStaysInUnitRange) {
+  for (std::uint32_t key = 0; key < 4096; ++key) {
+    const float u = Rng::uniform(key, 0, 0);
+    EXPECT_GE(u, 0.f);
+    EXPECT_LT(u, 1.f);
+  }
+}
+
+TEST(Rng, StreamsAndSeedsDiffer) {
+  int sameStream = 0;
+  int sameSeed = 0;
+  for (std::uint32_t key = 0; key < 256; ++key) {
+    sameStream += Rng::hash(key, 0, 1) == Rng::hash(key, 1, 1);
+    sameSeed += Rng::hash(key, 0, 1) == Rng::hash(key, 0, 2);
+  }
+  EXPECT_EQ(sameStream, 0);
+  EXPECT_EQ(sameSeed, 0);
+}
+
+TEST(Noise, SeededNoiseIsDeterministic) {
+  for (int i = 0; i < 100; ++i) {
+    const float x = i * 0.37f;
+    EXPECT_EQ(Noise::noise(x, 0.5f, 11u), Noise::noise(x, 0.5f, 11u));
+    EXPECT_EQ(Noise::fbm(x, 0.5f, 1.f, 0.5f, 4, 11u),
+              Noise::fbm(x, 0.5f, 1.f, 0.5f, 4, 11u));
+    const float n = Noise::noise(x, 11u);
+    EXPECT_GE(n, 0.f);
+    EXPECT_LE(n, 1.f);
+  }
+}
+
+TEST(Noise, SeedsGiveDifferentFields) {
+  int same = 0;
+  for (int i = 0; i < 100; ++i) {
+    const float x = 0.5f + i * 0.37f;
+    same += Noise::noise(x, 1u) == Noise::noise(x, 2u);
+  }
+  EXPECT_LT(same, 5);
+}
+
+TEST(Noise, BlockFbmMatchesScalar) {
+  const Fbm fbm(0.5f, 4, 3u);
+  std::vector<float> xs(200);
+  for (std::size_t i = 0; i < xs.size(); ++i)
+    xs[i] = i * 0.05f;
+  std::vector<float> out(xs.size());
+  fbm(xs.data(), out.data(), xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i)
+    EXPECT_NEAR(out[i], Noise::fbm(xs[i], 0.5f, 4, 3u), 1e-5f);
+}
+
+TEST(Ops, SeededRandomRepeats) {
+  Ops a;
+  a.setSeed(42);
+  Ops b;
+  b.setSeed(42);
+  const FloatOp first = a.random();
+  const FloatOp second = b.random();
+  for (int i = 0; i < 100; ++i) {
+    const float pos = i / 99.f;
+    EXPECT_EQ(first(pos), second(pos));
+  }
+}
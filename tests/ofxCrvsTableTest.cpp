@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsOps.h"
+#include "ofxCrvsPtrn.h"
+#include "ofxCrvsTable.h"
+
+using namespace ofxCrvs;
+
+namespace {
+
+std::string tempPath(const std::string &name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+} // namespace
+
+TEST(Table, FloatsAndMetadataRoundTrip) {
+  const std::string path = tempPath("ofxCrvsTableTest.crvt");
+  const Ops ops;
+  const FloatOp op = ops.sine();
+  const std::size_t numSamples = 1001;
+  {
+    TableWriter writer(path);
+    writer.setMetadata("show", "smoke");
+    writer.addOp("sine", op, numSamples);
+    writer.finish();
+  }
+  const auto file = TableFile::open(path);
+  EXPECT_EQ(file->getVersion(), TableWriter::formatVersion);
+  EXPECT_EQ(file->getMetadata("show"), "smoke");
+  EXPECT_EQ(file->getMetadata("missing"), "");
+  ASSERT_NE(file->find("sine"), nullptr);
+  EXPECT_EQ(file->find("cosine"), nullptr);
+
+  const TableFloats floats = file->floats("sine");
+  ASSERT_EQ(floats.size, numSamples);
+  for (std::size_t i = 0; i < numSamples; ++i)
+    EXPECT_EQ(floats[i], op(i / static_cast<float>(numSamples - 1)));
+  // Between samples it interpolates, close to the op itself
+  const FloatOp played = file->op("sine");
+  EXPECT_NEAR(played(0.3337f), op(0.3337f), 1e-4f);
+  std::filesystem::remove(path);
+}
+
+TEST(Table, PtrnRoundTrip) {
+  const std::string path = tempPath("ofxCrvsTablePtrnTest.crvt");
+  Ptrn ptrn;
+  ptrn.setCrv(Crv::create(Ops().sine()));
+  ptrn.setTrigYReversed(true);
+  ptrn.updateCache();
+  {
+    TableWriter writer(path);
+    writer.addPtrn("ptrn", ptrn);
+    writer.finish();
+  }
+  const TablePtrn table = TableFile::open(path)->ptrn("ptrn");
+  for (int i = 0; i <= 100; ++i) {
+    const float pos = i / 100.f;
+    EXPECT_EQ(table.trigAt(pos), ptrn.trigAt(pos));
+    EXPECT_EQ(table.valueAt(pos), ptrn.valueAt(pos));
+  }
+  EXPECT_THROW(static_cast<void>(table.valueAt(table.numValueSteps())),
+               std::out_of_range);
+  std::filesystem::remove(path);
+}
+
+TEST(Table, UnfinishedFilesDontOpen) {
+  const std::string path = tempPath("ofxCrvsTableUnfinished.crvt");
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "not a table";
+  }
+  EXPECT_THROW(TableFile::open(path), std::runtime_error);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "ofxCrvsUtils.hpp"
+
+using namespace ofxCrvs;
+
+TEST(ParallelFor, CoversEveryIndexOnce) {
+  std::vector<std::atomic<int>> hits(1000);
+  Utils::parallelFor(
+      hits.size(), 7,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+          ++hits[i];
+      },
+      4);
+  for (const std::atomic<int> &hit : hits)
+    EXPECT_EQ(hit.load(), 1);
+}
+
+TEST(ParallelFor, RethrowsWorkerErrors) {
+  for (const int numThreads : {1, 4}) {
+    std::atomic<int> chunks{0};
+    EXPECT_THROW(Utils::parallelFor(
+                     1000, 1,
+                     [&](std::size_t begin, std::size_t) {
+                       ++chunks;
+                       if (begin % 10 == 3)
+                         throw std::runtime_error("ParallelFor: chunk");
+                     },
+                     numThreads),
+                 std::runtime_error);
+    // Workers stop taking chunks once one has failed
+    EXPECT_LT(chunks.load(), 1000);
+  }
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <stdexcept>
+
+#include "ofxCrvsCrv.h"
+#include "ofxCrvsOps.h"
+#include "ofxCrvsVoicePool.h"
+
+using namespace ofxCrvs;
+
+namespace {
+
+constexpr float kSampleRate = 1000.f;
+
+std::shared_ptr<Crv> constantCrv() { return Crv::create(Ops().c(0.5f)); }
+
+} // namespace
+
+TEST(VoicePool, RejectsBadArguments) {
+  EXPECT_THROW(VoicePool(nullptr, 4, kSampleRate), std::invalid_argument);
+  EXPECT_THROW(VoicePool(constantCrv(), 0, kSampleRate),
+               std::invalid_argument);
+  EXPECT_THROW(VoicePool(constantCrv(), 4, 0.f), std::invalid_argument);
+}
+
+TEST(VoicePool, SumsVoicesScaledByGain) {
+  VoicePool pool(constantCrv(), 4, kSampleRate);
+  pool.setTiming(1.f);
+  std::vector<float> one(64);
+  const VoicePool::VoiceId voice = pool.trigger(1.f);
+  pool.process(one.data(), one.size());
+  const float single = one[10];
+  EXPECT_NE(single, 0.f);
+
+  pool.stopAll();
+  EXPECT_FALSE(pool.isActive(voice));
+  pool.trigger(1.f);
+  pool.trigger(0.5f);
+  std::vector<float> two(64);
+  pool.process(two.data(), two.size());
+  EXPECT_NEAR(two[10], 1.5f * single, 1e-6f);
+}
+
+TEST(VoicePool, OneShotVoicesEnd) {
+  VoicePool pool(constantCrv(), 2, kSampleRate);
+  // 100 samples to sweep the curve
+  pool.setTiming(0.1f);
+  const VoicePool::VoiceId voice = pool.trigger();
+  std::vector<float> out(256);
+  pool.process(out.data(), out.size());
+  EXPECT_FALSE(pool.isActive(voice));
+  EXPECT_EQ(pool.getNumActive(), 0);
+  EXPECT_EQ(out.back(), 0.f);
+}
+
+TEST(VoicePool, GatedVoicesHoldUntilReleased) {
+  VoicePool pool(constantCrv(), 2, kSampleRate);
+  pool.setTiming(0.1f, 0.5f, 0.05f);
+  const VoicePool::VoiceId voice = pool.trigger();
+  std::vector<float> out(512);
+  pool.process(out.data(), out.size());
+  EXPECT_TRUE(pool.isActive(voice));
+  pool.release(voice);
+  pool.process(out.data(), out.size());
+  EXPECT_FALSE(pool.isActive(voice));
+}
+
+TEST(VoicePool, StealsTheOldestVoiceWhenFull) {
+  VoicePool pool(constantCrv(), 2, kSampleRate);
+  pool.setTiming(1.f, 0.5f);
+  const VoicePool::VoiceId first = pool.trigger();
+  const VoicePool::VoiceId second = pool.trigger();
+  const VoicePool::VoiceId third = pool.trigger();
+  EXPECT_EQ(pool.getNumActive(), 2);
+  EXPECT_FALSE(pool.isActive(first));
+  EXPECT_TRUE(pool.isActive(second));
+  EXPECT_TRUE(pool.isActive(third));
+  EXPECT_EQ(pool.slotOf(third), pool.slotOf(first));
+}
+
+TEST(VoicePool, PerVoiceRowsAddUpToTheMix) {
+  VoicePool pool(constantCrv(), 3, kSampleRate, VoicePool::State::PER_VOICE);
+  pool.setTiming(1.f);
+  pool.trigger(1.f);
+  pool.trigger(0.25f);
+  const std::size_t numFrames = 64;
+  std::vector<float> rows(3 * numFrames);
+  pool.processVoices(rows.data(), numFrames);
+  const float frame = rows[5] + rows[numFrames + 5] + rows[2 * numFrames + 5];
+
+  VoicePool mixed(constantCrv(), 3, kSampleRate, VoicePool::State::PER_VOICE);
+  mixed.setTiming(1.f);
+  mixed.trigger(1.f);
+  mixed.trigger(0.25f);
+  std::vector<float> mix(numFrames);
+  mixed.process(mix.data(), numFrames);
+  EXPECT_NEAR(mix[5], frame, 1e-6f);
+}